@@ -82,6 +82,15 @@ class base_clustering_impl {
    */
   virtual void initialize(std::vector<T>* data,
                           membership_type<Policy>* membership) = 0;
+
+  /**
+   * \brief Choose the initial cluster centers, after the clusters have been
+   * created. By default, the centers the clusters were created with (the first
+   * K data points) are used.
+   */
+  virtual void seed_centers(const std::vector<T>&,
+                            const dist_calc_ftype&,
+                            cluster_vector*) {}
 };
 
 NS_END(clustering, algorithm, rcppsw);
@@ -96,6 +96,16 @@ class nc_cluster {
 
   const T& center(void) const { return m_center; }
 
+  /**
+   * \brief Set the center directly, for algorithms which compute centers
+   * themselves (e.g., seeding, or from partial sums gathered during an
+   * iteration) instead of via \ref update_center().
+   */
+  void center(const T& center) {
+    m_prev_center = m_center;
+    m_center = center;
+  }
+
  private:
   /* clang-format off */
   const std::vector<T>&          mc_data;
@@ -130,12 +140,26 @@ class eh_cluster {
     (*m_membership)[m_id].insert(point_idx);
   }
 
+  /**
+   * \brief Merge points added out of index order into the cluster (see \ref
+   * eh_members::merge()). Must be called after adding points, before the
+   * cluster membership is used.
+   */
+  void merge_points(std::vector<size_t>* const scratch) {
+    (*m_membership)[m_id].merge(scratch);
+  }
+
+  /**
+   * \brief Remove all points from the cluster.
+   */
+  void clear(void) { (*m_membership)[m_id].clear(); }
+
   /*
    * \brief Determine if the cluster has converged, by checking if the center of
    * the cluster has changed.
    */
   bool converged(void) const { return m_prev_size == size(); }
-  size_t size(void) const { return m_membership->size(); }
+  size_t size(void) const { return (*m_membership)[m_id].size(); }
 
   /**
    * \brief Update the size of the cluster after an iteration has finished.
@@ -51,9 +51,18 @@ class eh_clustering_impl : public base_clustering_impl<T, policy::EH> {
   void horizon(double horizon) { m_horizon = horizon; }
   double horizon(void) const { return m_horizon; }
 
+  /**
+   * \brief Set the largest horizon which will be used, so that implementations
+   * can precompute whatever depends on it (e.g., neighbor lists) once, rather
+   * than for every horizon. -1 if unknown.
+   */
+  void max_horizon(double horizon) { m_max_horizon = horizon; }
+  double max_horizon(void) const { return m_max_horizon; }
+
   /* clang-format off */
  private:
   double m_horizon{-1};
+  double m_max_horizon{-1};
   /* clang-format on */
 };
 
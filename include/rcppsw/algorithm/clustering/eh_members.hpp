@@ -0,0 +1,176 @@
+/**
+ * \file eh_members.hpp
+ *
+ * \copyright 2020 John Harwell, All rights reserved.
+ *
+ * This file is part of RCPPSW.
+ *
+ * RCPPSW is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * RCPPSW is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * RCPPSW.  If not, see <http://www.gnu.org/licenses/
+ */
+
+#ifndef INCLUDE_RCPPSW_ALGORITHM_CLUSTERING_EH_MEMBERS_HPP_
+#define INCLUDE_RCPPSW_ALGORITHM_CLUSTERING_EH_MEMBERS_HPP_
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+#include "rcppsw/rcppsw.hpp"
+
+/*******************************************************************************
+ * Namespaces/Decls
+ ******************************************************************************/
+NS_START(rcppsw, algorithm, clustering);
+
+/*******************************************************************************
+ * Class Definitions
+ ******************************************************************************/
+/**
+ * \class eh_members
+ * \ingroup algorithm clustering
+ *
+ * \brief The members of a single Event Horizon (EH) cluster: a set of point
+ * indices, stored as a sorted vector rather than a node-based set, so that
+ * inserts don't allocate (amortized), and two clusters can be compared
+ * cheaply.
+ *
+ * Inserts larger than the current largest member (e.g., when points are
+ * visited in index order) are appended directly. Others are buffered, and
+ * merged in by \ref merge(), which must be called before the cluster is read
+ * again. The result does not depend on the order of inserts, so clusters built
+ * by different threads in different orders are identical.
+ *
+ * An order-independent hash of the members is maintained as they are added, so
+ * that \ref hash() is O(1), and \ref operator==() only compares members when the
+ * sizes and hashes match.
+ *
+ * A single instance is not thread-safe, but different instances can be
+ * modified concurrently (e.g., one cluster per OpenMP thread).
+ */
+class eh_members {
+ public:
+  using const_iterator = std::vector<size_t>::const_iterator;
+
+  eh_members(void) = default;
+
+  /**
+   * \brief Add \p idx to the cluster, if it is not already a member.
+   */
+  void insert(size_t idx) {
+    if (m_members.empty() || idx > m_members.back()) {
+      m_members.push_back(idx);
+      m_hash += mix(idx);
+    } else if (idx != m_members.back()) {
+      m_pending.push_back(idx);
+    }
+  }
+
+  /**
+   * \brief Merge the members buffered by \ref insert() into the cluster.
+   *
+   * \param scratch Temporary storage to use, so that a thread merging many
+   *                clusters can reuse its allocation.
+   */
+  void merge(std::vector<size_t>* const scratch) {
+    if (m_pending.empty()) {
+      return;
+    }
+    std::sort(m_pending.begin(), m_pending.end());
+    m_pending.erase(std::unique(m_pending.begin(), m_pending.end()),
+                    m_pending.end());
+
+    /* only the pending members which are actually new change the hash */
+    scratch->clear();
+    std::set_difference(m_pending.begin(),
+                        m_pending.end(),
+                        m_members.begin(),
+                        m_members.end(),
+                        std::back_inserter(*scratch));
+    for (size_t idx : *scratch) {
+      m_hash += mix(idx);
+    } /* for(idx..) */
+
+    size_t n_old = m_members.size();
+    m_members.insert(m_members.end(), scratch->begin(), scratch->end());
+    std::inplace_merge(m_members.begin(),
+                       m_members.begin() + static_cast<std::ptrdiff_t>(n_old),
+                       m_members.end());
+    m_pending.clear();
+  }
+
+  void merge(void) {
+    std::vector<size_t> scratch;
+    merge(&scratch);
+  }
+
+  /**
+   * \brief Remove all members (the allocation is kept).
+   */
+  void clear(void) {
+    m_members.clear();
+    m_pending.clear();
+    m_hash = 0;
+  }
+
+  void reserve(size_t n) { m_members.reserve(n); }
+
+  size_t size(void) const { return m_members.size(); }
+  bool empty(void) const { return m_members.empty(); }
+
+  /**
+   * \brief Determine if \p idx is a member. O(log N).
+   */
+  bool contains(size_t idx) const {
+    return std::binary_search(m_members.begin(), m_members.end(), idx);
+  }
+
+  /**
+   * \brief Get the (order-independent) hash of the members.
+   */
+  size_t hash(void) const { return m_hash; }
+
+  const_iterator begin(void) const { return m_members.begin(); }
+  const_iterator end(void) const { return m_members.end(); }
+
+  bool operator==(const eh_members& other) const {
+    return m_hash == other.m_hash && m_members == other.m_members;
+  }
+  bool operator!=(const eh_members& other) const { return !(*this == other); }
+
+ private:
+  /**
+   * \brief The splitmix64 finalizer, so that the sums of hashes of nearby
+   * indices don't collide.
+   */
+  static size_t mix(size_t idx) {
+    uint64_t z = idx + 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+  }
+
+  /* clang-format off */
+  std::vector<size_t> m_members{};
+  std::vector<size_t> m_pending{};
+  size_t              m_hash{0};
+  /* clang-format on */
+};
+
+NS_END(clustering, algorithm, rcppsw);
+
+#endif /* INCLUDE_RCPPSW_ALGORITHM_CLUSTERING_EH_MEMBERS_HPP_ */
@@ -23,9 +23,11 @@
 /*******************************************************************************
  * Includes
  ******************************************************************************/
+#include <algorithm>
 #include <vector>
 #include <limits>
 #include <map>
+#include <unordered_map>
 
 #include "rcppsw/rcppsw.hpp"
 #include "rcppsw/er/client.hpp"
@@ -57,7 +59,8 @@ NS_START(rcppsw, algorithm, clustering);
  * 2. For each cluster c_i centered at point p_i, check every point p_j (i !=
  *    j), and if distance(p_i, p_j) <= horizon, add p_j to c_i.
  *
- * 3. Discard redundant clusters.
+ * 3. Discard redundant clusters (found by hashing each cluster's membership, so
+ *    only clusters with the same hash are compared).
  *
  * 4. Calculate entropy of remaining non-redundant clusters. Entropy is
  *    accumulated across all values of horizon.
@@ -108,9 +111,8 @@ class entropy_balch2000 : public er::client<entropy_balch2000<T>> {
      */
     m_membership.assign(m_data.size(),
                         typename decltype(m_membership)::value_type());
-    m_membership_cp.assign(m_data.size(),
-                           typename decltype(m_membership_cp)::value_type());
 
+    m_impl->max_horizon(mc_horizon.ub());
     m_impl->initialize(&m_data, &m_membership);
     m_clusters = clusters_init();
 
@@ -173,41 +175,42 @@ class entropy_balch2000 : public er::client<entropy_balch2000<T>> {
     m_impl->post_iter_update(&m_clusters);
 
     /*
-     * Make a copy to prevent permanently deleting clusters that may be
-     * duplicates for THIS horizon, but may not for a future horizon value.
+     * Duplicates are skipped rather than removed, as clusters that are
+     * duplicates for THIS horizon may not be for a future horizon value.
      */
-    m_membership_cp = m_membership;
-    balch2000_rm_dup_clusters(&m_membership_cp);
-    std::vector<double> proportions(m_membership_cp.size());
+    balch2000_find_unique_clusters();
+    std::vector<double> proportions(m_unique.size());
     for (size_t i = 0; i < proportions.size(); ++i) {
-      double prop = static_cast<double>(m_membership_cp[i].size()) /
-                    m_data.size();
-      ER_TRACE("cluster@%zu size=%zu, prop=%f",
-               i,
-               m_membership_cp[i].size(),
-               prop);
+      size_t size = m_membership[m_unique[i]].size();
+      double prop = static_cast<double>(size) / m_data.size();
+      ER_TRACE("cluster@%zu size=%zu, prop=%f", m_unique[i], size, prop);
       proportions[i] = prop;
     } /* for(i..) */
     return math::ientropy()(proportions);
   }
 
-  void balch2000_rm_dup_clusters(membership_type<policy::EH>* const clusters) {
-    ER_TRACE("Removing duplicate clusters");
-    /* for each datapoint/cluster in a given iteration */
-    for (size_t i = 0; i < clusters->size(); ++i) {
-      ER_TRACE("cluster%zu: n_members=%zu", i, (*clusters)[i].size());
-      std::unordered_set<size_t>& cluster_i = (*clusters)[i];
-      auto comp = [&](const auto& clust) RCPPSW_PURE {
-        /*
-         * Duplicates are defined as two of the unordered membership sets
-         * containing the same points AND the sets not being in the same index
-         * in the vector of results (i.e. not self equality).
-         */
-        return cluster_i == clust &&
-        static_cast<size_t>(&clust - &((*clusters)[0])) != i;
-      };
-      auto rm = std::remove_if(clusters->begin(), clusters->end(), comp);
-      clusters->erase(rm, clusters->end());
+  /**
+   * \brief Find the index of the first cluster of each group of clusters with
+   * the same members. Clusters are grouped by the hash of their membership
+   * (maintained incrementally by \ref eh_members) first, so that only clusters
+   * with the same hash (almost always the actual duplicates) need to be
+   * compared, instead of all pairs.
+   */
+  void balch2000_find_unique_clusters(void) {
+    ER_TRACE("Finding unique clusters");
+    m_unique.clear();
+    m_by_hash.clear();
+    for (size_t i = 0; i < m_membership.size(); ++i) {
+      auto& same_hash = m_by_hash[m_membership[i].hash()];
+      auto dup = std::find_if(same_hash.begin(),
+                              same_hash.end(),
+                              [&](size_t j) {
+                                return m_membership[j] == m_membership[i];
+                              });
+      if (same_hash.end() == dup) {
+        same_hash.push_back(i);
+        m_unique.push_back(i);
+      }
     } /* for(i..) */
   }
 
@@ -219,11 +222,13 @@ class entropy_balch2000 : public er::client<entropy_balch2000<T>> {
   membership_type<policy::EH>            m_membership{};
 
   /**
-   * \brief This is a member variable, rather than a local variable in
+   * \brief These are member variables, rather than local variables in
    * \ref balch2000_iter, in order to reduce dynamic memory management overhead.
    */
+  std::vector<size_t>                    m_unique{};
+  std::unordered_map<size_t,
+                     std::vector<size_t>> m_by_hash{};
 
-  membership_type<policy::EH>            m_membership_cp{};
   cluster_vector                         m_clusters{};
   std::unique_ptr<eh_clustering_impl<T>> m_impl;
   /* clang-format on */
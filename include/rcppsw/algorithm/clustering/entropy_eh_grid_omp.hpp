@@ -0,0 +1,256 @@
+/**
+ * \file entropy_eh_grid_omp.hpp
+ *
+ * \copyright 2020 John Harwell, All rights reserved.
+ *
+ * This file is part of RCPPSW.
+ *
+ * RCPPSW is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * RCPPSW is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * RCPPSW.  If not, see <http://www.gnu.org/licenses/
+ */
+
+#ifndef INCLUDE_RCPPSW_ALGORITHM_CLUSTERING_ENTROPY_EH_GRID_OMP_HPP_
+#define INCLUDE_RCPPSW_ALGORITHM_CLUSTERING_ENTROPY_EH_GRID_OMP_HPP_
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <omp.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "rcppsw/rcppsw.hpp"
+#include "rcppsw/algorithm/clustering/eh_clustering_impl.hpp"
+#include "rcppsw/algorithm/clustering/soa_points.hpp"
+
+/*******************************************************************************
+ * Namespaces/Decls
+ ******************************************************************************/
+NS_START(rcppsw, algorithm, clustering);
+
+/*******************************************************************************
+ * Class Definitions
+ ******************************************************************************/
+/**
+ * \class entropy_eh_grid_omp
+ * \ingroup algorithm clustering
+ *
+ * \brief Parallel clustering using the Event Horizon (EH) membership policy
+ * with OpenMP, using a spatial index instead of comparing all pairs of points
+ * for every horizon as \ref entropy_eh_omp does. Suitable for information
+ * entropy calculations over many horizons.
+ *
+ * On the first iteration, the points are binned into a uniform grid whose cells
+ * are as large as the largest horizon (see \ref
+ * eh_clustering_impl::max_horizon()), and for each point, the distances to all
+ * points in the surrounding cells which are within the largest horizon are
+ * computed once and sorted. Because clusters only grow as the horizon
+ * increases, each iteration then just adds the next few neighbors from each
+ * list, so the total cost across all horizons is that of a single radius query
+ * per point (plus the membership updates), instead of N^2 distance
+ * computations per horizon.
+ *
+ * If the horizon decreases between iterations, the clusters are rebuilt from
+ * scratch; if it exceeds the largest horizon, the neighbor lists are rebuilt
+ * and each point resumes after the neighbors it already has.
+ *
+ * \tparam T The type of the data that is being clustered. It must be supported
+ *           by \ref point_traits, and the distance function must be no smaller
+ *           than the difference in any single coordinate (true of the L1, L2,
+ *           etc. distances), or the grid will miss neighbors.
+ */
+template <typename T>
+class entropy_eh_grid_omp final : public eh_clustering_impl<T> {
+ public:
+  using typename eh_clustering_impl<T>::cluster_vector;
+  using typename eh_clustering_impl<T>::dist_calc_ftype;
+  using eh_clustering_impl<T>::horizon;
+  using eh_clustering_impl<T>::max_horizon;
+
+  explicit entropy_eh_grid_omp(size_t n_threads) : mc_n_threads(n_threads) {}
+
+  void initialize(std::vector<T>* const data,
+                  membership_type<policy::EH>* const membership) override {
+    m_membership = membership;
+    m_neighbors.clear();
+    m_neighbors.resize(data->size());
+    m_cursors.assign(data->size(), 0);
+    m_scratch.assign(mc_n_threads, {});
+    m_radius = -1.0;
+    m_prev_horizon = -1.0;
+  }
+
+  void iterate(const std::vector<T>& data,
+               const dist_calc_ftype& dist_func,
+               cluster_vector* const clusters) override {
+    if (horizon() > m_radius) {
+      build_neighbors(data, dist_func, std::max(horizon(), max_horizon()));
+      /*
+       * The new lists start with the neighbors within the previous horizon,
+       * which are already members, so skip past them rather than re-adding
+       * them.
+       */
+      for (size_t i = 0; i < data.size(); ++i) {
+        const std::vector<neighbor>& neighbors = m_neighbors[i];
+        size_t& cursor = m_cursors[i];
+        cursor = 0;
+        while (cursor < neighbors.size() &&
+               neighbors[cursor].dist <= m_prev_horizon) {
+          ++cursor;
+        } /* while() */
+      } /* for(i..) */
+    }
+    if (horizon() < m_prev_horizon) {
+      for (auto& m : *m_membership) {
+        m.clear();
+      } /* for(&m..) */
+      m_cursors.assign(data.size(), 0);
+    }
+    m_prev_horizon = horizon();
+
+    /*
+     * Neighbors are added in distance order rather than index order, so each
+     * cluster needs to be merged afterwards.
+     */
+#pragma omp parallel for num_threads(mc_n_threads) schedule(dynamic, 64)
+    for (size_t i = 0; i < data.size(); ++i) {
+      const std::vector<neighbor>& neighbors = m_neighbors[i];
+      size_t& cursor = m_cursors[i];
+      while (cursor < neighbors.size() &&
+             neighbors[cursor].dist <= horizon()) {
+        (*clusters)[i].add_point(neighbors[cursor].idx);
+        ++cursor;
+      } /* while() */
+      auto tid = static_cast<size_t>(omp_get_thread_num());
+      (*clusters)[i].merge_points(&m_scratch[tid]);
+    } /* for(i..) */
+  }
+
+  bool converged(const cluster_vector&) const override { return false; }
+  void post_iter_update(cluster_vector* const) override {}
+
+  size_t n_threads(void) const { return mc_n_threads; }
+
+ private:
+  static constexpr size_t kDim = point_traits<T>::kDim;
+
+  using cell_type = std::array<int64_t, kDim>;
+
+  struct neighbor {
+    double dist;
+    size_t idx;
+  };
+
+  struct cell_hash {
+    size_t operator()(const cell_type& cell) const {
+      size_t h = 0;
+      for (auto c : cell) {
+        h = h * 0x9E3779B97F4A7C15ULL + static_cast<size_t>(c);
+      } /* for(c..) */
+      return h ^ (h >> 29);
+    }
+  };
+
+  cell_type to_cell(const T& point) const {
+    cell_type cell;
+    for (size_t d = 0; d < kDim; ++d) {
+      cell[d] = static_cast<int64_t>(
+          std::floor(point_traits<T>::get(point, d) / m_cell_size));
+    } /* for(d..) */
+    return cell;
+  }
+
+  /**
+   * \brief Bin the points into the grid, and compute the sorted list of
+   * neighbors within \p radius of each point.
+   */
+  void build_neighbors(const std::vector<T>& data,
+                       const dist_calc_ftype& dist_func,
+                       double radius) {
+    m_radius = radius;
+
+    /* any cell size >= the radius works; 0 would put every point in its own */
+    m_cell_size = radius > 0.0 ? radius : 1.0;
+
+    std::unordered_map<cell_type, std::vector<size_t>, cell_hash> grid;
+    for (size_t i = 0; i < data.size(); ++i) {
+      grid[to_cell(data[i])].push_back(i);
+    } /* for(i..) */
+
+#pragma omp parallel for num_threads(mc_n_threads) schedule(dynamic, 64)
+    for (size_t i = 0; i < data.size(); ++i) {
+      std::vector<neighbor>& neighbors = m_neighbors[i];
+      neighbors.clear();
+      cell_type center = to_cell(data[i]);
+
+      /* visit the 3^D cells around (and including) the point's cell */
+      std::array<int64_t, kDim> offset;
+      offset.fill(-1);
+      while (true) {
+        cell_type cell;
+        for (size_t d = 0; d < kDim; ++d) {
+          cell[d] = center[d] + offset[d];
+        } /* for(d..) */
+
+        auto it = grid.find(cell);
+        if (grid.end() != it) {
+          for (size_t j : it->second) {
+            double dist = dist_func(data[i], data[j]);
+            if (dist <= radius) {
+              neighbors.push_back({ dist, j });
+            }
+          } /* for(j..) */
+        }
+
+        size_t d = 0;
+        while (d < kDim && 1 == offset[d]) {
+          offset[d++] = -1;
+        } /* while() */
+        if (kDim == d) {
+          break;
+        }
+        ++offset[d];
+      } /* while() */
+
+      std::sort(neighbors.begin(),
+                neighbors.end(),
+                [](const neighbor& a, const neighbor& b) {
+                  return a.dist < b.dist;
+                });
+    } /* for(i..) */
+  }
+
+  /* clang-format off */
+  const size_t                       mc_n_threads;
+
+  membership_type<policy::EH>*       m_membership{nullptr};
+  double                             m_radius{-1.0};
+  double                             m_cell_size{1.0};
+  double                             m_prev_horizon{-1.0};
+
+  /* per point: neighbors within m_radius sorted by distance, and how many
+   * of them are already in its cluster */
+  std::vector<std::vector<neighbor>> m_neighbors{};
+  std::vector<size_t>                m_cursors{};
+
+  /* per thread scratch space for merging cluster memberships */
+  std::vector<std::vector<size_t>>   m_scratch{};
+  /* clang-format on */
+};
+
+NS_END(clustering, algorithm, rcppsw);
+
+#endif /* INCLUDE_RCPPSW_ALGORITHM_CLUSTERING_ENTROPY_EH_GRID_OMP_HPP_ */
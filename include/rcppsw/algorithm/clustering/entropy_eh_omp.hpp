@@ -53,18 +53,24 @@ class entropy_eh_omp final : public eh_clustering_impl<T> {
 
   explicit entropy_eh_omp(size_t n_threads) : mc_n_threads(n_threads) {}
 
-  void initialize(std::vector<T>* const data,
-                  membership_type<policy::EH>* const membership) override {
-    for (auto &m : *membership) {
-      m.reserve(data->size());
-    } /* for(&m..) */
-  }
+  /*
+   * Cluster memberships are not reserved up front, as that would take O(N^2)
+   * memory regardless of the horizons; they grow geometrically instead.
+   */
+  void initialize(std::vector<T>* const,
+                  membership_type<policy::EH>* const) override {}
 
+  /*
+   * Each cluster is rebuilt for every horizon by a single thread, visiting
+   * points in index order, so all points are appended to the membership
+   * directly and no merging is needed.
+   */
   void iterate(const std::vector<T>& data,
                const dist_calc_ftype& dist_func,
                cluster_vector* const clusters) override {
     #pragma omp parallel for num_threads(mc_n_threads)
     for (size_t i = 0; i < data.size(); ++i) {
+      (*clusters)[i].clear();
       for (size_t j = 0; j < data.size(); ++j) {
         if (dist_func(data[i], data[j]) <= horizon()) {
           (*clusters)[i].add_point(j);
@@ -112,6 +112,7 @@ class kmeans : public er::client<kmeans<T>> {
      * the now-copied data.
      */
     m_clusters = clusters_init();
+    m_impl->seed_centers(m_data, dist_func, &m_clusters);
 
     ER_INFO("Begin n_clusters=%zu, n_datapoints=%zu",
             m_clusters.size(),
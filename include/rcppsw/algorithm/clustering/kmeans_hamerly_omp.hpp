@@ -0,0 +1,320 @@
+/**
+ * \file kmeans_hamerly_omp.hpp
+ *
+ * \copyright 2020 John Harwell, All rights reserved.
+ *
+ * This file is part of RCPPSW.
+ *
+ * RCPPSW is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * RCPPSW is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * RCPPSW.  If not, see <http://www.gnu.org/licenses/
+ */
+
+#ifndef INCLUDE_RCPPSW_ALGORITHM_CLUSTERING_KMEANS_HAMERLY_OMP_HPP_
+#define INCLUDE_RCPPSW_ALGORITHM_CLUSTERING_KMEANS_HAMERLY_OMP_HPP_
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <omp.h>
+#include <algorithm>
+#include <vector>
+#include <limits>
+
+#include "rcppsw/rcppsw.hpp"
+#include "rcppsw/math/rng.hpp"
+#include "rcppsw/algorithm/clustering/base_clustering_impl.hpp"
+
+/*******************************************************************************
+ * Namespaces/Decls
+ ******************************************************************************/
+NS_START(rcppsw, algorithm, clustering);
+
+/*******************************************************************************
+ * Class Definitions
+ ******************************************************************************/
+/**
+ * \class kmeans_hamerly_omp
+ * \ingroup algorithm clustering
+ *
+ * \brief Parallel kmeans clustering using OpenMP using the Nearest Centroid (NC)
+ * membership policy, which scales to millions of points:
+ *
+ * - Each iteration is O(N) (plus the distance computations), rather than O(N *
+ *   K): each thread accumulates per-cluster partial sums of the points it
+ *   assigns during \ref iterate(), and the partial sums are reduced once to get
+ *   the new centers, instead of each cluster scanning the whole dataset.
+ *
+ * - Hamerly's algorithm is used to skip distance computations: each point keeps
+ *   an upper bound on the distance to its assigned center and a lower bound on
+ *   the distance to every other center, which are updated by how far the
+ *   centers move each iteration. A point's distances to all centers are only
+ *   computed when the bounds can no longer prove its assignment unchanged,
+ *   which after the first few iterations is rare.
+ *
+ * - Initial centers can be chosen via kmeans++ (D^2 sampling using \ref
+ *   math::rng), which needs far fewer iterations than the first K points.
+ *
+ * The distance function must be a metric (in particular, satisfy the triangle
+ * inequality), or the pruning is not valid. The algorithm has converged when
+ * an iteration does not change any assignment.
+ */
+template <typename T>
+class kmeans_hamerly_omp : public base_clustering_impl<T, policy::NC> {
+ public:
+  using typename base_clustering_impl<T, policy::NC>::dist_calc_ftype;
+  using typename base_clustering_impl<T, policy::NC>::cluster_vector;
+
+  enum class seeding {
+    ekFIRST_K,
+    ekPLUSPLUS
+  };
+
+  /**
+   * \param n_threads # of OpenMP threads to use.
+   * \param method How to choose the initial centers.
+   * \param seed Seed for kmeans++ seeding.
+   */
+  explicit kmeans_hamerly_omp(size_t n_threads,
+                              seeding method = seeding::ekPLUSPLUS,
+                              size_t seed = 0)
+      : m_n_threads(n_threads),
+        mc_seeding(method),
+        m_rng(seed),
+        m_sums(n_threads),
+        m_counts(n_threads) {}
+
+  void initialize(std::vector<T>* const data,
+                  membership_type<policy::NC>* const membership) override {
+    m_membership = membership;
+    m_upper.resize(data->size());
+    m_lower.resize(data->size());
+    first_touch_allocation(data, membership);
+  }
+
+  void seed_centers(const std::vector<T>& data,
+                    const dist_calc_ftype& dist_func,
+                    cluster_vector* const clusters) override {
+    if (seeding::ekFIRST_K == mc_seeding || clusters->empty() ||
+        data.empty()) {
+      return;
+    }
+    size_t n = data.size();
+
+    /* min squared distance from each point to the centers chosen so far */
+    std::vector<double> d2(n, std::numeric_limits<double>::max());
+    (*clusters)[0].center(data[m_rng.uniform<size_t>(0, n - 1)]);
+
+    for (size_t j = 1; j < clusters->size(); ++j) {
+      const T& last = (*clusters)[j - 1].center();
+      double sum = 0.0;
+#pragma omp parallel for num_threads(m_n_threads) reduction(+ : sum)
+      for (size_t i = 0; i < n; ++i) {
+        double dist = dist_func(data[i], last);
+        d2[i] = std::min(d2[i], dist * dist);
+        sum += d2[i];
+      } /* for(i..) */
+
+      double r = m_rng.uniform<double>(0.0, sum);
+      size_t pick = n - 1;
+      for (size_t i = 0; i < n; ++i) {
+        r -= d2[i];
+        if (r <= 0.0) {
+          pick = i;
+          break;
+        }
+      } /* for(i..) */
+      (*clusters)[j].center(data[pick]);
+    } /* for(j..) */
+  }
+
+  RCPPSW_PURE bool converged(const cluster_vector&) const override {
+    return 0 == m_n_changed;
+  }
+
+  void iterate(const std::vector<T>& data,
+               const dist_calc_ftype& dist_func,
+               cluster_vector* const clusters) override {
+    size_t k = clusters->size();
+    m_dist_func = &dist_func;
+    calc_half_separations(*clusters);
+
+    size_t n_changed = 0;
+
+    /* not in the parallel region, in case OpenMP gives us fewer threads */
+    for (size_t t = 0; t < m_n_threads; ++t) {
+      m_sums[t].assign(k, T{});
+      m_counts[t].assign(k, 0);
+    } /* for(t..) */
+
+#pragma omp parallel num_threads(m_n_threads) reduction(+ : n_changed)
+    {
+      auto tid = static_cast<size_t>(omp_get_thread_num());
+      std::vector<T>& sums = m_sums[tid];
+      std::vector<size_t>& counts = m_counts[tid];
+
+#pragma omp for
+      for (size_t i = 0; i < data.size(); ++i) {
+        size_t assigned = (*m_membership)[i];
+        if (assigned >= k || !bounds_hold(i, assigned, data[i], *clusters)) {
+          size_t closest = nearest(i, data[i], *clusters);
+          if (closest != assigned) {
+            (*clusters)[closest].add_point(i);
+            assigned = closest;
+            ++n_changed;
+          }
+        }
+        sums[assigned] += data[i];
+        ++counts[assigned];
+      } /* for(i..) */
+    }
+    m_n_changed = n_changed;
+
+    /* reduce the per-thread partial sums to get the new centers */
+    m_next.assign(k, T{});
+    std::vector<size_t> counts(k, 0);
+    for (size_t t = 0; t < m_n_threads; ++t) {
+      for (size_t j = 0; j < m_sums[t].size(); ++j) {
+        m_next[j] += m_sums[t][j];
+        counts[j] += m_counts[t][j];
+      } /* for(j..) */
+    } /* for(t..) */
+    for (size_t j = 0; j < k; ++j) {
+      if (counts[j] > 0) {
+        m_next[j] /= counts[j];
+      } else {
+        m_next[j] = (*clusters)[j].center();
+      }
+    } /* for(j..) */
+  }
+
+  void post_iter_update(cluster_vector* const clusters) override {
+    /* move the centers, and loosen the bounds by how far they moved */
+    size_t k = clusters->size();
+    m_moved.resize(k);
+    size_t max_idx = 0;
+    double max1 = 0.0;
+    double max2 = 0.0;
+    for (size_t j = 0; j < k; ++j) {
+      m_moved[j] = (*m_dist_func)((*clusters)[j].center(), m_next[j]);
+      (*clusters)[j].center(m_next[j]);
+      if (m_moved[j] > max1) {
+        max2 = max1;
+        max1 = m_moved[j];
+        max_idx = j;
+      } else if (m_moved[j] > max2) {
+        max2 = m_moved[j];
+      }
+    } /* for(j..) */
+
+#pragma omp parallel for num_threads(m_n_threads)
+    for (size_t i = 0; i < m_upper.size(); ++i) {
+      size_t assigned = (*m_membership)[i];
+      m_upper[i] += m_moved[assigned];
+      m_lower[i] -= (assigned == max_idx) ? max2 : max1;
+    } /* for(i..) */
+  }
+
+ private:
+  void first_touch_allocation(std::vector<T>* const data,
+                              membership_type<policy::NC>* const membership) {
+#pragma omp parallel for num_threads(m_n_threads)
+    for (size_t i = 0; i < data->size(); ++i) {
+      (*data)[i] = T{};
+      (*membership)[i] = static_cast<size_t>(-1);
+      m_upper[i] = std::numeric_limits<double>::max();
+      m_lower[i] = 0.0;
+    } /* for(i...) */
+  }
+
+  /**
+   * \brief Compute half the distance from each center to the nearest other
+   * center: a point closer than that to its center cannot be closer to any
+   * other.
+   */
+  void calc_half_separations(const cluster_vector& clusters) {
+    size_t k = clusters.size();
+    m_half_sep.assign(k, std::numeric_limits<double>::max());
+    for (size_t j = 0; j < k; ++j) {
+      for (size_t j2 = j + 1; j2 < k; ++j2) {
+        double half = 0.5 * (*m_dist_func)(clusters[j].center(),
+                                           clusters[j2].center());
+        m_half_sep[j] = std::min(m_half_sep[j], half);
+        m_half_sep[j2] = std::min(m_half_sep[j2], half);
+      } /* for(j2..) */
+    } /* for(j..) */
+  }
+
+  /**
+   * \brief Determine if the bounds for point \p i prove that it is still
+   * closest to its \p assigned center, tightening the upper bound if needed.
+   */
+  bool bounds_hold(size_t i,
+                   size_t assigned,
+                   const T& point,
+                   const cluster_vector& clusters) {
+    double bound = std::max(m_half_sep[assigned], m_lower[i]);
+    if (m_upper[i] <= bound) {
+      return true;
+    }
+    m_upper[i] = (*m_dist_func)(point, clusters[assigned].center());
+    return m_upper[i] <= bound;
+  }
+
+  /**
+   * \brief Find the closest center to point \p i by brute force, resetting its
+   * bounds.
+   */
+  size_t nearest(size_t i, const T& point, const cluster_vector& clusters) {
+    size_t closest = 0;
+    double min1 = std::numeric_limits<double>::max();
+    double min2 = std::numeric_limits<double>::max();
+    for (size_t j = 0; j < clusters.size(); ++j) {
+      double dist = (*m_dist_func)(point, clusters[j].center());
+      if (dist < min1) {
+        min2 = min1;
+        min1 = dist;
+        closest = j;
+      } else if (dist < min2) {
+        min2 = dist;
+      }
+    } /* for(j..) */
+    m_upper[i] = min1;
+    m_lower[i] = min2;
+    return closest;
+  }
+
+  /* clang-format off */
+  size_t                           m_n_threads;
+  const seeding                    mc_seeding;
+  math::rng                        m_rng;
+  const dist_calc_ftype*           m_dist_func{nullptr};
+  membership_type<policy::NC>*     m_membership{nullptr};
+
+  /* Hamerly bounds, per point */
+  std::vector<double>              m_upper{};
+  std::vector<double>              m_lower{};
+
+  /* per center */
+  std::vector<double>              m_half_sep{};
+  std::vector<double>              m_moved{};
+  std::vector<T>                   m_next{};
+
+  /* per thread partial sums */
+  std::vector<std::vector<T>>      m_sums;
+  std::vector<std::vector<size_t>> m_counts;
+  size_t                           m_n_changed{0};
+  /* clang-format on */
+};
+
+NS_END(clustering, algorithm, rcppsw);
+
+#endif /* INCLUDE_RCPPSW_ALGORITHM_CLUSTERING_KMEANS_HAMERLY_OMP_HPP_ */
@@ -98,7 +98,7 @@ class kmeans_omp : public base_clustering_impl<T, policy::NC> {
                               membership_type<policy::NC>* const membership) {
 #pragma omp parallel for num_threads(m_n_threads)
     for (size_t i = 0; i < data->size(); ++i) {
-      (*data)[i] = 0;
+      (*data)[i] = T{};
       (*membership)[i] = -1;
     } /* for(i...) */
   }
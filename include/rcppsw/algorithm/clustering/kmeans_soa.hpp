@@ -0,0 +1,240 @@
+/**
+ * \file kmeans_soa.hpp
+ *
+ * \copyright 2020 John Harwell, All rights reserved.
+ *
+ * This file is part of RCPPSW.
+ *
+ * RCPPSW is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * RCPPSW is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * RCPPSW.  If not, see <http://www.gnu.org/licenses/
+ */
+
+#ifndef INCLUDE_RCPPSW_ALGORITHM_CLUSTERING_KMEANS_SOA_HPP_
+#define INCLUDE_RCPPSW_ALGORITHM_CLUSTERING_KMEANS_SOA_HPP_
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <omp.h>
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <vector>
+
+#include "rcppsw/rcppsw.hpp"
+#include "rcppsw/er/client.hpp"
+#include "rcppsw/algorithm/clustering/membership_policy.hpp"
+#include "rcppsw/algorithm/clustering/metrics.hpp"
+#include "rcppsw/algorithm/clustering/soa_points.hpp"
+
+/*******************************************************************************
+ * Namespaces/Decls
+ ******************************************************************************/
+NS_START(rcppsw, algorithm, clustering);
+
+/*******************************************************************************
+ * Class Definitions
+ ******************************************************************************/
+/**
+ * \class kmeans_soa
+ * \ingroup algorithm clustering
+ *
+ * \brief Parallel kmeans clustering using OpenMP using the Nearest Centroid (NC)
+ * membership policy, for points of fixed dimension \p D stored in \ref
+ * soa_points, with the distance metric \p TMetric (see \ref metric) known at
+ * compile time.
+ *
+ * Points are processed in blocks of \ref kBlockSize: for each center, the
+ * distances to all points in the block are accumulated one dimension at a
+ * time, which is a unit-stride loop with the metric inlined that the compiler
+ * can vectorize, and then the nearest center so far is updated for all points
+ * in the block. Each thread accumulates per-cluster partial sums of the points
+ * it assigns, which are reduced once per iteration to get the new centers.
+ *
+ * The initial centers are the first K points. The algorithm has converged when
+ * an iteration does not change any assignment.
+ */
+template <size_t D, typename TMetric = metric::squared_l2>
+class kmeans_soa : public er::client<kmeans_soa<D, TMetric>> {
+ public:
+  using point_type = typename soa_points<D>::point_type;
+
+  /**
+   * \brief # of points whose distances are computed together.
+   */
+  static constexpr size_t kBlockSize = 256;
+
+  /**
+   * \param k The # of clusters.
+   * \param max_iter Maximum # of iterations to perform.
+   * \param n_threads # of OpenMP threads to use.
+   */
+  kmeans_soa(size_t k, size_t max_iter, size_t n_threads)
+      : ER_CLIENT_INIT("rcppsw.algorithm.clustering.kmeans_soa"),
+        mc_k(k),
+        mc_max_iter(max_iter),
+        m_n_threads(n_threads),
+        m_sums(n_threads),
+        m_counts(n_threads) {}
+
+  /**
+   * \brief Perform clustering.
+   *
+   * \return A vector where the index corresponds to the index of the data point
+   * in \p points, and the value corresponds to the cluster to which the data
+   * point belongs.
+   */
+  membership_type<policy::NC> run(const soa_points<D>& points) {
+    ER_ASSERT(mc_k <= points.size(),
+              "Cannot make %zu clusters from %zu points",
+              mc_k,
+              points.size());
+    m_centers.resize(mc_k);
+    for (size_t j = 0; j < mc_k; ++j) {
+      m_centers[j] = points.point(j);
+    } /* for(j..) */
+
+    membership_type<policy::NC> membership(points.size(),
+                                           std::numeric_limits<size_t>::max());
+    ER_INFO("Begin n_clusters=%zu, n_datapoints=%zu", mc_k, points.size());
+
+    for (m_n_iter = 0; m_n_iter < mc_max_iter; ++m_n_iter) {
+      size_t n_changed = assign(points, &membership);
+      if (0 == n_changed) {
+        ER_INFO("Converged on iter%zu", m_n_iter);
+        break;
+      }
+      update_centers();
+    } /* for(m_n_iter..) */
+    return membership;
+  } /* run() */
+
+  const std::vector<point_type>& centers(void) const { return m_centers; }
+
+  /**
+   * \brief Get the # of iterations performed by the last \ref run().
+   */
+  size_t n_iter(void) const { return m_n_iter; }
+
+ private:
+  /**
+   * \brief Assign each point to its nearest center, accumulating the per-thread
+   * partial sums for the new centers.
+   *
+   * \return The # of points whose assignment changed.
+   */
+  size_t assign(const soa_points<D>& points,
+                membership_type<policy::NC>* const membership) {
+    size_t n = points.size();
+    size_t n_blocks = (n + kBlockSize - 1) / kBlockSize;
+    size_t n_changed = 0;
+
+    /* not in the parallel region, in case OpenMP gives us fewer threads */
+    for (size_t t = 0; t < m_n_threads; ++t) {
+      m_sums[t].assign(mc_k * D, 0.0);
+      m_counts[t].assign(mc_k, 0);
+    } /* for(t..) */
+
+#pragma omp parallel num_threads(m_n_threads) reduction(+ : n_changed)
+    {
+      auto tid = static_cast<size_t>(omp_get_thread_num());
+      std::vector<double>& sums = m_sums[tid];
+      std::vector<size_t>& counts = m_counts[tid];
+
+      alignas(64) double acc[kBlockSize];
+      alignas(64) double best[kBlockSize];
+      alignas(64) size_t closest[kBlockSize];
+
+#pragma omp for schedule(static)
+      for (size_t b = 0; b < n_blocks; ++b) {
+        size_t start = b * kBlockSize;
+        size_t len = std::min(kBlockSize, n - start);
+        std::fill(best, best + len, std::numeric_limits<double>::max());
+        std::fill(closest, closest + len, 0);
+
+        for (size_t j = 0; j < mc_k; ++j) {
+          std::fill(acc, acc + len, 0.0);
+          for (size_t d = 0; d < D; ++d) {
+            const double* x = points.dim(d) + start;
+            const double c = m_centers[j][d];
+#pragma omp simd aligned(acc : 64)
+            for (size_t i = 0; i < len; ++i) {
+              acc[i] += TMetric::term(x[i] - c);
+            } /* for(i..) */
+          } /* for(d..) */
+
+          /* finish() is monotone, so compare the sums directly */
+#pragma omp simd aligned(acc, best, closest : 64)
+          for (size_t i = 0; i < len; ++i) {
+            bool closer = acc[i] < best[i];
+            best[i] = closer ? acc[i] : best[i];
+            closest[i] = closer ? j : closest[i];
+          } /* for(i..) */
+        } /* for(j..) */
+
+        for (size_t i = 0; i < len; ++i) {
+          size_t& label = (*membership)[start + i];
+          n_changed += (label != closest[i]);
+          label = closest[i];
+          ++counts[closest[i]];
+        } /* for(i..) */
+        for (size_t d = 0; d < D; ++d) {
+          const double* x = points.dim(d) + start;
+          for (size_t i = 0; i < len; ++i) {
+            sums[closest[i] * D + d] += x[i];
+          } /* for(i..) */
+        } /* for(d..) */
+      } /* for(b..) */
+    }
+    return n_changed;
+  }
+
+  /**
+   * \brief Reduce the per-thread partial sums to get the new centers. Clusters
+   * with no points keep their current center.
+   */
+  void update_centers(void) {
+    for (size_t j = 0; j < mc_k; ++j) {
+      size_t count = 0;
+      point_type sum{};
+      for (size_t t = 0; t < m_n_threads; ++t) {
+        count += m_counts[t][j];
+        for (size_t d = 0; d < D; ++d) {
+          sum[d] += m_sums[t][j * D + d];
+        } /* for(d..) */
+      } /* for(t..) */
+      if (0 == count) {
+        continue;
+      }
+      for (size_t d = 0; d < D; ++d) {
+        m_centers[j][d] = sum[d] / count;
+      } /* for(d..) */
+    } /* for(j..) */
+  }
+
+  /* clang-format off */
+  const size_t                     mc_k;
+  const size_t                     mc_max_iter;
+
+  size_t                           m_n_threads;
+  size_t                           m_n_iter{0};
+  std::vector<point_type>          m_centers{};
+
+  /* per thread partial sums, [center * D + dimension] */
+  std::vector<std::vector<double>> m_sums;
+  std::vector<std::vector<size_t>> m_counts;
+  /* clang-format on */
+};
+
+NS_END(clustering, algorithm, rcppsw);
+
+#endif /* INCLUDE_RCPPSW_ALGORITHM_CLUSTERING_KMEANS_SOA_HPP_ */
@@ -0,0 +1,300 @@
+/**
+ * \file kmeans_stream.hpp
+ *
+ * \copyright 2020 John Harwell, All rights reserved.
+ *
+ * This file is part of RCPPSW.
+ *
+ * RCPPSW is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * RCPPSW is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * RCPPSW.  If not, see <http://www.gnu.org/licenses/
+ */
+
+#ifndef INCLUDE_RCPPSW_ALGORITHM_CLUSTERING_KMEANS_STREAM_HPP_
+#define INCLUDE_RCPPSW_ALGORITHM_CLUSTERING_KMEANS_STREAM_HPP_
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <omp.h>
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "rcppsw/rcppsw.hpp"
+#include "rcppsw/er/client.hpp"
+#include "rcppsw/math/rng.hpp"
+#include "rcppsw/algorithm/clustering/membership_policy.hpp"
+
+/*******************************************************************************
+ * Namespaces/Decls
+ ******************************************************************************/
+NS_START(rcppsw, algorithm, clustering);
+
+/*******************************************************************************
+ * Class Definitions
+ ******************************************************************************/
+/**
+ * \class kmeans_stream
+ * \ingroup algorithm clustering
+ *
+ * \brief Mini-batch/streaming kmeans clustering using the Nearest Centroid (NC)
+ * membership policy, for data which arrives incrementally (e.g., agent
+ * positions each timestep), rather than all at once as with \ref kmeans.
+ *
+ * Each call to \ref add_points() assigns the points in the batch to their
+ * nearest center (in parallel using OpenMP), and then moves each center
+ * towards the mean of the points assigned to it, with a per-center learning
+ * rate of (# points in the batch assigned to it) / (# points ever assigned to
+ * it). Without a count cap, each center is thus the exact running mean of the
+ * points assigned to it; with one, the learning rate never drops below
+ * 1/cap, so that old points are gradually forgotten and the centers can track
+ * clusters which move over time.
+ *
+ * Only the centers, their counts, and the membership of the most recent batch
+ * are kept, so memory use is independent of the # of points seen, and the cost
+ * of each call is O(batch size * K).
+ *
+ * Until K centers exist, centers are chosen from incoming batches via kmeans++
+ * (D^2 sampling using \ref math::rng).
+ *
+ * \tparam T The type of the data that is being clustered. It must support the
+ *           following operations: +=, -=, *= (double), /= (size_t), = .
+ */
+template <typename T>
+class kmeans_stream : public er::client<kmeans_stream<T>> {
+ public:
+  using dist_calc_ftype = std::function<double(const T&, const T&)>;
+
+  /**
+   * \param k The # of clusters. Must be > 0.
+   * \param n_threads # of OpenMP threads to use for assigning points.
+   * \param dist_func The distance function to use.
+   * \param max_count Cap on the per-center point counts used to compute
+   *                  learning rates; 0 disables the cap.
+   * \param seed Seed for kmeans++ seeding.
+   */
+  kmeans_stream(size_t k,
+                size_t n_threads,
+                dist_calc_ftype dist_func,
+                size_t max_count = 0,
+                size_t seed = 0)
+      : ER_CLIENT_INIT("rcppsw.algorithm.clustering.kmeans_stream"),
+        mc_k(k),
+        mc_max_count(max_count),
+        m_n_threads(n_threads),
+        m_dist_func(std::move(dist_func)),
+        m_rng(seed) {
+    ER_ASSERT(mc_k > 0, "Number of clusters must be > 0");
+  }
+
+  /* Not copy constructable/assignable by default */
+  kmeans_stream(const kmeans_stream&) = delete;
+  const kmeans_stream& operator=(const kmeans_stream&) = delete;
+
+  /**
+   * \brief Add a batch of points, assigning each to its nearest center and
+   * updating the centers.
+   *
+   * \return The membership of the points in the batch: the index corresponds
+   * to the index of the point in the batch, and the value to the cluster to
+   * which it belongs.
+   */
+  const membership_type<policy::NC>& add_points(const std::vector<T>& batch) {
+    if (m_centers.size() < mc_k) {
+      seed_centers(batch);
+    }
+    m_membership.resize(batch.size());
+    assign(batch, &m_membership);
+
+    /* per-center sums/counts for the batch */
+    size_t k = m_centers.size();
+    m_sums.assign(k, T{});
+    m_batch_counts.assign(k, 0);
+    for (size_t i = 0; i < batch.size(); ++i) {
+      m_sums[m_membership[i]] += batch[i];
+      ++m_batch_counts[m_membership[i]];
+    } /* for(i..) */
+
+    for (size_t j = 0; j < k; ++j) {
+      if (0 == m_batch_counts[j]) {
+        continue;
+      }
+      m_counts[j] += m_batch_counts[j];
+      if (mc_max_count > 0) {
+        m_counts[j] = std::min(m_counts[j], mc_max_count);
+      }
+      double eta = static_cast<double>(m_batch_counts[j]) / m_counts[j];
+
+      /* center += (batch mean - center) * eta */
+      T delta = m_sums[j];
+      delta /= m_batch_counts[j];
+      delta -= m_centers[j];
+      delta *= std::min(eta, 1.0);
+      m_centers[j] += delta;
+    } /* for(j..) */
+
+    m_n_points += batch.size();
+    ER_DEBUG("Added batch: n_points=%zu, n_total=%zu, n_clusters=%zu",
+             batch.size(),
+             m_n_points,
+             k);
+    return m_membership;
+  } /* add_points() */
+
+  /**
+   * \brief Get the membership of the most recently added batch.
+   */
+  const membership_type<policy::NC>& membership(void) const {
+    return m_membership;
+  }
+
+  /**
+   * \brief Get the membership of arbitrary \p points with respect to the
+   * current centers, without updating them.
+   */
+  membership_type<policy::NC> membership(const std::vector<T>& points) const {
+    membership_type<policy::NC> ret(points.size());
+    assign(points, &ret);
+    return ret;
+  }
+
+  const std::vector<T>& centers(void) const { return m_centers; }
+  const std::vector<size_t>& counts(void) const { return m_counts; }
+
+  /**
+   * \brief Get the total # of points which have been added.
+   */
+  size_t n_points(void) const { return m_n_points; }
+
+  /**
+   * \brief Determine if all K centers have been chosen yet (they won't be if
+   * fewer than K distinct points have been added).
+   */
+  bool seeded(void) const { return m_centers.size() == mc_k; }
+
+  /**
+   * \brief Forget all centers and points.
+   */
+  void reset(void) {
+    m_centers.clear();
+    m_counts.clear();
+    m_membership.clear();
+    m_n_points = 0;
+  }
+
+ private:
+  /**
+   * \brief Choose centers from \p batch via kmeans++ until there are K of them,
+   * or there are no more points in the batch distinct from the existing
+   * centers.
+   */
+  void seed_centers(const std::vector<T>& batch) {
+    if (batch.empty()) {
+      return;
+    }
+    size_t n = batch.size();
+
+    /* min squared distance from each point to the centers chosen so far */
+    std::vector<double> d2(n, std::numeric_limits<double>::max());
+    if (m_centers.empty()) {
+      add_center(batch[m_rng.uniform<size_t>(0, n - 1)]);
+    }
+    for (auto& c : m_centers) {
+      update_d2(batch, c, &d2);
+    } /* for(&c..) */
+
+    while (m_centers.size() < mc_k) {
+      double sum = 0.0;
+      for (size_t i = 0; i < n; ++i) {
+        sum += d2[i];
+      } /* for(i..) */
+      if (sum <= 0.0) {
+        break;
+      }
+      double r = m_rng.uniform<double>(0.0, sum);
+      size_t pick = 0;
+      for (size_t i = 0; i < n; ++i) {
+        /* never pick a point which is already a center */
+        if (d2[i] <= 0.0) {
+          continue;
+        }
+        pick = i;
+        r -= d2[i];
+        if (r <= 0.0) {
+          break;
+        }
+      } /* for(i..) */
+      add_center(batch[pick]);
+      update_d2(batch, m_centers.back(), &d2);
+    } /* while() */
+  }
+
+  void add_center(const T& center) {
+    m_centers.push_back(center);
+    m_counts.push_back(0);
+  }
+
+  void update_d2(const std::vector<T>& batch,
+                 const T& center,
+                 std::vector<double>* const d2) const {
+#pragma omp parallel for num_threads(m_n_threads)
+    for (size_t i = 0; i < batch.size(); ++i) {
+      double dist = m_dist_func(batch[i], center);
+      (*d2)[i] = std::min((*d2)[i], dist * dist);
+    } /* for(i..) */
+  }
+
+  void assign(const std::vector<T>& points,
+              membership_type<policy::NC>* const membership) const {
+    ER_ASSERT(!m_centers.empty() || points.empty(),
+              "Cannot assign points before any centers are chosen");
+#pragma omp parallel for num_threads(m_n_threads)
+    for (size_t i = 0; i < points.size(); ++i) {
+      size_t closest = 0;
+      double min = std::numeric_limits<double>::max();
+      for (size_t j = 0; j < m_centers.size(); ++j) {
+        double dist = m_dist_func(points[i], m_centers[j]);
+        if (dist < min) {
+          min = dist;
+          closest = j;
+        }
+      } /* for(j..) */
+      (*membership)[i] = closest;
+    } /* for(i..) */
+  }
+
+  /* clang-format off */
+  const size_t                mc_k;
+  const size_t                mc_max_count;
+
+  size_t                      m_n_threads;
+  dist_calc_ftype             m_dist_func;
+  math::rng                   m_rng;
+  size_t                      m_n_points{0};
+
+  /* per center */
+  std::vector<T>              m_centers{};
+  std::vector<size_t>         m_counts{};
+
+  /* per center, for the current batch */
+  std::vector<T>              m_sums{};
+  std::vector<size_t>         m_batch_counts{};
+
+  membership_type<policy::NC> m_membership{};
+  /* clang-format on */
+};
+
+NS_END(clustering, algorithm, rcppsw);
+
+#endif /* INCLUDE_RCPPSW_ALGORITHM_CLUSTERING_KMEANS_STREAM_HPP_ */
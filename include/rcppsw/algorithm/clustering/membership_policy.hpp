@@ -25,9 +25,9 @@
  * Includes
  ******************************************************************************/
 #include <vector>
-#include <unordered_set>
 
 #include "rcppsw/rcppsw.hpp"
+#include "rcppsw/algorithm/clustering/eh_members.hpp"
 
 /*******************************************************************************
  * Namespaces/Decls
@@ -73,7 +73,7 @@ struct mapping<Policy, policy::is_nc<Policy>> {
 
 template<typename Policy>
 struct mapping<Policy, policy::is_eh<Policy>> {
-  using type = std::vector<std::unordered_set<size_t>>;
+  using type = std::vector<eh_members>;
 };
 }  // namespace membership
 
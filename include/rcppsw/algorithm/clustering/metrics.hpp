@@ -0,0 +1,114 @@
+/**
+ * \file metrics.hpp
+ *
+ * \copyright 2020 John Harwell, All rights reserved.
+ *
+ * This file is part of RCPPSW.
+ *
+ * RCPPSW is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * RCPPSW is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * RCPPSW.  If not, see <http://www.gnu.org/licenses/
+ */
+
+#ifndef INCLUDE_RCPPSW_ALGORITHM_CLUSTERING_METRICS_HPP_
+#define INCLUDE_RCPPSW_ALGORITHM_CLUSTERING_METRICS_HPP_
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <cmath>
+
+#include "rcppsw/rcppsw.hpp"
+#include "rcppsw/algorithm/clustering/soa_points.hpp"
+
+/*******************************************************************************
+ * Namespaces/Decls
+ ******************************************************************************/
+NS_START(rcppsw, algorithm, clustering, metric);
+
+/*******************************************************************************
+ * Class Definitions
+ ******************************************************************************/
+/*
+ * Distance metrics for clustering, as compile-time policies, so that they can
+ * be inlined into (and vectorized with) the loops which use them instead of
+ * being called through a std::function for each pair of points.
+ *
+ * Each metric is expressed as a per-dimension \c term() which is summed across
+ * dimensions, and a \c finish() applied to the sum. \c finish() is monotone,
+ * so nearest-neighbor searches can compare the sums directly and skip it.
+ *
+ * Each metric can also be called on a pair of points of any type supported by
+ * \ref point_traits, so it can be used as the distance function for the
+ * existing clustering implementations too.
+ */
+
+/**
+ * \struct l1
+ * \ingroup algorithm clustering
+ *
+ * \brief Manhattan distance.
+ */
+struct l1 {
+  static inline double term(double diff) { return std::fabs(diff); }
+  static inline double finish(double sum) { return sum; }
+
+  template <typename T>
+  double operator()(const T& a, const T& b) const {
+    double sum = 0.0;
+    for (size_t d = 0; d < point_traits<T>::kDim; ++d) {
+      sum += term(point_traits<T>::get(a, d) - point_traits<T>::get(b, d));
+    } /* for(d..) */
+    return finish(sum);
+  }
+};
+
+/**
+ * \struct squared_l2
+ * \ingroup algorithm clustering
+ *
+ * \brief Squared euclidean distance. Not a metric in the strict sense (it
+ * violates the triangle inequality), but gives the same nearest centers as
+ * \ref l2 more cheaply.
+ */
+struct squared_l2 {
+  static inline double term(double diff) { return diff * diff; }
+  static inline double finish(double sum) { return sum; }
+
+  template <typename T>
+  double operator()(const T& a, const T& b) const {
+    double sum = 0.0;
+    for (size_t d = 0; d < point_traits<T>::kDim; ++d) {
+      sum += term(point_traits<T>::get(a, d) - point_traits<T>::get(b, d));
+    } /* for(d..) */
+    return finish(sum);
+  }
+};
+
+/**
+ * \struct l2
+ * \ingroup algorithm clustering
+ *
+ * \brief Euclidean distance.
+ */
+struct l2 {
+  static inline double term(double diff) { return diff * diff; }
+  static inline double finish(double sum) { return std::sqrt(sum); }
+
+  template <typename T>
+  double operator()(const T& a, const T& b) const {
+    return finish(squared_l2()(a, b));
+  }
+};
+
+NS_END(metric, clustering, algorithm, rcppsw);
+
+#endif /* INCLUDE_RCPPSW_ALGORITHM_CLUSTERING_METRICS_HPP_ */
@@ -0,0 +1,180 @@
+/**
+ * \file soa_points.hpp
+ *
+ * \copyright 2020 John Harwell, All rights reserved.
+ *
+ * This file is part of RCPPSW.
+ *
+ * RCPPSW is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * RCPPSW is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * RCPPSW.  If not, see <http://www.gnu.org/licenses/
+ */
+
+#ifndef INCLUDE_RCPPSW_ALGORITHM_CLUSTERING_SOA_POINTS_HPP_
+#define INCLUDE_RCPPSW_ALGORITHM_CLUSTERING_SOA_POINTS_HPP_
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <array>
+#include <vector>
+
+#include "rcppsw/rcppsw.hpp"
+#include "rcppsw/math/vector2.hpp"
+#include "rcppsw/math/vector3.hpp"
+
+/*******************************************************************************
+ * Namespaces/Decls
+ ******************************************************************************/
+NS_START(rcppsw, algorithm, clustering);
+
+/*******************************************************************************
+ * Template Helpers
+ ******************************************************************************/
+/**
+ * \struct point_traits
+ * \ingroup algorithm clustering
+ *
+ * \brief Maps a point type to its dimension and coordinates, so that it can be
+ * converted to/from \ref soa_points and used with the metrics in \ref metric.
+ */
+template <typename T>
+struct point_traits;
+
+template <>
+struct point_traits<double> {
+  static constexpr size_t kDim = 1;
+  static double get(const double& p, size_t) { return p; }
+};
+
+template <typename U>
+struct point_traits<math::vector2<U>> {
+  static constexpr size_t kDim = 2;
+  static double get(const math::vector2<U>& p, size_t d) {
+    return 0 == d ? p.x() : p.y();
+  }
+};
+
+template <typename U>
+struct point_traits<math::vector3<U>> {
+  static constexpr size_t kDim = 3;
+  static double get(const math::vector3<U>& p, size_t d) {
+    return 0 == d ? p.x() : (1 == d ? p.y() : p.z());
+  }
+};
+
+template <size_t D>
+struct point_traits<std::array<double, D>> {
+  static constexpr size_t kDim = D;
+  static double get(const std::array<double, D>& p, size_t d) { return p[d]; }
+};
+
+/*******************************************************************************
+ * Class Definitions
+ ******************************************************************************/
+/**
+ * \class soa_points
+ * \ingroup algorithm clustering
+ *
+ * \brief A set of points of fixed dimension \p D stored as a structure of
+ * arrays: all the coordinates of dimension 0, then of dimension 1, etc., each
+ * starting on a cache line boundary and padded to a whole # of cache
+ * lines. Loops over points which read one coordinate at a time are then
+ * unit-stride and can be vectorized, unlike loops over a std::vector of point
+ * objects.
+ */
+template <size_t D>
+class soa_points {
+ public:
+  using point_type = std::array<double, D>;
+
+  /**
+   * \brief # of doubles each dimension is padded to a multiple of.
+   */
+  static constexpr size_t kPadding = 8;
+
+  static constexpr size_t kDim = D;
+
+  soa_points(void) = default;
+
+  explicit soa_points(size_t n)
+      : m_size(n),
+        m_stride(padded(n)),
+        m_lines(m_stride / kPadding * D) {}
+
+  /**
+   * \brief Convert a vector of points of any type supported by \ref
+   * point_traits with dimension \p D.
+   */
+  template <typename T>
+  static soa_points from(const std::vector<T>& points) {
+    static_assert(point_traits<T>::kDim == D, "Point dimension mismatch");
+    soa_points ret(points.size());
+    for (size_t d = 0; d < D; ++d) {
+      double* coords = ret.dim(d);
+      for (size_t i = 0; i < points.size(); ++i) {
+        coords[i] = point_traits<T>::get(points[i], d);
+      } /* for(i..) */
+    } /* for(d..) */
+    return ret;
+  }
+
+  size_t size(void) const { return m_size; }
+  bool empty(void) const { return 0 == m_size; }
+
+  /**
+   * \brief Get the coordinates of all points in dimension \p d.
+   */
+  double* dim(size_t d) { return base() + d * m_stride; }
+  const double* dim(size_t d) const { return base() + d * m_stride; }
+
+  point_type point(size_t i) const {
+    point_type ret;
+    for (size_t d = 0; d < D; ++d) {
+      ret[d] = dim(d)[i];
+    } /* for(d..) */
+    return ret;
+  }
+
+  void point(size_t i, const point_type& p) {
+    for (size_t d = 0; d < D; ++d) {
+      dim(d)[i] = p[d];
+    } /* for(d..) */
+  }
+
+ private:
+  static size_t padded(size_t n) {
+    return (n + kPadding - 1) / kPadding * kPadding;
+  }
+
+  /**
+   * \brief One cache line of coordinates. Over-aligned, so (as of C++17)
+   * std::vector allocates it with the correct alignment.
+   */
+  struct alignas(kPadding * sizeof(double)) line {
+    double coords[kPadding];
+  };
+
+  double* base(void) { return reinterpret_cast<double*>(m_lines.data()); }
+  const double* base(void) const {
+    return reinterpret_cast<const double*>(m_lines.data());
+  }
+
+  /* clang-format off */
+  size_t              m_size{0};
+  size_t              m_stride{0};
+  std::vector<line>   m_lines{};
+  /* clang-format on */
+};
+
+NS_END(clustering, algorithm, rcppsw);
+
+#endif /* INCLUDE_RCPPSW_ALGORITHM_CLUSTERING_SOA_POINTS_HPP_ */
@@ -27,6 +27,7 @@
 #include <algorithm>
 #include <boost/multi_array.hpp>
 
+#include "rcppsw/ds/grid_bulk_ops.hpp"
 #include "rcppsw/math/vector2.hpp"
 
 /*******************************************************************************
@@ -98,6 +99,51 @@ class base_grid2D {
     return contains(pt.x(), pt.y());
   }
 
+  /**
+   * \brief Set every cell in the grid to \p value.
+   *
+   * \param n_threads # of OpenMP threads to split the rows of the grid across.
+   */
+  void fill(const T& value, size_t n_threads = 1) {
+    grid_bulk_ops::fill(grid().data(), rows(), row_len(), value, n_threads);
+  }
+
+  /**
+   * \brief Replace every cell in the grid with \p f(cell).
+   */
+  template <typename TFunc>
+  void transform(const TFunc& f, size_t n_threads = 1) {
+    grid_bulk_ops::transform(grid().data(), rows(), row_len(), f, n_threads);
+  }
+
+  /**
+   * \brief Multiply every cell in the grid by \p factor (e.g. to evaporate
+   * pheromones each timestep). Requires T::operator*=.
+   */
+  template <typename TFactor>
+  void decay(const TFactor& factor, size_t n_threads = 1) {
+    grid_bulk_ops::decay(grid().data(), rows(), row_len(), factor, n_threads);
+  }
+
+  /**
+   * \brief Reduce all cells in the grid with \p op, starting with \p init
+   * (see \ref grid_bulk_ops::reduce() for requirements when \p n_threads >
+   * 1).
+   */
+  template <typename TOp>
+  T reduce(const T& init, const TOp& op, size_t n_threads = 1) const {
+    return grid_bulk_ops::reduce(
+        grid().data(), rows(), row_len(), init, op, n_threads);
+  }
+
+  /**
+   * \brief Call \p f(i, j, cell) for every cell in the grid.
+   */
+  template <typename TFunc>
+  void for_each_cell(const TFunc& f, size_t n_threads = 1) {
+    grid_bulk_ops::for_each(grid().data(), rows(), row_len(), f, n_threads);
+  }
+
   /**
    * \brief Get a subcircle gridview from a grid. The subcircle extent is
    * cropped to the maximum boundaries of the parent grid.
@@ -172,6 +218,14 @@ class base_grid2D {
  protected:
   virtual const grid_type& grid(void) const = 0;
   virtual grid_type& grid(void) = 0;
+
+ private:
+  /*
+   * boost::multi_array uses C storage order by default, so a "row" for bulk
+   * operations is all the cells with the same X coordinate.
+   */
+  size_t rows(void) const { return grid().shape()[0]; }
+  size_t row_len(void) const { return grid().shape()[1]; }
 };
 
 NS_END(ds, rcppsw);
@@ -0,0 +1,331 @@
+/**
+ * \file flat_grid2D.hpp
+ *
+ * \copyright 2020 John Harwell, All rights reserved.
+ *
+ * This file is part of RCPPSW.
+ *
+ * RCPPSW is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * RCPPSW is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * RCPPSW.  If not, see <http://www.gnu.org/licenses/
+ */
+
+#ifndef INCLUDE_RCPPSW_DS_FLAT_GRID2D_HPP_
+#define INCLUDE_RCPPSW_DS_FLAT_GRID2D_HPP_
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <boost/align/aligned_allocator.hpp>
+#include <boost/multi_array.hpp>
+
+#include "rcppsw/ds/flat_grid2D_view.hpp"
+#include "rcppsw/ds/grid2D_layout.hpp"
+#include "rcppsw/ds/grid_bulk_ops.hpp"
+#include "rcppsw/math/vector2.hpp"
+#include "rcppsw/rcppsw.hpp"
+
+/*******************************************************************************
+ * Namespaces/Decls
+ ******************************************************************************/
+NS_START(rcppsw, ds);
+
+/*******************************************************************************
+ * Class Definitions
+ ******************************************************************************/
+/**
+ * \class flat_grid2D
+ * \ingroup ds
+ *
+ * \brief A 2D grid of SOMETHING stored in a single flat, cache-line aligned
+ * buffer, with the order of cells in the buffer defined by a layout policy
+ * (see \ref grid2D_layout).
+ *
+ * Functionally equivalent to \ref grid2D, but nothing is virtual: \ref access()
+ * computes the cell's offset with the layout's offset() (a single multiply-add
+ * for the default \ref grid2D_layout::row_major layout, a little integer
+ * arithmetic/bit twiddling for the others), which the compiler can inline into
+ * the caller's loop, the discrete dimensions are computed once at
+ * construction, and the const overloads do not bounce through a const_cast.
+ * Use this instead of \ref grid2D when cell access is in the innermost loop
+ * and you do not need to manipulate the grid through a \ref base_grid2D
+ * pointer.
+ *
+ * With the default \ref grid2D_layout::row_major layout, views returned by \ref
+ * subgrid() and \ref subcircle() are the same types as those returned by \ref
+ * base_grid2D, so code operating on views works with either. With other
+ * layouts they are \ref flat_grid2D_view objects, which support the same
+ * indexing and also iteration in storage order.
+ *
+ * \tparam T The type of the grid element. Must be default constructible.
+ * \tparam TLayout The storage layout policy.
+ */
+template <typename T, typename TLayout = grid2D_layout::row_major>
+class flat_grid2D {
+ public:
+  /**
+   * \brief Alignment of the start of the cell buffer, in bytes (one cache line
+   * on basically everything we run on).
+   */
+  static constexpr size_t kAlignment = 64;
+
+  using value_type = T;
+  using layout_type = TLayout;
+  using storage_type =
+      std::vector<T, boost::alignment::aligned_allocator<T, kAlignment>>;
+  using iterator = typename storage_type::iterator;
+  using const_iterator = typename storage_type::const_iterator;
+
+  using grid_ref_type = boost::multi_array_ref<T, 2>;
+  using const_grid_ref_type = boost::const_multi_array_ref<T, 2>;
+  using grid_view = typename std::conditional<
+      TLayout::kRowMajor,
+      typename grid_ref_type::template array_view<2>::type,
+      flat_grid2D_view<T, TLayout>>::type;
+  using const_grid_view = typename std::conditional<
+      TLayout::kRowMajor,
+      typename const_grid_ref_type::template const_array_view<2>::type,
+      flat_grid2D_view<const T, TLayout>>::type;
+  using index_range = typename grid_ref_type::index_range;
+
+  explicit flat_grid2D(const math::vector2z& dims)
+      : flat_grid2D(dims.x(), dims.y()) {}
+
+  flat_grid2D(size_t x_max, size_t y_max)
+      : mc_xdsize(x_max),
+        mc_ydsize(y_max),
+        mc_layout(x_max, y_max),
+        m_cells(mc_layout.capacity()) {}
+
+  /**
+   * \brief Get a reference to the cell at (i, j).
+   */
+  T& access(size_t i, size_t j) { return m_cells[offset(i, j)]; }
+  const T& access(size_t i, size_t j) const { return m_cells[offset(i, j)]; }
+
+  T& access(const math::vector2z& c) { return access(c.x(), c.y()); }
+  const T& access(const math::vector2z& c) const {
+    return access(c.x(), c.y());
+  }
+
+  T& operator[](const math::vector2z& c) { return access(c); }
+  const T& operator[](const math::vector2z& c) const { return access(c); }
+
+  /**
+   * \brief Get the discrete size of the X dimension of the grid.
+   */
+  size_t xdsize(void) const { return mc_xdsize; }
+
+  /**
+   * \brief Get the discrete size of the Y dimension of the grid.
+   */
+  size_t ydsize(void) const { return mc_ydsize; }
+
+  size_t xsize(void) const { return xdsize(); }
+  size_t ysize(void) const { return ydsize(); }
+
+  bool contains(size_t i, size_t j) const {
+    return i < xdsize() && j < ydsize();
+  }
+  bool contains(const math::vector2z& pt) const {
+    return contains(pt.x(), pt.y());
+  }
+
+  /**
+   * \brief Get the offset of cell (i, j) in the flat buffer.
+   */
+  size_t offset(size_t i, size_t j) const { return mc_layout.offset(i, j); }
+
+  const TLayout& layout(void) const { return mc_layout; }
+
+  /**
+   * \brief Direct access to the flat cell buffer, for bulk operations. Cells
+   * are laid out according to \p TLayout; for layouts other than row major
+   * the buffer can contain padding cells which are not part of the grid.
+   */
+  T* data(void) { return m_cells.data(); }
+  const T* data(void) const { return m_cells.data(); }
+
+  /**
+   * \brief Iterate over all cells in storage order (including padding).
+   */
+  iterator begin(void) { return m_cells.begin(); }
+  iterator end(void) { return m_cells.end(); }
+  const_iterator begin(void) const { return m_cells.begin(); }
+  const_iterator end(void) const { return m_cells.end(); }
+
+  /**
+   * \brief Set every cell in the grid to \p value.
+   *
+   * \param n_threads # of OpenMP threads to split the rows of the grid across
+   *                  (row major layout only; other layouts are processed
+   *                  serially in storage order).
+   */
+  void fill(const T& value, size_t n_threads = 1) {
+    if constexpr (TLayout::kRowMajor) {
+      grid_bulk_ops::fill(data(), xdsize(), ydsize(), value, n_threads);
+    } else {
+      for_each_cell([&](size_t, size_t, T& cell) { cell = value; });
+    }
+  }
+
+  /**
+   * \brief Replace every cell in the grid with \p f(cell).
+   */
+  template <typename TFunc>
+  void transform(const TFunc& f, size_t n_threads = 1) {
+    if constexpr (TLayout::kRowMajor) {
+      grid_bulk_ops::transform(data(), xdsize(), ydsize(), f, n_threads);
+    } else {
+      for_each_cell([&](size_t, size_t, T& cell) { cell = f(cell); });
+    }
+  }
+
+  /**
+   * \brief Multiply every cell in the grid by \p factor. Requires
+   * T::operator*=.
+   */
+  template <typename TFactor>
+  void decay(const TFactor& factor, size_t n_threads = 1) {
+    if constexpr (TLayout::kRowMajor) {
+      grid_bulk_ops::decay(data(), xdsize(), ydsize(), factor, n_threads);
+    } else {
+      for_each_cell([&](size_t, size_t, T& cell) { cell *= factor; });
+    }
+  }
+
+  /**
+   * \brief Reduce all cells in the grid with \p op, starting with \p init
+   * (see \ref grid_bulk_ops::reduce() for requirements when \p n_threads >
+   * 1). Padding cells are never included.
+   */
+  template <typename TOp>
+  T reduce(const T& init, const TOp& op, size_t n_threads = 1) const {
+    if constexpr (TLayout::kRowMajor) {
+      return grid_bulk_ops::reduce(
+          data(), xdsize(), ydsize(), init, op, n_threads);
+    } else {
+      T accum = init;
+      mc_layout.for_each(
+          { 0, 0 }, { xdsize(), ydsize() }, [&](size_t, size_t, size_t off) {
+            accum = op(accum, m_cells[off]);
+          });
+      return accum;
+    }
+  }
+
+  /**
+   * \brief Call \p f(i, j, cell) for every cell in the grid, in storage
+   * order. Padding cells are never visited.
+   */
+  template <typename TFunc>
+  void for_each_cell(const TFunc& f, size_t n_threads = 1) {
+    if constexpr (TLayout::kRowMajor) {
+      grid_bulk_ops::for_each(data(), xdsize(), ydsize(), f, n_threads);
+    } else {
+      mc_layout.for_each(
+          { 0, 0 }, { xdsize(), ydsize() }, [&](size_t i, size_t j, size_t off) {
+            f(i, j, m_cells[off]);
+          });
+    }
+  }
+
+  /**
+   * \brief Create a subgrid from a grid.
+   *
+   * \param ll Lower left of the subgrid, inclusive.
+   * \param ur Upper right of the subgrid, exclusive (same as \ref
+   *           base_grid2D::subgrid()).
+   */
+  grid_view subgrid(const math::vector2z& ll, const math::vector2z& ur) {
+    if constexpr (TLayout::kRowMajor) {
+      index_range x(ll.x(), ur.x(), 1);
+      index_range y(ll.y(), ur.y(), 1);
+      return grid_ref()[boost::indices[x][y]];
+    } else {
+      return grid_view(m_cells.data(), &mc_layout, ll, ur);
+    }
+  }
+
+  const_grid_view subgrid(const math::vector2z& ll,
+                          const math::vector2z& ur) const {
+    if constexpr (TLayout::kRowMajor) {
+      index_range x(ll.x(), ur.x(), 1);
+      index_range y(ll.y(), ur.y(), 1);
+      return grid_ref()[boost::indices[x][y]];
+    } else {
+      return const_grid_view(m_cells.data(), &mc_layout, ll, ur);
+    }
+  }
+
+  /**
+   * \brief Get a subcircle gridview from a grid. The subcircle extent is
+   * cropped to the maximum boundaries of the parent grid (see \ref
+   * base_grid2D::subcircle()).
+   *
+   * \param c Coordinates of center of subcircle.
+   * \param radius Radius of subcircle.
+   */
+  grid_view subcircle(const math::vector2z& c, size_t radius) {
+    auto bounds = subcircle_bounds(c, radius);
+    return subgrid(bounds.first, bounds.second);
+  }
+
+  const_grid_view subcircle(const math::vector2z& c, size_t radius) const {
+    auto bounds = subcircle_bounds(c, radius);
+    return subgrid(bounds.first, bounds.second);
+  }
+
+ private:
+  grid_ref_type grid_ref(void) {
+    return grid_ref_type(m_cells.data(), boost::extents[mc_xdsize][mc_ydsize]);
+  }
+  const_grid_ref_type grid_ref(void) const {
+    return const_grid_ref_type(m_cells.data(),
+                               boost::extents[mc_xdsize][mc_ydsize]);
+  }
+
+  std::pair<math::vector2z, math::vector2z>
+  subcircle_bounds(const math::vector2z& c, size_t radius) const {
+    auto ll_x =
+        std::max<int>(0, static_cast<int>(c.x()) - static_cast<int>(radius));
+    auto ll_y =
+        std::max<int>(0, static_cast<int>(c.y()) - static_cast<int>(radius));
+
+    /*
+     * boost uses half open interval for index ranges, and we want a closed
+     * interval, so we +1.
+     */
+    auto ur_x = std::min(c.x() + radius + 1, xdsize());
+    auto ur_y = std::min(c.y() + radius + 1, ydsize());
+
+    return { math::vector2z(ll_x, ll_y), math::vector2z(ur_x, ur_y) };
+  }
+
+  /* clang-format off */
+  const size_t  mc_xdsize;
+  const size_t  mc_ydsize;
+  const TLayout mc_layout;
+
+  storage_type  m_cells;
+  /* clang-format on */
+
+ public:
+  RCPPSW_WRAP_DECLDEF(size, m_cells, const);
+};
+
+NS_END(ds, rcppsw);
+
+#endif /* INCLUDE_RCPPSW_DS_FLAT_GRID2D_HPP_ */
@@ -0,0 +1,134 @@
+/**
+ * \file flat_grid2D_overlay.hpp
+ *
+ * \copyright 2020 John Harwell, All rights reserved.
+ *
+ * This file is part of RCPPSW.
+ *
+ * RCPPSW is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * RCPPSW is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * RCPPSW.  If not, see <http://www.gnu.org/licenses/
+ */
+
+#ifndef INCLUDE_RCPPSW_DS_FLAT_GRID2D_OVERLAY_HPP_
+#define INCLUDE_RCPPSW_DS_FLAT_GRID2D_OVERLAY_HPP_
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <cmath>
+
+#include "rcppsw/ds/flat_grid2D.hpp"
+#include "rcppsw/ds/grid_overlay.hpp"
+#include "rcppsw/er/client.hpp"
+
+/*******************************************************************************
+ * Namespaces/Decls
+ ******************************************************************************/
+NS_START(rcppsw, ds);
+
+/*******************************************************************************
+ * Class Definitions
+ ******************************************************************************/
+/**
+ * \class flat_grid2D_overlay
+ * \ingroup ds
+ *
+ * \brief A 2D logical grid overlayed over a continuous environment, using a
+ * \ref flat_grid2D for storage. Has the same interface as \ref grid2D_overlay,
+ * but cell access is not virtual and can be inlined.
+ *
+ * \tparam T The type of the grid element. Must be default constructible.
+ * \tparam TLayout The storage layout policy (see \ref grid2D_layout).
+ */
+template <typename T, typename TLayout = grid2D_layout::row_major>
+class flat_grid2D_overlay final
+    : public flat_grid2D<T, TLayout>,
+      public grid_overlay<math::vector2d>,
+      public er::client<flat_grid2D_overlay<T, TLayout>> {
+ public:
+  using typename flat_grid2D<T, TLayout>::grid_view;
+  using typename flat_grid2D<T, TLayout>::const_grid_view;
+
+  using flat_grid2D<T, TLayout>::access;
+  using flat_grid2D<T, TLayout>::xdsize;
+  using flat_grid2D<T, TLayout>::ydsize;
+
+  using grid_overlay<math::vector2d>::resolution;
+  using grid_overlay<math::vector2d>::originr;
+  using grid_overlay<math::vector2d>::origind;
+
+  /**
+   * \param origin The anchor point of the overlay grid in continuous space.
+   * \param dims The real size in X,Y which will be discretized into
+   *             X/\p grid_res discrete elements along the X dimension and
+   *             Y/\p grid_res discrete elements along the Y dimension.
+   * \param grid_res The discretization unit for the grid.
+   * \param field_res The discretization unit for the field the grid is
+   *                  contained in (can be the same as the \p grid_res).
+   */
+  flat_grid2D_overlay(const math::vector2d& origin,
+                      const math::vector2d& dims,
+                      const types::discretize_ratio& grid_res,
+                      const types::discretize_ratio& field_res)
+      : flat_grid2D<T, TLayout>(math::dvec2zvec(dims, grid_res.v())),
+        grid_overlay(origin, grid_res, field_res),
+        ER_CLIENT_INIT("rcppsw.ds.flat_grid2D_overlay"),
+        mc_dim(dims) {
+    RCPPSW_UNUSED double remx = std::remainder(mc_dim.x(), resolution().v());
+    RCPPSW_UNUSED double remy = std::remainder(mc_dim.y(), resolution().v());
+
+    /*
+     * Some values of dimensions and grid resolution might not be able to be
+     * represented exactly, so we can't just assert that the mod result =
+     * 0.0. Instead, we verify that IF the mod result is > 0.0 that it is also
+     * VERY close to the grid resolution.
+     */
+    ER_ASSERT(remx <= 1.0 / ONEE9,
+              "X dimension (%f) not an even multiple of resolution (%f)",
+              mc_dim.x(),
+              resolution().v());
+    ER_ASSERT(remy <= 1.0 / ONEE9,
+              "Y dimension (%f) not an even multiple of resolution (%f)",
+              mc_dim.y(),
+              resolution().v());
+  }
+
+  /**
+   * \brief Get the size of the X dimension (non-discretized).
+   */
+  double xrsize(void) const { return mc_dim.x(); }
+
+  /**
+   * \brief Get the size of the Y dimension (non-discretized).
+   */
+  double yrsize(void) const { return mc_dim.y(); }
+
+  /**
+   * \brief Get the real dimensions of the grid; that is, continuous floating
+   * point.
+   */
+  const math::vector2d& dimsr(void) const { return mc_dim; }
+
+  /**
+   * \brief Get the discrete dimensions of the grid.
+   */
+  math::vector2z dimsd(void) const { return { xdsize(), ydsize() }; }
+
+ private:
+  /* clang-format off */
+  const math::vector2d mc_dim;
+  /* clang-format on */
+};
+
+NS_END(ds, rcppsw);
+
+#endif /* INCLUDE_RCPPSW_DS_FLAT_GRID2D_OVERLAY_HPP_ */
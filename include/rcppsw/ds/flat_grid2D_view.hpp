@@ -0,0 +1,131 @@
+/**
+ * \file flat_grid2D_view.hpp
+ *
+ * \copyright 2020 John Harwell, All rights reserved.
+ *
+ * This file is part of RCPPSW.
+ *
+ * RCPPSW is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * RCPPSW is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * RCPPSW.  If not, see <http://www.gnu.org/licenses/
+ */
+
+#ifndef INCLUDE_RCPPSW_DS_FLAT_GRID2D_VIEW_HPP_
+#define INCLUDE_RCPPSW_DS_FLAT_GRID2D_VIEW_HPP_
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "rcppsw/math/vector2.hpp"
+#include "rcppsw/rcppsw.hpp"
+
+/*******************************************************************************
+ * Namespaces/Decls
+ ******************************************************************************/
+NS_START(rcppsw, ds);
+
+/*******************************************************************************
+ * Class Definitions
+ ******************************************************************************/
+/**
+ * \class flat_grid2D_view
+ * \ingroup ds
+ *
+ * \brief A view of a rectangular subgrid of a \ref flat_grid2D whose layout
+ * cannot be described with strides (and therefore cannot be handed out as a
+ * boost::multi_array view). Supports the same view[i][j] indexing and shape()
+ * as boost views, relative to the lower left corner of the view, plus
+ * iteration in storage order via \ref for_each().
+ *
+ * Like boost views, this does not own any data, and is invalidated if the
+ * parent grid is destroyed.
+ *
+ * \tparam TCell The type of the grid cells (const qualified for const views).
+ * \tparam TLayout The storage layout policy of the parent grid.
+ */
+template <typename TCell, typename TLayout>
+class flat_grid2D_view {
+ public:
+  using element = TCell;
+
+  /**
+   * \brief Proxy returned by operator[] so that view[i][j] works.
+   */
+  class row_proxy {
+   public:
+    row_proxy(const flat_grid2D_view* view, size_t i) : m_view(view), m_i(i) {}
+    TCell& operator[](size_t j) const { return m_view->access(m_i, j); }
+
+   private:
+    /* clang-format off */
+    const flat_grid2D_view* m_view;
+    size_t                  m_i;
+    /* clang-format on */
+  };
+
+  /**
+   * \param data The parent grid's cell buffer.
+   * \param layout The parent grid's layout.
+   * \param ll Lower left of the view in the parent, inclusive.
+   * \param ur Upper right of the view in the parent, exclusive.
+   */
+  flat_grid2D_view(TCell* data,
+                   const TLayout* layout,
+                   const math::vector2z& ll,
+                   const math::vector2z& ur)
+      : m_data(data),
+        m_layout(layout),
+        m_ll(ll),
+        m_ur(ur),
+        m_shape{ ur.x() - ll.x(), ur.y() - ll.y() } {}
+
+  /**
+   * \brief Get the cell at (i, j), relative to the lower left of the view.
+   */
+  TCell& access(size_t i, size_t j) const {
+    return m_data[m_layout->offset(m_ll.x() + i, m_ll.y() + j)];
+  }
+
+  row_proxy operator[](size_t i) const { return row_proxy(this, i); }
+
+  /**
+   * \brief Get the extents of the view, same as boost::multi_array::shape().
+   */
+  const size_t* shape(void) const { return m_shape; }
+
+  size_t num_elements(void) const { return m_shape[0] * m_shape[1]; }
+
+  /**
+   * \brief Call \p f(i, j, cell) for each cell in the view in the order the
+   * cells are stored in memory, which for non-row-major layouts is much faster
+   * than nested loops over i and j. (i, j) are relative to the lower left of
+   * the view.
+   */
+  template <typename TFunc>
+  void for_each(const TFunc& f) const {
+    m_layout->for_each(m_ll, m_ur, [&](size_t i, size_t j, size_t offset) {
+      f(i - m_ll.x(), j - m_ll.y(), m_data[offset]);
+    });
+  }
+
+ private:
+  /* clang-format off */
+  TCell*         m_data;
+  const TLayout* m_layout;
+  math::vector2z m_ll;
+  math::vector2z m_ur;
+  size_t         m_shape[2];
+  /* clang-format on */
+};
+
+NS_END(ds, rcppsw);
+
+#endif /* INCLUDE_RCPPSW_DS_FLAT_GRID2D_VIEW_HPP_ */
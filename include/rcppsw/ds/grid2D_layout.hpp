@@ -0,0 +1,263 @@
+/**
+ * \file grid2D_layout.hpp
+ *
+ * \copyright 2020 John Harwell, All rights reserved.
+ *
+ * This file is part of RCPPSW.
+ *
+ * RCPPSW is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * RCPPSW is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * RCPPSW.  If not, see <http://www.gnu.org/licenses/
+ */
+
+#ifndef INCLUDE_RCPPSW_DS_GRID2D_LAYOUT_HPP_
+#define INCLUDE_RCPPSW_DS_GRID2D_LAYOUT_HPP_
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <algorithm>
+#include <cstdint>
+
+#include "rcppsw/math/vector2.hpp"
+#include "rcppsw/rcppsw.hpp"
+
+/*******************************************************************************
+ * Namespaces/Decls
+ ******************************************************************************/
+NS_START(rcppsw, ds, grid2D_layout);
+
+/*******************************************************************************
+ * Class Definitions
+ ******************************************************************************/
+/**
+ * \class row_major
+ * \ingroup ds
+ *
+ * \brief Storage layout policy for \ref flat_grid2D: row-major (C storage
+ * order, Y varies fastest), same as boost::multi_array. No padding.
+ *
+ * All layout policies provide:
+ *
+ * - capacity() - The # of cells which must be allocated, including padding.
+ * - offset(i, j) - The offset of cell (i, j) in the flat buffer.
+ * - for_each(ll, ur, f) - Call f(i, j, offset) for every cell in the half-open
+ *   box [ll, ur), in increasing storage order.
+ */
+class row_major {
+ public:
+  /**
+   * \brief Row major storage can be viewed by boost::multi_array_ref.
+   */
+  static constexpr bool kRowMajor = true;
+
+  row_major(size_t xdsize, size_t ydsize)
+      : mc_ydsize(ydsize), mc_capacity(xdsize * ydsize) {}
+
+  size_t capacity(void) const { return mc_capacity; }
+
+  size_t offset(size_t i, size_t j) const { return i * mc_ydsize + j; }
+
+  template <typename TFunc>
+  void for_each(const math::vector2z& ll,
+                const math::vector2z& ur,
+                const TFunc& f) const {
+    for (size_t i = ll.x(); i < ur.x(); ++i) {
+      for (size_t j = ll.y(); j < ur.y(); ++j) {
+        f(i, j, offset(i, j));
+      } /* for(j..) */
+    } /* for(i..) */
+  }
+
+ private:
+  /* clang-format off */
+  const size_t mc_ydsize;
+  const size_t mc_capacity;
+  /* clang-format on */
+};
+
+/**
+ * \class tiled
+ * \ingroup ds
+ *
+ * \brief Storage layout policy for \ref flat_grid2D: the grid is divided into
+ * square tiles of \p TileDim x \p TileDim cells, which are stored contiguously
+ * (row-major within a tile, tiles row-major within the grid). With the default
+ * of 8, a tile of 8 byte cells is exactly 8 cache lines, so a small
+ * neighborhood query touches O(1) tiles instead of one cache line per row.
+ *
+ * Each dimension is padded up to a multiple of \p TileDim.
+ *
+ * \tparam TileDim The size of a tile side. Must be a power of 2.
+ */
+template <size_t TileDim = 8>
+class tiled {
+ public:
+  static_assert(TileDim > 0 && 0 == (TileDim & (TileDim - 1)),
+                "Tile dimension must be a power of 2");
+
+  static constexpr bool kRowMajor = false;
+
+  tiled(size_t xdsize, size_t ydsize)
+      : mc_xtiles((xdsize + TileDim - 1) / TileDim),
+        mc_ytiles((ydsize + TileDim - 1) / TileDim) {}
+
+  size_t capacity(void) const { return mc_xtiles * mc_ytiles * kTileSize; }
+
+  size_t offset(size_t i, size_t j) const {
+    size_t tile = (i / TileDim) * mc_ytiles + (j / TileDim);
+    return tile * kTileSize + (i % TileDim) * TileDim + (j % TileDim);
+  }
+
+  template <typename TFunc>
+  void for_each(const math::vector2z& ll,
+                const math::vector2z& ur,
+                const TFunc& f) const {
+    if (ur.x() <= ll.x() || ur.y() <= ll.y()) {
+      return;
+    }
+    for (size_t ti = ll.x() / TileDim; ti <= (ur.x() - 1) / TileDim; ++ti) {
+      size_t i_start = std::max(ll.x(), ti * TileDim);
+      size_t i_end = std::min(ur.x(), (ti + 1) * TileDim);
+      for (size_t tj = ll.y() / TileDim; tj <= (ur.y() - 1) / TileDim; ++tj) {
+        size_t j_start = std::max(ll.y(), tj * TileDim);
+        size_t j_end = std::min(ur.y(), (tj + 1) * TileDim);
+        for (size_t i = i_start; i < i_end; ++i) {
+          for (size_t j = j_start; j < j_end; ++j) {
+            f(i, j, offset(i, j));
+          } /* for(j..) */
+        } /* for(i..) */
+      } /* for(tj..) */
+    } /* for(ti..) */
+  }
+
+ private:
+  static constexpr size_t kTileSize = TileDim * TileDim;
+
+  /* clang-format off */
+  const size_t mc_xtiles;
+  const size_t mc_ytiles;
+  /* clang-format on */
+};
+
+/**
+ * \class morton
+ * \ingroup ds
+ *
+ * \brief Storage layout policy for \ref flat_grid2D: cells are stored in
+ * Z-order (Morton order), obtained by interleaving the bits of i and j. Cells
+ * which are close in 2D are close in memory at every scale, at the cost of
+ * padding the grid to a square with a power of 2 side, so it is only a good
+ * choice for (nearly) square grids.
+ */
+class morton {
+ public:
+  static constexpr bool kRowMajor = false;
+
+  morton(size_t xdsize, size_t ydsize)
+      : mc_side(pow2_ceil(std::max(xdsize, ydsize))) {}
+
+  size_t capacity(void) const { return mc_side * mc_side; }
+
+  size_t offset(size_t i, size_t j) const {
+    return (spread(i) << 1) | spread(j);
+  }
+
+  template <typename TFunc>
+  void for_each(const math::vector2z& ll,
+                const math::vector2z& ur,
+                const TFunc& f) const {
+    if (ur.x() <= ll.x() || ur.y() <= ll.y()) {
+      return;
+    }
+    visit(ll, ur, 0, 0, mc_side, 0, f);
+  }
+
+ private:
+  static size_t pow2_ceil(size_t n) {
+    size_t p = 1;
+    while (p < n) {
+      p <<= 1;
+    } /* while() */
+    return p;
+  }
+
+  /**
+   * \brief Visit the cells of the \p side x \p side quadrant with lower left
+   * corner (\p i0, \p j0) and first code \p base which are in the box, in code
+   * order. Each quadrant is the concatenation of its 4 sub-quadrants, so
+   * quadrants outside the box can be skipped entirely, and quadrants inside it
+   * are a contiguous range of codes, which makes the cost proportional to the
+   * size of the box rather than the range of codes it spans.
+   */
+  template <typename TFunc>
+  static void visit(const math::vector2z& ll,
+                    const math::vector2z& ur,
+                    size_t i0,
+                    size_t j0,
+                    size_t side,
+                    size_t base,
+                    const TFunc& f) {
+    if (i0 >= ur.x() || i0 + side <= ll.x() || j0 >= ur.y() ||
+        j0 + side <= ll.y()) {
+      return;
+    }
+    if (i0 >= ll.x() && i0 + side <= ur.x() && j0 >= ll.y() &&
+        j0 + side <= ur.y()) {
+      for (size_t code = base; code < base + side * side; ++code) {
+        f(compact(code >> 1), compact(code), code);
+      } /* for(code..) */
+      return;
+    }
+    /* i is the more significant bit of each pair */
+    size_t half = side / 2;
+    size_t quad = half * half;
+    visit(ll, ur, i0, j0, half, base, f);
+    visit(ll, ur, i0, j0 + half, half, base + quad, f);
+    visit(ll, ur, i0 + half, j0, half, base + 2 * quad, f);
+    visit(ll, ur, i0 + half, j0 + half, half, base + 3 * quad, f);
+  }
+
+  /**
+   * \brief Spread the lower 32 bits of \p v out so that there is a 0 bit
+   * between each of them.
+   */
+  static size_t spread(size_t v) {
+    uint64_t x = v & 0x00000000FFFFFFFFULL;
+    x = (x | (x << 16)) & 0x0000FFFF0000FFFFULL;
+    x = (x | (x << 8)) & 0x00FF00FF00FF00FFULL;
+    x = (x | (x << 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    x = (x | (x << 2)) & 0x3333333333333333ULL;
+    x = (x | (x << 1)) & 0x5555555555555555ULL;
+    return x;
+  }
+
+  /**
+   * \brief Inverse of \ref spread(): gather the even bits of \p v.
+   */
+  static size_t compact(size_t v) {
+    uint64_t x = v & 0x5555555555555555ULL;
+    x = (x | (x >> 1)) & 0x3333333333333333ULL;
+    x = (x | (x >> 2)) & 0x0F0F0F0F0F0F0F0FULL;
+    x = (x | (x >> 4)) & 0x00FF00FF00FF00FFULL;
+    x = (x | (x >> 8)) & 0x0000FFFF0000FFFFULL;
+    x = (x | (x >> 16)) & 0x00000000FFFFFFFFULL;
+    return x;
+  }
+
+  /* clang-format off */
+  const size_t mc_side;
+  /* clang-format on */
+};
+
+NS_END(grid2D_layout, ds, rcppsw);
+
+#endif /* INCLUDE_RCPPSW_DS_GRID2D_LAYOUT_HPP_ */
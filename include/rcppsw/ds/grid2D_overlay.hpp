@@ -85,6 +85,7 @@ class grid2D_overlay final : public base_grid2D<T>,
       : grid_overlay(origin, grid_res, field_res),
         ER_CLIENT_INIT("rcppsw.ds.grid2D_overlay"),
         mc_dim(dims),
+        mc_dimd(math::dvec2zvec(mc_dim, resolution().v())),
         m_cells(boost::extents[static_cast<typename index_range::index>(xdsize())]
                               [typename index_range::index(ydsize())]) {
     RCPPSW_UNUSED double remx = std::remainder(mc_dim.x(), resolution().v());
@@ -116,13 +117,8 @@ class grid2D_overlay final : public base_grid2D<T>,
                   [static_cast<typename index_range::index>(j)];
   }
 
-  size_t xdsize(void) const override {
-    return static_cast<size_t>(mc_dim.x() / resolution().v());
-  }
-
-  size_t ydsize(void) const override {
-    return static_cast<size_t>(mc_dim.y() / resolution().v());
-  }
+  size_t xdsize(void) const override { return mc_dimd.x(); }
+  size_t ydsize(void) const override { return mc_dimd.y(); }
 
   /**
    * \brief Get the size of the X dimension (non-discretized).
@@ -143,9 +139,7 @@ class grid2D_overlay final : public base_grid2D<T>,
   /**
    * \brief Get the discrete dimensions of the grid.
    */
-  math::vector2z dimsd(void) const {
-    return math::dvec2zvec(mc_dim, resolution().v());
-  }
+  const math::vector2z& dimsd(void) const { return mc_dimd; }
 
  private:
   grid_type& grid(void) override { return m_cells; }
@@ -153,6 +147,7 @@ class grid2D_overlay final : public base_grid2D<T>,
 
   /* clang-format off */
   const math::vector2d          mc_dim;
+  const math::vector2z          mc_dimd;
 
   grid_type                     m_cells;
   /* clang-format on */
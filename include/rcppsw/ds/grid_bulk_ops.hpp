@@ -0,0 +1,164 @@
+/**
+ * \file grid_bulk_ops.hpp
+ *
+ * \copyright 2020 John Harwell, All rights reserved.
+ *
+ * This file is part of RCPPSW.
+ *
+ * RCPPSW is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * RCPPSW is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * RCPPSW.  If not, see <http://www.gnu.org/licenses/
+ */
+
+#ifndef INCLUDE_RCPPSW_DS_GRID_BULK_OPS_HPP_
+#define INCLUDE_RCPPSW_DS_GRID_BULK_OPS_HPP_
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <algorithm>
+#include <memory>
+
+#include "rcppsw/rcppsw.hpp"
+
+/*******************************************************************************
+ * Namespaces/Decls
+ ******************************************************************************/
+NS_START(rcppsw, ds, grid_bulk_ops);
+
+/*******************************************************************************
+ * Free Functions
+ ******************************************************************************/
+/*
+ * These operate on a contiguous buffer of n_rows x row_len cells, and are the
+ * kernels behind the bulk operations provided by the grid classes. Rows are
+ * distributed across threads with OpenMP (if the library is built with it),
+ * and the loops over the cells within a row are simple enough for the
+ * compiler to vectorize.
+ */
+
+/**
+ * \brief Set every cell to \p value.
+ */
+template <typename T>
+void fill(T* const data,
+          size_t n_rows,
+          size_t row_len,
+          const T& value,
+          RCPPSW_UNUSED size_t n_threads) {
+#pragma omp parallel for num_threads(n_threads)
+  for (size_t r = 0; r < n_rows; ++r) {
+    T* const row = data + r * row_len;
+#pragma omp simd
+    for (size_t c = 0; c < row_len; ++c) {
+      row[c] = value;
+    } /* for(c..) */
+  } /* for(r..) */
+}
+
+/**
+ * \brief Replace every cell with \p f(cell).
+ */
+template <typename T, typename TFunc>
+void transform(T* const data,
+               size_t n_rows,
+               size_t row_len,
+               const TFunc& f,
+               RCPPSW_UNUSED size_t n_threads) {
+#pragma omp parallel for num_threads(n_threads)
+  for (size_t r = 0; r < n_rows; ++r) {
+    T* const row = data + r * row_len;
+    for (size_t c = 0; c < row_len; ++c) {
+      row[c] = f(row[c]);
+    } /* for(c..) */
+  } /* for(r..) */
+}
+
+/**
+ * \brief Multiply every cell by \p factor in place.
+ */
+template <typename T, typename TFactor>
+void decay(T* const data,
+           size_t n_rows,
+           size_t row_len,
+           const TFactor& factor,
+           RCPPSW_UNUSED size_t n_threads) {
+#pragma omp parallel for num_threads(n_threads)
+  for (size_t r = 0; r < n_rows; ++r) {
+    T* const row = data + r * row_len;
+#pragma omp simd
+    for (size_t c = 0; c < row_len; ++c) {
+      row[c] *= factor;
+    } /* for(c..) */
+  } /* for(r..) */
+}
+
+/**
+ * \brief Call \p f(r, c, cell) for every cell, where r is the row index and c
+ * is the index of the cell within the row.
+ */
+template <typename T, typename TFunc>
+void for_each(T* const data,
+              size_t n_rows,
+              size_t row_len,
+              const TFunc& f,
+              RCPPSW_UNUSED size_t n_threads) {
+#pragma omp parallel for num_threads(n_threads)
+  for (size_t r = 0; r < n_rows; ++r) {
+    T* const row = data + r * row_len;
+    for (size_t c = 0; c < row_len; ++c) {
+      f(r, c, row[c]);
+    } /* for(c..) */
+  } /* for(r..) */
+}
+
+/**
+ * \brief Reduce all cells with \p op, starting from \p init. Each thread
+ * reduces a contiguous block of rows starting from \p init, and the per-thread
+ * results are then combined in order, so \p op must be associative, and \p
+ * init must be its identity if \p n_threads > 1. \p T must be default
+ * constructible.
+ */
+template <typename T, typename TOp>
+T reduce(const T* const data,
+         size_t n_rows,
+         size_t row_len,
+         const T& init,
+         const TOp& op,
+         size_t n_threads) {
+  size_t n_blocks = std::max<size_t>(1, std::min(n_threads, n_rows));
+  size_t block_rows = (n_rows + n_blocks - 1) / n_blocks;
+  /* not std::vector, so that T=bool partials can be written concurrently */
+  auto partials = std::make_unique<T[]>(n_blocks);
+
+#pragma omp parallel for num_threads(n_blocks)
+  for (size_t b = 0; b < n_blocks; ++b) {
+    T accum = init;
+    size_t end = std::min(n_rows, (b + 1) * block_rows);
+    for (size_t r = b * block_rows; r < end; ++r) {
+      const T* const row = data + r * row_len;
+      for (size_t c = 0; c < row_len; ++c) {
+        accum = op(accum, row[c]);
+      } /* for(c..) */
+    } /* for(r..) */
+    partials[b] = accum;
+  } /* for(b..) */
+
+  T result = partials[0];
+  for (size_t b = 1; b < n_blocks; ++b) {
+    result = op(result, partials[b]);
+  } /* for(b..) */
+  return result;
+}
+
+NS_END(grid_bulk_ops, ds, rcppsw);
+
+#endif /* INCLUDE_RCPPSW_DS_GRID_BULK_OPS_HPP_ */
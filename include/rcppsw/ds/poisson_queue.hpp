@@ -25,7 +25,12 @@
  * Includes
  ******************************************************************************/
 #include <boost/optional.hpp>
+#include <algorithm>
+#include <array>
 #include <deque>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
 
 #include "rcsw/common/fpc.h"
 
@@ -47,10 +52,27 @@ NS_START(rcppsw, ds);
  *
  * \brief A wrapper around std::queue to make it more amenable to queueing
  * theoretic analysis by tracking queue state.
+ *
+ * Instead of polling each queue every timestep with \ref enqueue_check() and
+ * \ref dequeue_check(), the times of the next events can be registered with a
+ * \ref timer_wheel via \ref next_enqueue_time() and \ref next_dequeue_time().
+ *
+ * Exponential inter-arrival times are sampled from the \ref math::rng in
+ * batches of \ref kSampleBatchSize, rather than one at a time.
+ *
+ * \tparam T The type of the queued items.
+ * \tparam kIndexed If \c TRUE, a hashed count of the items in the queue is
+ *                  maintained alongside it so that \ref contains() is O(1)
+ *                  instead of O(N). Requires std::hash<T>.
  */
-template <typename T>
+template <typename T, bool kIndexed = false>
 class poisson_queue {
  public:
+  /**
+   * \brief # of inter-arrival times sampled at once.
+   */
+  static constexpr size_t kSampleBatchSize = 64;
+
   /**
    * \brief Metadata for tracking enqueue_queue/dequeue operations.
    */
@@ -110,13 +132,7 @@ class poisson_queue {
    */
   bool enqueue_check(const types::timestep& t) {
     RCSW_FPC_NV(false, mc_lambda > 0.0);
-    if (!m_enqueue.op_set) {
-      double val = m_rng->exponential(mc_lambda);
-
-      m_enqueue.next_op_time = m_enqueue.last_op_time + static_cast<uint>(val);
-      m_enqueue.op_set = true;
-    }
-    return t >= m_enqueue.next_op_time;
+    return t >= next_op_time(&m_enqueue, mc_lambda);
   }
 
   /**
@@ -128,12 +144,30 @@ class poisson_queue {
    */
   bool dequeue_check(const types::timestep& t) {
     RCSW_FPC_NV(false, mc_mu > 0.0);
-    if (!m_dequeue.op_set) {
-      double val = m_rng->exponential(mc_mu);
-      m_dequeue.next_op_time = m_dequeue.last_op_time + static_cast<uint>(val);
-      m_dequeue.op_set = true;
-    }
-    return t >= m_dequeue.next_op_time;
+    return t >= next_op_time(&m_dequeue, mc_mu);
+  }
+
+  /**
+   * \brief Get the time of the next enqueue event, for registering it with a
+   * \ref timer_wheel instead of calling \ref enqueue_check() every
+   * timestep. The time is fixed until the next \ref enqueue(), so it should be
+   * re-registered after each one.
+   *
+   * \return The time of the next enqueue event, or boost::none if the enqueue
+   * rate is 0.
+   */
+  boost::optional<types::timestep> next_enqueue_time(void) {
+    RCSW_FPC_NV(boost::none, mc_lambda > 0.0);
+    return boost::make_optional(next_op_time(&m_enqueue, mc_lambda));
+  }
+
+  /**
+   * \brief Get the time of the next dequeue event; see \ref
+   * next_enqueue_time().
+   */
+  boost::optional<types::timestep> next_dequeue_time(void) {
+    RCSW_FPC_NV(boost::none, mc_mu > 0.0);
+    return boost::make_optional(next_op_time(&m_dequeue, mc_mu));
   }
 
   /**
@@ -153,6 +187,9 @@ class poisson_queue {
     m_enqueue.last_op_time = t;
     m_enqueue.op_set = false;
     m_queue.push_back(item);
+    if constexpr (kIndexed) {
+      ++m_index[item];
+    }
   }
 
   /**
@@ -182,6 +219,12 @@ class poisson_queue {
     }
     auto val = m_queue.front();
     m_queue.pop_front();
+    if constexpr (kIndexed) {
+      auto it = m_index.find(val);
+      if (0 == --it->second) {
+        m_index.erase(it);
+      }
+    }
     return boost::make_optional(val);
   }
 
@@ -194,12 +237,18 @@ class poisson_queue {
   }
 
   /**
-   * \brief Determine if \p key is currently contained in the queue.
+   * \brief Determine if \p key is currently contained in the queue. O(1) if
+   * the queue is indexed, O(N) otherwise.
    */
   bool contains(const T& key) const {
-    return m_queue.end() != std::find_if(m_queue.begin(),
-                                         m_queue.end(),
-                                         [&](const auto& a) { return a == key; });
+    if constexpr (kIndexed) {
+      return m_index.end() != m_index.find(key);
+    } else {
+      return m_queue.end() !=
+             std::find_if(m_queue.begin(), m_queue.end(), [&](const auto& a) {
+               return a == key;
+             });
+    }
   }
 
  private:
@@ -208,8 +257,40 @@ class poisson_queue {
     bool op_set{ false };
     types::timestep last_op_time{ 0 };
     types::timestep next_op_time{ 0 };
+    std::array<double, kSampleBatchSize> samples{};
+    size_t next_sample{ kSampleBatchSize };
   };
 
+  using index_type =
+      typename std::conditional<kIndexed,
+                                std::unordered_map<T, size_t>,
+                                std::tuple<>>::type;
+
+  /**
+   * \brief Get the next exponential sample with rate \p rate for \p op,
+   * refilling its batch of samples from the RNG if needed.
+   */
+  double next_sample(op_data* op, double rate) {
+    if (kSampleBatchSize == op->next_sample) {
+      m_rng->exponential(rate, op->samples.data(), kSampleBatchSize);
+      op->next_sample = 0;
+    }
+    return op->samples[op->next_sample++];
+  }
+
+  /**
+   * \brief Get the time of the next event for \p op, sampling it if it has not
+   * been sampled since the last operation.
+   */
+  const types::timestep& next_op_time(op_data* op, double rate) {
+    if (!op->op_set) {
+      double val = next_sample(op, rate);
+      op->next_op_time = op->last_op_time + static_cast<uint>(val);
+      op->op_set = true;
+    }
+    return op->next_op_time;
+  }
+
   /* clang-format off */
   const double    mc_lambda;
   const double    mc_mu;
@@ -218,6 +299,7 @@ class poisson_queue {
   struct op_data  m_enqueue{};
   struct op_data  m_dequeue{};
   std::deque<T>   m_queue{};
+  index_type      m_index{};
   /* clang-format on */
 
  public:
@@ -225,6 +307,33 @@ class poisson_queue {
   RCPPSW_WRAP_DECLDEF(size, m_queue);
 };
 
+/*******************************************************************************
+ * Free Functions
+ ******************************************************************************/
+/**
+ * \brief Advance a collection of queues to time \p t: for each queue, call \p
+ * on_enqueue(queue) if an enqueue event has been triggered, and then \p
+ * on_dequeue(queue) if a dequeue event has been triggered. The callbacks are
+ * responsible for performing the actual \ref poisson_queue::enqueue() and
+ * \ref poisson_queue::dequeue() operations (or not).
+ *
+ * \param queues A range of pointers (raw or smart) to queues.
+ */
+template <typename TQueuePtrRange, typename TEnqueueFunc, typename TDequeueFunc>
+void poisson_queue_advance(const TQueuePtrRange& queues,
+                           const types::timestep& t,
+                           const TEnqueueFunc& on_enqueue,
+                           const TDequeueFunc& on_dequeue) {
+  for (auto& q : queues) {
+    if (q->enqueue_check(t)) {
+      on_enqueue(*q);
+    }
+    if (q->dequeue_check(t)) {
+      on_dequeue(*q);
+    }
+  } /* for(&q..) */
+}
+
 NS_END(ds, rcppsw);
 
 #endif /* INCLUDE_RCPPSW_DS_POISSON_QUEUE_HPP_ */
@@ -27,9 +27,13 @@
 #include <algorithm>
 #include <boost/geometry.hpp>
 #include <boost/geometry/index/rtree.hpp>
+#include <boost/iterator/function_output_iterator.hpp>
+#include <functional>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "rcppsw/er/client.hpp"
 #include "rcppsw/math/vector2.hpp"
 #include "rcppsw/rcppsw.hpp"
 
@@ -54,14 +58,32 @@ namespace bgi = bg::index;
  * applications in which large trees are built, queried frequently and updated
  * relatively infrequently.
  *
+ * Each key can appear in the tree at most once. A side index from each key to
+ * its rectangle is maintained so that lookups, removals and updates by key do
+ * not need to scan the tree.
+ *
+ * Trees holding static geometry should be built in one go by the bulk loading
+ * constructor or \ref rebuild(), which use boost's packing algorithm and are
+ * both faster and produce a better tree than repeated insertion, and then
+ * frozen with \ref freeze(). A frozen tree cannot be modified, and so can be
+ * queried from any number of threads without locking. Attempting to modify a
+ * frozen tree is reported, and the modification is refused (the member
+ * function returns \ref ERROR) regardless of the error reporting level the
+ * library is built with, since it would be a data race otherwise.
+ *
  * \tparam TCoord The type of the coordinate used to define the corners and 2D
  * shapes contained in the tree.
  *
  * \tparam TKey The type of the class/object/etc which has a representation
  * projectable onto the 2D plane, which are returned by queries.
+ *
+ * \tparam THash Hash function for \p TKey, for the side index.
  */
-template <typename TCoord, typename TKey, size_t MAXELTS>
-class rtree2D {
+template <typename TCoord,
+          typename TKey,
+          size_t MAXELTS,
+          typename THash = std::hash<TKey>>
+class rtree2D : public er::client<rtree2D<TCoord, TKey, MAXELTS, THash>> {
  public:
   /**
    * \brief Type of the points used to represent the rectangles managed by the tree.
@@ -83,7 +105,18 @@ class rtree2D {
    */
   using tree_type = bgi::rtree<value_type, bgi::rstar<MAXELTS>>;
 
-  rtree2D(void) = default;
+  rtree2D(void) : ER_CLIENT_INIT("rcppsw.ds.rtree2D") {}
+
+  /**
+   * \brief Bulk load the tree from a range of (rectangle, key) pairs with
+   * unique keys. Duplicate keys fail an ER_ASSERT, and leave the tree empty.
+   */
+  template <typename TValueRange>
+  explicit rtree2D(const TValueRange& values)
+      : ER_CLIENT_INIT("rcppsw.ds.rtree2D") {
+    status_t ret = rebuild(values);
+    ER_ASSERT(OK == ret, "Duplicate keys in bulk load");
+  }
 
   /* Not move/copy constructable/assignable by default */
   rtree2D(const rtree2D&) = delete;
@@ -97,67 +130,301 @@ class rtree2D {
    */
   std::vector<TKey> query(const math::vector2<TCoord>& ll,
                           const math::vector2<TCoord>& ur) const {
-    std::vector<value_type> res1;
-    res1.reserve(MAXELTS); /* good a guess as any */
-    box_type query(point_type(ll.x(), ll.y()), point_type(ur.x(), ur.y()));
-    m_impl.query(bgi::intersects(query), std::back_inserter(res1));
+    std::vector<TKey> res;
+    query(ll, ur, std::back_inserter(res));
+    return res;
+  }
+
+  /**
+   * \brief Write the keys of all objects intersecting the rectangle defined by
+   * \p ll, \p ur to \p out. Does not allocate (other than what \p out does).
+   *
+   * \return The output iterator after the last key written.
+   */
+  template <typename TOutputIter>
+  TOutputIter query(const math::vector2<TCoord>& ll,
+                    const math::vector2<TCoord>& ur,
+                    TOutputIter out) const {
+    visit(ll, ur, [&](const TKey& key) { *out++ = key; });
+    return out;
+  }
+
+  /**
+   * \brief Call \p f(key) for each object intersecting the rectangle defined by
+   * \p ll, \p ur. Does not allocate.
+   */
+  template <typename TFunc>
+  void visit(const math::vector2<TCoord>& ll,
+             const math::vector2<TCoord>& ur,
+             const TFunc& f) const {
+    m_impl.query(bgi::intersects(make_box(ll, ur)), key_visitor(f));
+  }
+
+  /**
+   * \brief Call \p f(key) for each object whose rectangle is within \p radius
+   * of \p center. Does not allocate.
+   */
+  template <typename TFunc>
+  void visit_radius(const math::vector2<TCoord>& center,
+                    const TCoord& radius,
+                    const TFunc& f) const {
+    point_type pt(center.x(), center.y());
 
-    std::vector<TKey> res2;
-    res2.reserve(res1.size());
-    std::transform(res1.begin(),
-                   res1.end(),
-                   std::back_inserter(res2),
-                   [res2](const auto& pair) { return pair.second; });
-    return res2;
+    /* comparable distance for cartesian points is the squared distance */
+    auto r2 = radius * radius;
+    auto within = [&](const value_type& v) {
+      return bg::comparable_distance(pt, v.first) <= r2;
+    };
+    math::vector2<TCoord> offset(radius, radius);
+    m_impl.query(bgi::intersects(make_box(center - offset, center + offset)) &&
+                     bgi::satisfies(within),
+                 key_visitor(f));
   }
 
   /**
-   * \brief Query the tree to see if \p key is found in the tree. This query
-   * does not take advantage of tree properties, and is O(N).
+   * \brief Write the keys of all objects whose rectangle is within \p radius of
+   * \p center to \p out.
+   *
+   * \return The output iterator after the last key written.
    */
-  bool query(const TKey& key) const {
-    auto it =
-        std::find_if(m_impl.begin(), m_impl.end(), [key](const value_type& pair) {
-          return key == pair.second;
-        });
-    return m_impl.end() != it;
+  template <typename TOutputIter>
+  TOutputIter query_radius(const math::vector2<TCoord>& center,
+                           const TCoord& radius,
+                           TOutputIter out) const {
+    visit_radius(center, radius, [&](const TKey& key) { *out++ = key; });
+    return out;
+  }
+
+  /**
+   * \brief Write the keys of the (up to) \p k objects whose rectangles are
+   * nearest to \p pt to \p out, nearest first. boost uses an internal
+   * buffer of size \p k for this, so it is not allocation free.
+   *
+   * \return The output iterator after the last key written.
+   */
+  template <typename TOutputIter>
+  TOutputIter nearest(const math::vector2<TCoord>& pt,
+                      size_t k,
+                      TOutputIter out) const {
+    /* query iterators return nearest neighbors in order; query() does not */
+    auto it = m_impl.qbegin(bgi::nearest(point_type(pt.x(), pt.y()), k));
+    for (; it != m_impl.qend(); ++it) {
+      *out++ = it->second;
+    } /* for(it..) */
+    return out;
+  }
+
+  /**
+   * \brief Answer a batch of rectangle queries in one call. \p boxes is a range
+   * of (ll, ur) pairs, and \p f(i, key) is called for each object intersecting
+   * the i-th rectangle.
+   */
+  template <typename TBoxRange, typename TFunc>
+  void visit_batch(const TBoxRange& boxes, const TFunc& f) const {
+    size_t i = 0;
+    for (auto& box : boxes) {
+      visit(box.first, box.second, [&](const TKey& key) { f(i, key); });
+      ++i;
+    } /* for(&box..) */
+  }
+
+  /**
+   * \brief Query the tree to see if \p key is found in the tree. O(1).
+   */
+  bool query(const TKey& key) const { return contains(key); }
+
+  /**
+   * \brief Determine if \p key is in the tree. O(1).
+   */
+  bool contains(const TKey& key) const {
+    return m_index.end() != m_index.find(key);
   }
 
   /**
    * \brief Insert the \p key into the tree, which will be placed into the tree
-   * according to its rectangle defined by \p ll, \p ur.
+   * according to its rectangle defined by \p ll, \p ur. If \p key is already in
+   * the tree, this is the same as \ref update().
+   *
+   * \return \ref ERROR if the tree is frozen, \ref OK otherwise.
    */
-  void insert(const TKey& key,
-              const math::vector2<TCoord>& ll,
-              const math::vector2<TCoord>& ur) {
-    box_type value(point_type(ll.x(), ll.y()), point_type(ur.x(), ur.y()));
-    m_impl.insert(std::make_pair(value, key));
+  status_t insert(const TKey& key,
+                  const math::vector2<TCoord>& ll,
+                  const math::vector2<TCoord>& ur) {
+    return insert(std::make_pair(make_box(ll, ur), key));
   }
 
   /**
-   * \brief Remove the \p key and its associated rectangle from the tree.
+   * \brief Insert a (rectangle, key) pair into the tree. If the key is already
+   * in the tree, its rectangle is updated.
    *
-   * \return The # of items removed (0 or 1).
+   * \return \ref ERROR if the tree is frozen, \ref OK otherwise.
+   */
+  status_t insert(const value_type& value) {
+    if (!check_mutable()) {
+      return ERROR;
+    }
+    auto it = m_index.find(value.second);
+    if (m_index.end() != it) {
+      move(it, value.first);
+      return OK;
+    }
+    m_impl.insert(value);
+    m_index.emplace(value.second, value.first);
+    return OK;
+  }
+
+  /**
+   * \brief Remove the \p key and its associated rectangle from the tree. O(log
+   * N).
+   *
+   * \return The # of items removed (0 or 1; always 0 if the tree is frozen).
    */
   size_t remove(const TKey& key) {
-    std::vector<value_type> victims;
-    std::copy_if(m_impl.begin(),
-                 m_impl.end(),
-                 std::back_inserter(victims),
-                 [key](const value_type& pair) { return key == pair.second; });
-    if (victims.empty()) {
+    if (!check_mutable()) {
+      return 0;
+    }
+    auto it = m_index.find(key);
+    if (m_index.end() == it) {
       return 0;
     }
-    return m_impl.remove(victims.begin(), victims.end());
+    size_t n = m_impl.remove(std::make_pair(it->second, key));
+    m_index.erase(it);
+    return n;
   }
 
+  /**
+   * \brief Move \p key to the rectangle defined by \p ll, \p ur, inserting it
+   * if it is not in the tree. If the rectangle is unchanged this is a no-op,
+   * which is the common case for objects which are not moving. O(log N).
+   *
+   * \return \ref ERROR if the tree is frozen, \ref OK otherwise.
+   */
+  status_t update(const TKey& key,
+                  const math::vector2<TCoord>& ll,
+                  const math::vector2<TCoord>& ur) {
+    if (!check_mutable()) {
+      return ERROR;
+    }
+    auto it = m_index.find(key);
+    if (m_index.end() == it) {
+      return insert(key, ll, ur);
+    }
+    move(it, make_box(ll, ur));
+    return OK;
+  }
+
+  /**
+   * \brief Remove everything from the tree.
+   *
+   * \return \ref ERROR if the tree is frozen, \ref OK otherwise.
+   */
+  status_t clear(void) {
+    if (!check_mutable()) {
+      return ERROR;
+    }
+    m_impl.clear();
+    m_index.clear();
+    return OK;
+  }
+
+  /**
+   * \brief Replace the contents of the tree by bulk loading a range of
+   * (rectangle, key) pairs with unique keys.
+   *
+   * \return \ref ERROR if the tree is frozen or the keys are not unique, in
+   * which case the tree is unchanged; \ref OK otherwise.
+   */
+  template <typename TValueRange>
+  status_t rebuild(const TValueRange& values) {
+    if (!check_mutable()) {
+      return ERROR;
+    }
+    tree_type impl(std::begin(values), std::end(values));
+    index_type index;
+    if (!make_index(impl, &index)) {
+      return ERROR;
+    }
+    m_impl = std::move(impl);
+    m_index = std::move(index);
+    return OK;
+  }
+
+  /**
+   * \brief Make the tree read-only. After this, only const member functions
+   * may be called, and they are safe to call concurrently from multiple threads
+   * without locking.
+   */
+  void freeze(void) { m_frozen = true; }
+
+  bool frozen(void) const { return m_frozen; }
+
  private:
+  using index_type = std::unordered_map<TKey, box_type, THash>;
+
+  static box_type make_box(const math::vector2<TCoord>& ll,
+                           const math::vector2<TCoord>& ur) {
+    return box_type(point_type(ll.x(), ll.y()), point_type(ur.x(), ur.y()));
+  }
+
+  /**
+   * \brief Adapt a callback on keys to an output iterator over tree values
+   * which boost can write query results to.
+   */
+  template <typename TFunc>
+  static auto key_visitor(const TFunc& f) {
+    return boost::make_function_output_iterator(
+        [&f](const value_type& v) { f(v.second); });
+  }
+
+  /**
+   * \brief Build the side index for \p impl in \p index.
+   *
+   * \return \c FALSE if the keys in \p impl are not unique.
+   */
+  bool make_index(const tree_type& impl, index_type* index) const {
+    index->reserve(impl.size());
+    for (auto& value : impl) {
+      index->emplace(value.second, value.first);
+    } /* for(&value..) */
+    ER_CHECK(index->size() == impl.size(),
+             "Duplicate keys in bulk load: %zu values, %zu keys",
+             impl.size(),
+             index->size());
+    return true;
+
+  error:
+    return false;
+  }
+
+  /**
+   * \brief Report an attempt to modify a frozen tree.
+   *
+   * \return \c FALSE if the tree is frozen.
+   */
+  bool check_mutable(void) const {
+    ER_CHECK(!m_frozen, "Cannot modify frozen tree");
+    return true;
+
+  error:
+    return false;
+  }
+
+  void move(typename index_type::iterator it, const box_type& box) {
+    if (bg::equals(it->second, box)) {
+      return;
+    }
+    m_impl.remove(std::make_pair(it->second, it->first));
+    m_impl.insert(std::make_pair(box, it->first));
+    it->second = box;
+  }
+
   /* clang-format off */
-  tree_type m_impl{};
+  tree_type  m_impl{};
+  index_type m_index{};
+  bool       m_frozen{false};
   /* clang-format on */
 
  public:
-  RCPPSW_WRAP_DECLDEF(insert, m_impl);
   RCPPSW_WRAP_DECLDEF(begin, m_impl, const);
   RCPPSW_WRAP_DECLDEF(end, m_impl, const);
   RCPPSW_WRAP_DECLDEF(size, m_impl, const);
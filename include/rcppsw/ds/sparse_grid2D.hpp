@@ -0,0 +1,197 @@
+/**
+ * \file sparse_grid2D.hpp
+ *
+ * \copyright 2020 John Harwell, All rights reserved.
+ *
+ * This file is part of RCPPSW.
+ *
+ * RCPPSW is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * RCPPSW is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * RCPPSW.  If not, see <http://www.gnu.org/licenses/
+ */
+
+#ifndef INCLUDE_RCPPSW_DS_SPARSE_GRID2D_HPP_
+#define INCLUDE_RCPPSW_DS_SPARSE_GRID2D_HPP_
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <algorithm>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+
+#include "rcppsw/math/vector2.hpp"
+#include "rcppsw/rcppsw.hpp"
+
+/*******************************************************************************
+ * Namespaces/Decls
+ ******************************************************************************/
+NS_START(rcppsw, ds);
+
+/*******************************************************************************
+ * Class Definitions
+ ******************************************************************************/
+/**
+ * \class sparse_grid2D
+ * \ingroup ds
+ *
+ * \brief A 2D grid of SOMETHING for very large, mostly empty spaces. The grid
+ * is divided into square chunks of \p ChunkDim x \p ChunkDim cells, which are
+ * only allocated the first time a cell within them is written to. Cells in
+ * unallocated chunks have a configurable default value.
+ *
+ * Has the same cell access interface as \ref base_grid2D, but does not derive
+ * from it, as \ref base_grid2D requires a dense boost::multi_array for its
+ * subgrid views.
+ *
+ * Any non-const access to a cell counts as a write and allocates its chunk, so
+ * read through a const reference when you are only reading.
+ *
+ * \tparam T The type of the grid element. Must be default constructible and
+ *           copy assignable (same as boost::multi_array).
+ * \tparam ChunkDim The size of a chunk side.
+ */
+template <typename T, size_t ChunkDim = 16>
+class sparse_grid2D {
+ public:
+  using value_type = T;
+  using chunk_type = std::unique_ptr<T[]>;
+
+  static constexpr size_t kChunkSize = ChunkDim * ChunkDim;
+
+  explicit sparse_grid2D(const math::vector2z& dims,
+                         const T& default_value = T())
+      : sparse_grid2D(dims.x(), dims.y(), default_value) {}
+
+  sparse_grid2D(size_t x_max, size_t y_max, const T& default_value = T())
+      : mc_xdsize(x_max),
+        mc_ydsize(y_max),
+        mc_ychunks((y_max + ChunkDim - 1) / ChunkDim),
+        mc_default(default_value) {}
+
+  /**
+   * \brief Get a reference to the cell at (i, j), allocating the chunk it
+   * lives in if necessary.
+   */
+  T& access(size_t i, size_t j) {
+    auto it = m_chunks.find(chunk_key(i, j));
+    if (m_chunks.end() == it) {
+      auto chunk = std::make_unique<T[]>(kChunkSize);
+      std::fill(chunk.get(), chunk.get() + kChunkSize, mc_default);
+      it = m_chunks.emplace(chunk_key(i, j), std::move(chunk)).first;
+    }
+    return it->second[chunk_offset(i, j)];
+  }
+
+  /**
+   * \brief Get a reference to the cell at (i, j), which is the default value if
+   * its chunk has not been allocated. Never allocates.
+   */
+  const T& access(size_t i, size_t j) const {
+    auto it = m_chunks.find(chunk_key(i, j));
+    if (m_chunks.end() == it) {
+      return mc_default;
+    }
+    return it->second[chunk_offset(i, j)];
+  }
+
+  T& access(const math::vector2z& c) { return access(c.x(), c.y()); }
+  const T& access(const math::vector2z& c) const {
+    return access(c.x(), c.y());
+  }
+
+  T& operator[](const math::vector2z& c) { return access(c); }
+  const T& operator[](const math::vector2z& c) const { return access(c); }
+
+  bool contains(size_t i, size_t j) const {
+    return i < xdsize() && j < ydsize();
+  }
+  bool contains(const math::vector2z& pt) const {
+    return contains(pt.x(), pt.y());
+  }
+
+  size_t xdsize(void) const { return mc_xdsize; }
+  size_t ydsize(void) const { return mc_ydsize; }
+
+  /**
+   * \brief Determine if the chunk containing cell (i, j) has been allocated.
+   */
+  bool allocated(size_t i, size_t j) const {
+    return m_chunks.end() != m_chunks.find(chunk_key(i, j));
+  }
+
+  const T& default_value(void) const { return mc_default; }
+
+  /**
+   * \brief The # of chunks which are currently allocated.
+   */
+  size_t n_chunks(void) const { return m_chunks.size(); }
+
+  /**
+   * \brief The # of cells in allocated chunks (including the ones which still
+   * have the default value).
+   */
+  size_t resident_cells(void) const { return n_chunks() * kChunkSize; }
+
+  /**
+   * \brief Approximate # of bytes used by allocated chunks, for capacity
+   * planning. Does not include heap memory owned by the cells themselves.
+   */
+  size_t resident_bytes(void) const { return resident_cells() * sizeof(T); }
+
+  /**
+   * \brief Free all chunks in which every cell is equal to the default
+   * value. Requires \p T to be equality comparable.
+   *
+   * \return The # of chunks freed.
+   */
+  size_t shrink(void) {
+    size_t count = 0;
+    for (auto it = m_chunks.begin(); it != m_chunks.end();) {
+      if (std::all_of(it->second.get(),
+                      it->second.get() + kChunkSize,
+                      [&](const T& cell) { return cell == mc_default; })) {
+        it = m_chunks.erase(it);
+        ++count;
+      } else {
+        ++it;
+      }
+    } /* for(it..) */
+    return count;
+  }
+
+  /**
+   * \brief Free all chunks, resetting all cells to the default value.
+   */
+  void clear(void) { m_chunks.clear(); }
+
+ private:
+  size_t chunk_key(size_t i, size_t j) const {
+    return (i / ChunkDim) * mc_ychunks + (j / ChunkDim);
+  }
+  static size_t chunk_offset(size_t i, size_t j) {
+    return (i % ChunkDim) * ChunkDim + (j % ChunkDim);
+  }
+
+  /* clang-format off */
+  const size_t                          mc_xdsize;
+  const size_t                          mc_ydsize;
+  const size_t                          mc_ychunks;
+  const T                               mc_default;
+
+  std::unordered_map<size_t, chunk_type> m_chunks{};
+  /* clang-format on */
+};
+
+NS_END(ds, rcppsw);
+
+#endif /* INCLUDE_RCPPSW_DS_SPARSE_GRID2D_HPP_ */
@@ -0,0 +1,208 @@
+/**
+ * \file sparse_grid3D.hpp
+ *
+ * \copyright 2020 John Harwell, All rights reserved.
+ *
+ * This file is part of RCPPSW.
+ *
+ * RCPPSW is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * RCPPSW is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * RCPPSW.  If not, see <http://www.gnu.org/licenses/
+ */
+
+#ifndef INCLUDE_RCPPSW_DS_SPARSE_GRID3D_HPP_
+#define INCLUDE_RCPPSW_DS_SPARSE_GRID3D_HPP_
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <algorithm>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+
+#include "rcppsw/math/vector3.hpp"
+#include "rcppsw/rcppsw.hpp"
+
+/*******************************************************************************
+ * Namespaces/Decls
+ ******************************************************************************/
+NS_START(rcppsw, ds);
+
+/*******************************************************************************
+ * Class Definitions
+ ******************************************************************************/
+/**
+ * \class sparse_grid3D
+ * \ingroup ds
+ *
+ * \brief A 3D grid of SOMETHING for very large, mostly empty spaces. The grid
+ * is divided into cubic chunks of \p ChunkDim^3 cells, which are
+ * only allocated the first time a cell within them is written to. Cells in
+ * unallocated chunks have a configurable default value.
+ *
+ * Has the same cell access interface as \ref base_grid3D, but does not derive
+ * from it, as \ref base_grid3D requires a dense boost::multi_array for its
+ * subgrid views.
+ *
+ * Any non-const access to a cell counts as a write and allocates its chunk, so
+ * read through a const reference when you are only reading.
+ *
+ * \tparam T The type of the grid element. Must be default constructible and
+ *           copy assignable (same as boost::multi_array).
+ * \tparam ChunkDim The size of a chunk side.
+ */
+template <typename T, size_t ChunkDim = 8>
+class sparse_grid3D {
+ public:
+  using value_type = T;
+  using chunk_type = std::unique_ptr<T[]>;
+
+  static constexpr size_t kChunkSize = ChunkDim * ChunkDim * ChunkDim;
+
+  explicit sparse_grid3D(const math::vector3z& dims,
+                         const T& default_value = T())
+      : sparse_grid3D(dims.x(), dims.y(), dims.z(), default_value) {}
+
+  sparse_grid3D(size_t x_max,
+                size_t y_max,
+                size_t z_max,
+                const T& default_value = T())
+      : mc_xdsize(x_max),
+        mc_ydsize(y_max),
+        mc_zdsize(z_max),
+        mc_ychunks((y_max + ChunkDim - 1) / ChunkDim),
+        mc_zchunks((z_max + ChunkDim - 1) / ChunkDim),
+        mc_default(default_value) {}
+
+  /**
+   * \brief Get a reference to the cell at (i, j, k), allocating the chunk
+   * it lives in if necessary.
+   */
+  T& access(size_t i, size_t j, size_t k) {
+    auto it = m_chunks.find(chunk_key(i, j, k));
+    if (m_chunks.end() == it) {
+      auto chunk = std::make_unique<T[]>(kChunkSize);
+      std::fill(chunk.get(), chunk.get() + kChunkSize, mc_default);
+      it = m_chunks.emplace(chunk_key(i, j, k), std::move(chunk)).first;
+    }
+    return it->second[chunk_offset(i, j, k)];
+  }
+
+  /**
+   * \brief Get a reference to the cell at (i, j, k), which is the default
+   * value if its chunk has not been allocated. Never allocates.
+   */
+  const T& access(size_t i, size_t j, size_t k) const {
+    auto it = m_chunks.find(chunk_key(i, j, k));
+    if (m_chunks.end() == it) {
+      return mc_default;
+    }
+    return it->second[chunk_offset(i, j, k)];
+  }
+
+  T& access(const math::vector3z& c) { return access(c.x(), c.y(), c.z()); }
+  const T& access(const math::vector3z& c) const {
+    return access(c.x(), c.y(), c.z());
+  }
+
+  T& operator[](const math::vector3z& c) { return access(c); }
+  const T& operator[](const math::vector3z& c) const { return access(c); }
+
+  bool contains(size_t i, size_t j, size_t k) const {
+    return i < xdsize() && j < ydsize() && k < zdsize();
+  }
+  bool contains(const math::vector3z& pt) const {
+    return contains(pt.x(), pt.y(), pt.z());
+  }
+
+  size_t xdsize(void) const { return mc_xdsize; }
+  size_t ydsize(void) const { return mc_ydsize; }
+  size_t zdsize(void) const { return mc_zdsize; }
+
+  /**
+   * \brief Determine if the chunk containing cell (i, j, k) has been
+   * allocated.
+   */
+  bool allocated(size_t i, size_t j, size_t k) const {
+    return m_chunks.end() != m_chunks.find(chunk_key(i, j, k));
+  }
+
+  const T& default_value(void) const { return mc_default; }
+
+  /**
+   * \brief The # of chunks which are currently allocated.
+   */
+  size_t n_chunks(void) const { return m_chunks.size(); }
+
+  /**
+   * \brief The # of cells in allocated chunks (including the ones which still
+   * have the default value).
+   */
+  size_t resident_cells(void) const { return n_chunks() * kChunkSize; }
+
+  /**
+   * \brief Approximate # of bytes used by allocated chunks, for capacity
+   * planning. Does not include heap memory owned by the cells themselves.
+   */
+  size_t resident_bytes(void) const { return resident_cells() * sizeof(T); }
+
+  /**
+   * \brief Free all chunks in which every cell is equal to the default
+   * value. Requires \p T to be equality comparable.
+   *
+   * \return The # of chunks freed.
+   */
+  size_t shrink(void) {
+    size_t count = 0;
+    for (auto it = m_chunks.begin(); it != m_chunks.end();) {
+      if (std::all_of(it->second.get(),
+                      it->second.get() + kChunkSize,
+                      [&](const T& cell) { return cell == mc_default; })) {
+        it = m_chunks.erase(it);
+        ++count;
+      } else {
+        ++it;
+      }
+    } /* for(it..) */
+    return count;
+  }
+
+  /**
+   * \brief Free all chunks, resetting all cells to the default value.
+   */
+  void clear(void) { m_chunks.clear(); }
+
+ private:
+  size_t chunk_key(size_t i, size_t j, size_t k) const {
+    return ((i / ChunkDim) * mc_ychunks + (j / ChunkDim)) * mc_zchunks +
+           (k / ChunkDim);
+  }
+  static size_t chunk_offset(size_t i, size_t j, size_t k) {
+    return ((i % ChunkDim) * ChunkDim + (j % ChunkDim)) * ChunkDim +
+           (k % ChunkDim);
+  }
+
+  /* clang-format off */
+  const size_t                          mc_xdsize;
+  const size_t                          mc_ydsize;
+  const size_t                          mc_zdsize;
+  const size_t                          mc_ychunks;
+  const size_t                          mc_zchunks;
+  const T                               mc_default;
+
+  std::unordered_map<size_t, chunk_type> m_chunks{};
+  /* clang-format on */
+};
+
+NS_END(ds, rcppsw);
+
+#endif /* INCLUDE_RCPPSW_DS_SPARSE_GRID3D_HPP_ */
@@ -0,0 +1,386 @@
+/**
+ * \file spatial_hash2D.hpp
+ *
+ * \copyright 2020 John Harwell, All rights reserved.
+ *
+ * This file is part of RCPPSW.
+ *
+ * RCPPSW is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * RCPPSW is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * RCPPSW.  If not, see <http://www.gnu.org/licenses/
+ */
+
+#ifndef INCLUDE_RCPPSW_DS_SPATIAL_HASH2D_HPP_
+#define INCLUDE_RCPPSW_DS_SPATIAL_HASH2D_HPP_
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "rcppsw/math/vector2.hpp"
+#include "rcppsw/rcppsw.hpp"
+#include "rcppsw/types/discretize_ratio.hpp"
+
+/*******************************************************************************
+ * Namespaces/Decls
+ ******************************************************************************/
+NS_START(rcppsw, ds);
+
+/*******************************************************************************
+ * Class Definitions
+ ******************************************************************************/
+/**
+ * \class spatial_hash2D
+ * \ingroup ds
+ *
+ * \brief A uniform grid of square buckets over unbounded 2D space, with the
+ * same insert/remove/update/query interface as \ref rtree2D. Intended for large
+ * numbers of small (ideally point sized) moving objects, for which it is much
+ * cheaper to maintain than an R-tree: each object lives in the buckets its
+ * rectangle overlaps, so moving an object is O(1) (and if it stays within the
+ * same buckets, just an update of its rectangle).
+ *
+ * The bucket size should be on the order of the typical query radius; a
+ * radius query touches (2r / size + 1)^2 buckets.
+ *
+ * Buckets are never freed when they become empty, so that objects moving back
+ * and forth across bucket boundaries do not cause repeated allocations. Call
+ * \ref shrink() to free them.
+ *
+ * \tparam TKey The type of the objects stored in the hash, which are returned
+ *              by queries. Each key can appear at most once.
+ *
+ * \tparam THash Hash function for \p TKey.
+ */
+template <typename TKey, typename THash = std::hash<TKey>>
+class spatial_hash2D {
+ public:
+  /**
+   * \param cell_size The side length of a bucket in real space.
+   */
+  explicit spatial_hash2D(const types::discretize_ratio& cell_size)
+      : mc_cell_size(cell_size) {}
+
+  /* Not move/copy constructable/assignable by default */
+  spatial_hash2D(const spatial_hash2D&) = delete;
+  const spatial_hash2D& operator=(const spatial_hash2D&) = delete;
+  spatial_hash2D(spatial_hash2D&&) = delete;
+  spatial_hash2D& operator=(spatial_hash2D&&) = delete;
+
+  const types::discretize_ratio& cell_size(void) const { return mc_cell_size; }
+
+  /**
+   * \brief Get the # of objects in the hash.
+   */
+  size_t size(void) const { return m_index.size(); }
+
+  /**
+   * \brief Get the # of allocated buckets (including empty ones).
+   */
+  size_t n_buckets(void) const { return m_buckets.size(); }
+
+  /**
+   * \brief Determine if \p key is in the hash. O(1).
+   */
+  bool contains(const TKey& key) const {
+    return m_index.end() != m_index.find(key);
+  }
+  bool query(const TKey& key) const { return contains(key); }
+
+  /**
+   * \brief Insert \p key with the rectangle defined by \p ll, \p ur. If \p key
+   * is already present, this is the same as \ref update().
+   */
+  void insert(const TKey& key,
+              const math::vector2d& ll,
+              const math::vector2d& ur) {
+    update(key, ll, ur);
+  }
+
+  /**
+   * \brief Move \p key to the rectangle defined by \p ll, \p ur, inserting it
+   * if it is not present. O(1) for objects which only overlap a few buckets.
+   */
+  void update(const TKey& key,
+              const math::vector2d& ll,
+              const math::vector2d& ur) {
+    box b{ ll, ur };
+    cell_range cells = to_cells(ll, ur);
+    auto it = m_index.find(key);
+    if (m_index.end() == it) {
+      m_index.emplace(key, entry{ b, cells });
+      bucket_add(cells, key, b);
+      return;
+    }
+    if (it->second.cells == cells) {
+      it->second.bounds = b;
+      for_each_cell(cells, [&](uint64_t cell) {
+        bucket_find(m_buckets[cell], key)->bounds = b;
+      });
+    } else {
+      bucket_remove(it->second.cells, key);
+      bucket_add(cells, key, b);
+      it->second = entry{ b, cells };
+    }
+  }
+
+  /**
+   * \brief Remove \p key from the hash.
+   *
+   * \return The # of items removed (0 or 1).
+   */
+  size_t remove(const TKey& key) {
+    auto it = m_index.find(key);
+    if (m_index.end() == it) {
+      return 0;
+    }
+    bucket_remove(it->second.cells, key);
+    m_index.erase(it);
+    return 1;
+  }
+
+  /**
+   * \brief Remove all objects from the hash (buckets are kept).
+   */
+  void clear(void) {
+    for (auto& pair : m_buckets) {
+      pair.second.clear();
+    } /* for(&pair..) */
+    m_index.clear();
+  }
+
+  /**
+   * \brief Free all empty buckets.
+   *
+   * \return The # of buckets freed.
+   */
+  size_t shrink(void) {
+    size_t count = 0;
+    for (auto it = m_buckets.begin(); it != m_buckets.end();) {
+      if (it->second.empty()) {
+        it = m_buckets.erase(it);
+        ++count;
+      } else {
+        ++it;
+      }
+    } /* for(it..) */
+    return count;
+  }
+
+  /**
+   * \brief Get the keys of all objects intersecting the rectangle defined by
+   * \p ll, \p ur.
+   */
+  std::vector<TKey> query(const math::vector2d& ll,
+                          const math::vector2d& ur) const {
+    std::vector<TKey> res;
+    query(ll, ur, std::back_inserter(res));
+    return res;
+  }
+
+  /**
+   * \brief Write the keys of all objects intersecting the rectangle defined by
+   * \p ll, \p ur to \p out.
+   *
+   * \return The output iterator after the last key written.
+   */
+  template <typename TOutputIter>
+  TOutputIter query(const math::vector2d& ll,
+                    const math::vector2d& ur,
+                    TOutputIter out) const {
+    visit(ll, ur, [&](const TKey& key) { *out++ = key; });
+    return out;
+  }
+
+  /**
+   * \brief Call \p f(key) once for each object intersecting the rectangle
+   * defined by \p ll, \p ur. Does not allocate.
+   */
+  template <typename TFunc>
+  void visit(const math::vector2d& ll,
+             const math::vector2d& ur,
+             const TFunc& f) const {
+    box q{ ll, ur };
+    visit_candidates(to_cells(ll, ur), [&](const bucket_entry& e) {
+      if (intersects(e.bounds, q)) {
+        f(e.key);
+      }
+    });
+  }
+
+  /**
+   * \brief Call \p f(key) once for each object whose rectangle is within \p
+   * radius of \p center. Does not allocate.
+   */
+  template <typename TFunc>
+  void visit_radius(const math::vector2d& center,
+                    double radius,
+                    const TFunc& f) const {
+    math::vector2d offset(radius, radius);
+    double r2 = radius * radius;
+    visit_candidates(to_cells(center - offset, center + offset),
+                     [&](const bucket_entry& e) {
+                       if (sq_dist(center, e.bounds) <= r2) {
+                         f(e.key);
+                       }
+                     });
+  }
+
+  /**
+   * \brief Write the keys of all objects whose rectangle is within \p radius of
+   * \p center to \p out.
+   *
+   * \return The output iterator after the last key written.
+   */
+  template <typename TOutputIter>
+  TOutputIter query_radius(const math::vector2d& center,
+                           double radius,
+                           TOutputIter out) const {
+    visit_radius(center, radius, [&](const TKey& key) { *out++ = key; });
+    return out;
+  }
+
+ private:
+  struct box {
+    math::vector2d ll;
+    math::vector2d ur;
+  };
+
+  /**
+   * \brief Inclusive range of bucket indices a rectangle overlaps.
+   */
+  struct cell_range {
+    int64_t ilo;
+    int64_t jlo;
+    int64_t ihi;
+    int64_t jhi;
+
+    bool operator==(const cell_range& other) const {
+      return ilo == other.ilo && jlo == other.jlo && ihi == other.ihi &&
+             jhi == other.jhi;
+    }
+  };
+
+  struct entry {
+    box bounds;
+    cell_range cells;
+  };
+
+  /**
+   * \brief Objects in a bucket are stored with their rectangle, so that
+   * queries do not need to go through the index.
+   */
+  struct bucket_entry {
+    TKey key;
+    box bounds;
+    cell_range cells;
+  };
+
+  using bucket_type = std::vector<bucket_entry>;
+
+  int64_t to_cell(double coord) const {
+    return static_cast<int64_t>(std::floor(coord / mc_cell_size.v()));
+  }
+
+  cell_range to_cells(const math::vector2d& ll, const math::vector2d& ur) const {
+    return { to_cell(ll.x()), to_cell(ll.y()), to_cell(ur.x()), to_cell(ur.y()) };
+  }
+
+  static uint64_t cell_key(int64_t i, int64_t j) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(i)) << 32) |
+           static_cast<uint32_t>(j);
+  }
+
+  template <typename TFunc>
+  static void for_each_cell(const cell_range& cells, const TFunc& f) {
+    for (int64_t i = cells.ilo; i <= cells.ihi; ++i) {
+      for (int64_t j = cells.jlo; j <= cells.jhi; ++j) {
+        f(cell_key(i, j));
+      } /* for(j..) */
+    } /* for(i..) */
+  }
+
+  /**
+   * \brief Call \p f(entry) for each object in the buckets in \p query, exactly
+   * once per object: objects spanning several buckets are only visited from
+   * the lowest bucket they share with the query.
+   */
+  template <typename TFunc>
+  void visit_candidates(const cell_range& query, const TFunc& f) const {
+    for (int64_t i = query.ilo; i <= query.ihi; ++i) {
+      for (int64_t j = query.jlo; j <= query.jhi; ++j) {
+        auto it = m_buckets.find(cell_key(i, j));
+        if (m_buckets.end() == it) {
+          continue;
+        }
+        for (auto& e : it->second) {
+          if (std::max(e.cells.ilo, query.ilo) == i &&
+              std::max(e.cells.jlo, query.jlo) == j) {
+            f(e);
+          }
+        } /* for(&e..) */
+      } /* for(j..) */
+    } /* for(i..) */
+  }
+
+  void bucket_add(const cell_range& cells, const TKey& key, const box& b) {
+    for_each_cell(cells, [&](uint64_t cell) {
+      m_buckets[cell].push_back(bucket_entry{ key, b, cells });
+    });
+  }
+
+  void bucket_remove(const cell_range& cells, const TKey& key) {
+    for_each_cell(cells, [&](uint64_t cell) {
+      auto& bucket = m_buckets[cell];
+      auto it = bucket_find(bucket, key);
+      if (it != bucket.end() - 1) {
+        *it = std::move(bucket.back());
+      }
+      bucket.pop_back();
+    });
+  }
+
+  static typename bucket_type::iterator bucket_find(bucket_type& bucket,
+                                                    const TKey& key) {
+    return std::find_if(bucket.begin(), bucket.end(), [&](const auto& e) {
+      return key == e.key;
+    });
+  }
+
+  static bool intersects(const box& a, const box& b) {
+    return a.ll.x() <= b.ur.x() && b.ll.x() <= a.ur.x() &&
+           a.ll.y() <= b.ur.y() && b.ll.y() <= a.ur.y();
+  }
+
+  static double sq_dist(const math::vector2d& pt, const box& b) {
+    double dx = std::max({ b.ll.x() - pt.x(), 0.0, pt.x() - b.ur.x() });
+    double dy = std::max({ b.ll.y() - pt.y(), 0.0, pt.y() - b.ur.y() });
+    return dx * dx + dy * dy;
+  }
+
+  /* clang-format off */
+  const types::discretize_ratio                mc_cell_size;
+
+  std::unordered_map<uint64_t, bucket_type>    m_buckets{};
+  std::unordered_map<TKey, entry, THash>       m_index{};
+  /* clang-format on */
+};
+
+NS_END(ds, rcppsw);
+
+#endif /* INCLUDE_RCPPSW_DS_SPATIAL_HASH2D_HPP_ */
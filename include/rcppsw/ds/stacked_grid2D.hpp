@@ -24,10 +24,12 @@
 /*******************************************************************************
  * Includes
  ******************************************************************************/
+#include <memory>
 #include <tuple>
+#include <type_traits>
 #include <utility>
-#include <vector>
 
+#include "rcppsw/ds/flat_grid2D_overlay.hpp"
 #include "rcppsw/ds/grid2D_overlay.hpp"
 #include "rcppsw/math/vector2.hpp"
 #include "rcppsw/types/discretize_ratio.hpp"
@@ -37,6 +39,44 @@
  ******************************************************************************/
 NS_START(rcppsw, ds);
 
+NS_START(stacked_grid2D_layout);
+
+/**
+ * \brief Each layer is stored as a separate \ref grid2D_overlay, so all
+ * objects in a given layer are contiguous (Structure of Arrays). Best when
+ * most accesses touch a single layer at a time.
+ */
+struct layer_major {};
+
+/**
+ * \brief The objects from all layers for a given cell are stored together,
+ * and all cells are stored in a single \ref flat_grid2D_overlay (Array of
+ * Structures). Best when most accesses touch several layers of the same cell.
+ */
+struct cell_major {};
+
+NS_END(stacked_grid2D_layout);
+
+NS_START(detail);
+
+template <typename TupleTypes>
+struct stacked_grid2D_storage;
+
+template <typename... Ts>
+struct stacked_grid2D_storage<std::tuple<Ts...>> {
+  using layer_major_type = std::tuple<std::unique_ptr<grid2D_overlay<Ts>>...>;
+  using cell_major_type = flat_grid2D_overlay<std::tuple<Ts...>>;
+  using refs_type = std::tuple<Ts&...>;
+  using const_refs_type = std::tuple<const Ts&...>;
+
+  template <typename... Args>
+  static layer_major_type make_layers(const Args&... args) {
+    return layer_major_type(std::make_unique<grid2D_overlay<Ts>>(args...)...);
+  }
+};
+
+NS_END(detail);
+
 /*******************************************************************************
  * Class Definitions
  ******************************************************************************/
@@ -45,19 +85,54 @@ NS_START(rcppsw, ds);
  * \ingroup ds
  *
  * \brief A sandwich of N 2D grids of the same size (x,y) dimensions, which can
- * contain different kinds of objects. The objects in each layer of the grid are
- * stored contiguously, but the grids themselves are not necessarily
- * contiguous. The layers are 0 indexed.
+ * contain different kinds of objects. The layers are 0 indexed.
  *
  * This was implemented because the BGL only appears to support layered
  * graphs/grids of the same object type. Although in hindsight I could have done
  * this with grid_graph and boost::variant (was not aware of this when I
  * implemented this class). Might not have been as highly performing in that
  * case though.
+ *
+ * \tparam TupleTypes A std::tuple of the types of the objects in each layer.
+ *
+ * \tparam TLayout How the layers are laid out in memory; one of
+ *                 \ref stacked_grid2D_layout::layer_major (the default) or
+ *                 \ref stacked_grid2D_layout::cell_major.
  */
-template <typename TupleTypes>
+template <typename TupleTypes,
+          typename TLayout = stacked_grid2D_layout::layer_major>
 class stacked_grid2D {
  public:
+  static_assert(std::is_same<TLayout, stacked_grid2D_layout::layer_major>::value ||
+                    std::is_same<TLayout, stacked_grid2D_layout::cell_major>::value,
+                "Bad layout: not layer major or cell major");
+
+  /**
+   * \brief The type of the objects stored in a particular layer.
+   * \tparam Index The index of the layer.
+   */
+  template <size_t Index>
+  using value_type = typename std::tuple_element<Index, TupleTypes>::type;
+
+  /**
+   * \brief The type of a particular layer (only meaningful for the layer major
+   * layout).
+   * \tparam Index The index of the layer.
+   */
+  template <size_t Index>
+  using layer_value_type = rcppsw::ds::grid2D_overlay<value_type<Index>>;
+
+  /**
+   * \brief A tuple of references to the objects in all layers for a single
+   * cell.
+   */
+  using refs_type = typename detail::stacked_grid2D_storage<TupleTypes>::refs_type;
+  using const_refs_type =
+      typename detail::stacked_grid2D_storage<TupleTypes>::const_refs_type;
+
+  static constexpr bool kCellMajor =
+      std::is_same<TLayout, stacked_grid2D_layout::cell_major>::value;
+
   /**
    * \param origin The anchor point of the stacked grid in continuous space.
    * \param dims The real size in X,Y which will be discretized into
@@ -71,25 +146,13 @@ class stacked_grid2D {
                  const math::vector2d& dims,
                  const types::discretize_ratio& grid_res,
                  const types::discretize_ratio& field_res)
-      : m_layers(kStackSize) {
-    add_layers<kStackSize - 1>(origin, dims, grid_res, field_res);
-  }
+      : m_storage(storage_init(origin, dims, grid_res, field_res)) {}
 
-  virtual ~stacked_grid2D(void) { rm_layers<kStackSize - 1>(); }
-
-  /**
-   * \brief The type of the objects stored in a particular layer.
-   * \tparam Index The index of the layer.
-   */
-  template <size_t Index>
-  using value_type = typename std::tuple_element<Index, TupleTypes>::type;
+  virtual ~stacked_grid2D(void) = default;
 
-  /**
-   * \brief The type of a particular layer.
-   * \tparam Index The index of the layer.
-   */
-  template <size_t Index>
-  using layer_value_type = rcppsw::ds::grid2D_overlay<value_type<Index>>;
+  /* Not copy constructable/assignable by default */
+  stacked_grid2D(const stacked_grid2D&) = delete;
+  const stacked_grid2D& operator=(const stacked_grid2D&) = delete;
 
   /**
    * \brief Get a reference to an object at a particular (layer,i,j) location
@@ -99,16 +162,21 @@ class stacked_grid2D {
    * \param j The y coordinate.
    */
   template <size_t Index>
-  typename layer_value_type<Index>::value_type& access(size_t i, size_t j) {
-    return reinterpret_cast<layer_value_type<Index>*>(m_layers[Index])
-        ->access(i, j);
+  value_type<Index>& access(size_t i, size_t j) {
+    if constexpr (kCellMajor) {
+      return std::get<Index>(m_storage.access(i, j));
+    } else {
+      return std::get<Index>(m_storage)->access(i, j);
+    }
   }
 
   template <size_t Index>
-  const typename layer_value_type<Index>::value_type& access(size_t i,
-                                                             size_t j) const {
-    return reinterpret_cast<const layer_value_type<Index>*>(m_layers[Index])
-        ->access(i, j);
+  const value_type<Index>& access(size_t i, size_t j) const {
+    if constexpr (kCellMajor) {
+      return std::get<Index>(m_storage.access(i, j));
+    } else {
+      return std::get<Index>(m_storage)->access(i, j);
+    }
   }
 
   /**
@@ -118,123 +186,118 @@ class stacked_grid2D {
    * \param d The discrete coordinate pair.
    */
   template <size_t Index>
-  typename layer_value_type<Index>::value_type& access(const math::vector2z& d) {
+  value_type<Index>& access(const math::vector2z& d) {
     return access<Index>(d.x(), d.y());
   }
   template <size_t Index>
-  const typename layer_value_type<Index>::value_type&
-  access(const math::vector2z& d) const {
+  const value_type<Index>& access(const math::vector2z& d) const {
     return access<Index>(d.x(), d.y());
   }
 
+  /**
+   * \brief Get references to the objects in ALL layers at a particular (i,j)
+   * location. With the cell major layout this touches a single contiguous
+   * chunk of memory.
+   */
+  refs_type access_all(size_t i, size_t j) {
+    return access_all_impl<refs_type>(
+        *this, i, j, std::make_index_sequence<kStackSize>());
+  }
+  const_refs_type access_all(size_t i, size_t j) const {
+    return access_all_impl<const_refs_type>(
+        *this, i, j, std::make_index_sequence<kStackSize>());
+  }
+  refs_type access_all(const math::vector2z& d) {
+    return access_all(d.x(), d.y());
+  }
+  const_refs_type access_all(const math::vector2z& d) const {
+    return access_all(d.x(), d.y());
+  }
+
+  /**
+   * \brief Get a particular layer. Only available with the layer major
+   * layout.
+   */
   template <size_t Index>
   layer_value_type<Index>* layer(void) {
-    return reinterpret_cast<layer_value_type<Index>*>(m_layers[Index]);
+    static_assert(!kCellMajor, "Layers are not separate in cell major layout");
+    return std::get<Index>(m_storage).get();
   }
   template <size_t Index>
   const layer_value_type<Index>* layer(void) const {
-    return reinterpret_cast<const layer_value_type<Index>*>(m_layers[Index]);
+    static_assert(!kCellMajor, "Layers are not separate in cell major layout");
+    return std::get<Index>(m_storage).get();
   }
 
   /**
    * \see \ref grid2D_overlay::xdsize().
    */
-  size_t xdsize(void) const {
-    return (reinterpret_cast<const layer_value_type<0>*>(m_layers[0]))->xdsize();
-  }
+  size_t xdsize(void) const { return reference_grid().xdsize(); }
 
   /**
    * \see \ref grid2D_overlay::xrsize().
    */
-  double xrsize(void) const {
-    return (reinterpret_cast<const layer_value_type<0>*>(m_layers[0]))->xrsize();
-  }
+  double xrsize(void) const { return reference_grid().xrsize(); }
 
   /**
    * \see \ref grid2D_overlay::ydsize().
    */
-  size_t ydsize(void) const {
-    return (reinterpret_cast<const layer_value_type<0>*>(m_layers[0]))->ydsize();
-  }
+  size_t ydsize(void) const { return reference_grid().ydsize(); }
 
   /**
    * \see \ref grid2D_overlay::yrsize().
    */
-  double yrsize(void) const {
-    return (reinterpret_cast<const layer_value_type<0>*>(m_layers[0]))->yrsize();
-  }
+  double yrsize(void) const { return reference_grid().yrsize(); }
 
   /**
    * \see \ref grid2D_overlay::resolution().
    */
   const types::discretize_ratio& resolution(void) const {
-    return (reinterpret_cast<const layer_value_type<0>*>(m_layers[0]))
-        ->resolution();
+    return reference_grid().resolution();
   }
 
  private:
-  static size_t constexpr kStackSize = std::tuple_size<TupleTypes>::value;
-
-  /**
-   * \brief Add layers when you have at least 2 layers to add. SFINAE is needed
-   * to prevent negative indices in the degenerate case where the stacked grid
-   * only has 1 layer.
-   */
-  template <size_t Index, RCPPSW_SFINAE_DECLDEF((Index > 0)), typename... Args>
-  void add_layers(Args&&... args) {
-    add_layer<Index, Args...>(std::forward<Args>(args)...);
-    add_layer<Index - 1, Args...>(std::forward<Args>(args)...);
-  }
-
-  /**
-   * \brief Add layers when you only have 1 layer to add. SFINAE is needed to
-   * prevent negative indices in the degenerate case where the stacked grid only
-   * has 1 layer.
-   */
-  template <size_t Index, RCPPSW_SFINAE_DECLDEF((Index == 0)), typename... Args>
-  void add_layers(Args&&... args) {
-    add_layer<Index, Args...>(std::forward<Args>(args)...);
-  }
+  using storage_traits = detail::stacked_grid2D_storage<TupleTypes>;
+  using storage_type =
+      typename std::conditional<kCellMajor,
+                                typename storage_traits::cell_major_type,
+                                typename storage_traits::layer_major_type>::type;
 
-  /**
-   * \brief Add a layer to the stacked grid.
-   *
-   * Note the reversal of indices! Because of the way recursive instantiation
-   * works, we can only start at an index > 0, and go DOWN, but the user
-   * specified the order of layers going FORWARD/UP.
-   */
-  template <size_t Index, typename... Args>
-  void add_layer(Args&&... args) {
-    m_layers[kStackSize - Index - 1] =
-        new layer_value_type<kStackSize - Index - 1>(std::forward<Args>(args)...);
-  }
+  static size_t constexpr kStackSize = std::tuple_size<TupleTypes>::value;
 
-  template <size_t Index>
-  void rm_layers(void) {
-    rm_layer<Index>();
+  static storage_type storage_init(const math::vector2d& origin,
+                                   const math::vector2d& dims,
+                                   const types::discretize_ratio& grid_res,
+                                   const types::discretize_ratio& field_res) {
+    if constexpr (kCellMajor) {
+      return storage_type(origin, dims, grid_res, field_res);
+    } else {
+      return storage_traits::make_layers(origin, dims, grid_res, field_res);
+    }
   }
 
-  /**
-   * \brief Delete a layer from the stacked grid when there are at least 2
-   * layers. Indice reversal is not really necessary here, but doing it for
-   * reasons of Principle of Least Surprise.
-   */
-  template <size_t Index, RCPPSW_SFINAE_DECLDEF((Index > 0))>
-  void rm_layer(void) {
-    delete reinterpret_cast<const layer_value_type<Index>*>(
-        m_layers[kStackSize - Index - 1]);
+  template <typename TRefs, typename TSelf, size_t... Indices>
+  static TRefs access_all_impl(TSelf& self,
+                               size_t i,
+                               size_t j,
+                               std::index_sequence<Indices...>) {
+    return TRefs(self.template access<Indices>(i, j)...);
   }
 
   /**
-   * \brief Remove a layer from the stacked grid when you only have 1 layer.
+   * \brief Get the grid that the dimensions/resolution of the stacked grid
+   * are taken from.
    */
-  template <size_t Index, RCPPSW_SFINAE_DECLDEF((Index == 0))>
-  void rm_layer(void) {
-    delete reinterpret_cast<const layer_value_type<0>*>(m_layers[0]);
+  const auto& reference_grid(void) const {
+    if constexpr (kCellMajor) {
+      return m_storage;
+    } else {
+      return *std::get<0>(m_storage);
+    }
   }
 
   /* clang-format off */
-  std::vector<void*> m_layers;
+  storage_type m_storage;
   /* clang-format on */
 };
 
@@ -0,0 +1,321 @@
+/**
+ * \file timer_wheel.hpp
+ *
+ * \copyright 2020 John Harwell, All rights reserved.
+ *
+ * This file is part of RCPPSW.
+ *
+ * RCPPSW is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * RCPPSW is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * RCPPSW.  If not, see <http://www.gnu.org/licenses/
+ */
+
+#ifndef INCLUDE_RCPPSW_DS_TIMER_WHEEL_HPP_
+#define INCLUDE_RCPPSW_DS_TIMER_WHEEL_HPP_
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "rcppsw/rcppsw.hpp"
+#include "rcppsw/types/timestep.hpp"
+
+/*******************************************************************************
+ * Namespaces/Decls
+ ******************************************************************************/
+NS_START(rcppsw, ds);
+
+/*******************************************************************************
+ * Class Definitions
+ ******************************************************************************/
+/**
+ * \class timer_wheel
+ * \ingroup ds
+ *
+ * \brief Hierarchical timer wheel for scheduling events at future timesteps,
+ * so that instead of polling every pending event every timestep ("is it time
+ * yet?"), a single call to \ref advance() each timestep hands back exactly the
+ * events which are due.
+ *
+ * Each level has 64 slots; level 0 slots are 1 timestep wide, level 1 slots
+ * are 64 timesteps wide, and so on. Events are placed in the lowest level
+ * whose span contains them, and are moved down a level ("cascaded") when the
+ * current time reaches their slot. Events further in the future than the top
+ * level can represent are kept in an overflow list which is re-examined each
+ * time the top level wraps.
+ *
+ * - \ref schedule() and \ref cancel() are O(1).
+ * - \ref advance() is O(# timesteps advanced + # events due), plus the
+ *   amortized cost of cascading.
+ *
+ * Events are stored in a slab with a free list, so after warm up scheduling
+ * does not allocate.
+ *
+ * \tparam T The event payload. Must be default constructible and movable.
+ * \tparam kLevels The # of levels in the wheel. With the default of 4, events
+ *                 up to 64^4 (~16.7 million) timesteps in the future do not go
+ *                 to the overflow list.
+ */
+template <typename T, size_t kLevels = 4>
+class timer_wheel {
+ public:
+  static_assert(kLevels > 0 && 6 * kLevels < 64, "Bad # of wheel levels");
+
+  /**
+   * \brief Handle to a scheduled event, for cancelling it. Handles to events
+   * which have fired or been cancelled are detected and ignored.
+   */
+  struct timer_id {
+    uint32_t idx;
+    uint32_t gen;
+  };
+
+  /**
+   * \param start The current timestep. Events at or before this time are due
+   * on the next call to \ref advance().
+   */
+  explicit timer_wheel(const types::timestep& start = types::timestep(0))
+      : m_now(start.v()) {
+    m_heads.fill(kNil);
+  }
+
+  /* Not move/copy constructable/assignable by default */
+  timer_wheel(const timer_wheel&) = delete;
+  const timer_wheel& operator=(const timer_wheel&) = delete;
+  timer_wheel(timer_wheel&&) = delete;
+  timer_wheel& operator=(timer_wheel&&) = delete;
+
+  /**
+   * \brief Get the current time of the wheel (i.e., the last timestep passed to
+   * \ref advance()).
+   */
+  types::timestep now(void) const { return types::timestep(m_now); }
+
+  /**
+   * \brief Get the # of events currently scheduled.
+   */
+  size_t size(void) const { return m_size; }
+  bool empty(void) const { return 0 == m_size; }
+
+  /**
+   * \brief Schedule \p payload to fire at \p at. If \p at is not in the future,
+   * it fires on the next call to \ref advance().
+   */
+  timer_id schedule(const types::timestep& at, T payload) {
+    uint32_t idx;
+    if (kNil != m_free) {
+      idx = m_free;
+      m_free = m_nodes[idx].next;
+    } else {
+      idx = static_cast<uint32_t>(m_nodes.size());
+      m_nodes.emplace_back();
+    }
+    auto& n = m_nodes[idx];
+    n.at = at.v();
+    n.payload = std::move(payload);
+    n.live = true;
+    place(idx);
+    ++m_size;
+    return { idx, n.gen };
+  }
+
+  /**
+   * \brief Cancel a scheduled event.
+   *
+   * \return \c TRUE if the event was cancelled, \c FALSE if it had already
+   * fired or been cancelled.
+   */
+  bool cancel(const timer_id& id) {
+    if (id.idx >= m_nodes.size() || m_nodes[id.idx].gen != id.gen ||
+        !m_nodes[id.idx].live) {
+      return false;
+    }
+    unlink(id.idx);
+    release(id.idx);
+    return true;
+  }
+
+  /**
+   * \brief Advance the wheel to \p t, calling \p f(payload) for each event due
+   * at or before \p t, in order of their scheduled times (events due at the
+   * same timestep fire in no particular order, as do events which were
+   * scheduled in the past). \p f may schedule and cancel events; events it
+   * schedules at or before \p t also fire during this call.
+   *
+   * \return The # of events fired.
+   */
+  template <typename TFunc>
+  size_t advance(const types::timestep& t, const TFunc& f) {
+    size_t count = fire_list(kExpiredList, f);
+    while (m_now < t.v()) {
+      ++m_now;
+      cascade();
+      count += fire_list(slot_list(0, m_now & kSlotMask), f);
+      count += fire_list(kExpiredList, f);
+    } /* while() */
+    return count;
+  }
+
+  /**
+   * \brief Remove all scheduled events.
+   */
+  void clear(void) {
+    for (size_t l = 0; l < kNumLists; ++l) {
+      while (kNil != m_heads[l]) {
+        uint32_t idx = m_heads[l];
+        unlink(idx);
+        release(idx);
+      } /* while() */
+    } /* for(l..) */
+  }
+
+ private:
+  static constexpr size_t kSlotBits = 6;
+  static constexpr size_t kSlots = 1 << kSlotBits;
+  static constexpr size_t kSlotMask = kSlots - 1;
+  static constexpr uint32_t kNil = std::numeric_limits<uint32_t>::max();
+
+  /*
+   * Lists 0 - kLevels * kSlots - 1 are the wheel slots; the last two are for
+   * events beyond the top level and events which are already due.
+   */
+  static constexpr size_t kOverflowList = kLevels * kSlots;
+  static constexpr size_t kExpiredList = kOverflowList + 1;
+  static constexpr size_t kNumLists = kExpiredList + 1;
+
+  struct node {
+    size_t at{ 0 };
+    T payload{};
+    uint32_t prev{ kNil };
+    uint32_t next{ kNil };
+    uint32_t list{ 0 };
+    uint32_t gen{ 0 };
+    bool live{ false };
+  };
+
+  static size_t slot_list(size_t level, size_t slot) {
+    return level * kSlots + slot;
+  }
+
+  /**
+   * \brief Put an event in the list for its time relative to the current time.
+   */
+  void place(uint32_t idx) {
+    size_t at = m_nodes[idx].at;
+    if (at <= m_now) {
+      link(idx, kExpiredList);
+      return;
+    }
+    for (size_t l = 0; l < kLevels; ++l) {
+      size_t shift = kSlotBits * (l + 1);
+      if ((at >> shift) == (m_now >> shift)) {
+        link(idx, slot_list(l, (at >> (kSlotBits * l)) & kSlotMask));
+        return;
+      }
+    } /* for(l..) */
+    link(idx, kOverflowList);
+  }
+
+  /**
+   * \brief When the current time crosses slot boundaries of the upper levels,
+   * redistribute the events in the slots which have just become current into
+   * the levels below, highest level first.
+   */
+  void cascade(void) {
+    size_t top = 0;
+    while (top < kLevels &&
+           0 == (m_now & ((size_t(1) << (kSlotBits * (top + 1))) - 1))) {
+      ++top;
+    } /* while() */
+
+    if (kLevels == top) {
+      replace_list(kOverflowList);
+    }
+    for (size_t l = std::min(top, kLevels - 1); l > 0; --l) {
+      replace_list(slot_list(l, (m_now >> (kSlotBits * l)) & kSlotMask));
+    } /* for(l..) */
+  }
+
+  void replace_list(size_t list) {
+    uint32_t idx = m_heads[list];
+    m_heads[list] = kNil;
+    while (kNil != idx) {
+      uint32_t next = m_nodes[idx].next;
+      place(idx);
+      idx = next;
+    } /* while() */
+  }
+
+  template <typename TFunc>
+  size_t fire_list(size_t list, const TFunc& f) {
+    size_t count = 0;
+    while (kNil != m_heads[list]) {
+      uint32_t idx = m_heads[list];
+      unlink(idx);
+      T payload = std::move(m_nodes[idx].payload);
+      release(idx);
+      f(payload);
+      ++count;
+    } /* while() */
+    return count;
+  }
+
+  void link(uint32_t idx, size_t list) {
+    auto& n = m_nodes[idx];
+    n.list = static_cast<uint32_t>(list);
+    n.prev = kNil;
+    n.next = m_heads[list];
+    if (kNil != n.next) {
+      m_nodes[n.next].prev = idx;
+    }
+    m_heads[list] = idx;
+  }
+
+  void unlink(uint32_t idx) {
+    auto& n = m_nodes[idx];
+    if (kNil != n.prev) {
+      m_nodes[n.prev].next = n.next;
+    } else {
+      m_heads[n.list] = n.next;
+    }
+    if (kNil != n.next) {
+      m_nodes[n.next].prev = n.prev;
+    }
+  }
+
+  void release(uint32_t idx) {
+    auto& n = m_nodes[idx];
+    n.payload = T();
+    n.live = false;
+    ++n.gen;
+    n.next = m_free;
+    m_free = idx;
+    --m_size;
+  }
+
+  /* clang-format off */
+  size_t                           m_now;
+  size_t                           m_size{0};
+  uint32_t                         m_free{kNil};
+  std::vector<node>                m_nodes{};
+  std::array<uint32_t, kNumLists>  m_heads{};
+  /* clang-format on */
+};
+
+NS_END(ds, rcppsw);
+
+#endif /* INCLUDE_RCPPSW_DS_TIMER_WHEEL_HPP_ */
@@ -81,6 +81,13 @@ class rng final : public patterns::pimpl::pimpl<detail::rng_impl> {
    */
   double exponential(double lambda);
 
+  /**
+   * \brief Fill \p out with \p n selections according to the exponential
+   * distribution 1 - e ^(-lambda), using a single distribution object. Much
+   * cheaper than \p n calls to \ref exponential(double).
+   */
+  void exponential(double lambda, double* out, size_t n);
+
   /**
    * \brief Return a selection according to a Bernoulli distribution with
    * parameter \p p.
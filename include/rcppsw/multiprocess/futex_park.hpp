@@ -0,0 +1,198 @@
+/**
+ * \file futex_park.hpp
+ *
+ * \copyright 2020 John Harwell, All rights reserved.
+ *
+ * This file is part of RCPPSW.
+ *
+ * RCPPSW is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * RCPPSW is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * RCPPSW.  If not, see <http://www.gnu.org/licenses/
+ */
+
+#ifndef INCLUDE_RCPPSW_MULTIPROCESS_FUTEX_PARK_HPP_
+#define INCLUDE_RCPPSW_MULTIPROCESS_FUTEX_PARK_HPP_
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <ctime>
+#include <thread>
+
+#include "rcppsw/rcppsw.hpp"
+
+/*******************************************************************************
+ * Namespaces/Decls
+ ******************************************************************************/
+NS_START(rcppsw, multiprocess);
+
+/*******************************************************************************
+ * Class Definitions
+ ******************************************************************************/
+/**
+ * \class futex_park
+ * \ingroup multiprocess
+ *
+ * \brief Waiting policy for structures living in shared memory: the
+ * interprocess analogue of \ref multithread::spin_park. Spin on the
+ * non-blocking operation for a while, then yield, and finally sleep on a
+ * (non-private) futex until another process calls \ref notify().
+ *
+ * Only contains plain atomics, so it can be placed in a shared memory segment
+ * and used from processes which map it at different addresses. \ref notify()
+ * only makes a syscall if some process is actually sleeping.
+ */
+class futex_park {
+ public:
+  /**
+   * \brief # of attempts before starting to yield.
+   */
+  static constexpr size_t kSpinCount = 64;
+
+  /**
+   * \brief # of attempts (with yields in between) before sleeping.
+   */
+  static constexpr size_t kYieldCount = 16;
+
+  futex_park(void) = default;
+
+  /* Not move/copy constructable/assignable by default */
+  futex_park(const futex_park&) = delete;
+  const futex_park& operator=(const futex_park&) = delete;
+  futex_park(futex_park&&) = delete;
+  futex_park& operator=(futex_park&&) = delete;
+
+  /**
+   * \brief Call \p try_op() until it returns \c TRUE, spinning, then yielding,
+   * then sleeping between attempts.
+   */
+  template <typename TFunc>
+  void wait(const TFunc& try_op) {
+    for (size_t i = 0; i < kSpinCount; ++i) {
+      if (try_op()) {
+        return;
+      }
+    } /* for(i..) */
+
+    for (size_t i = 0; i < kYieldCount; ++i) {
+      std::this_thread::yield();
+      if (try_op()) {
+        return;
+      }
+    } /* for(i..) */
+
+    while (true) {
+      uint32_t seq = m_seq.load(std::memory_order_acquire);
+      m_sleepers.fetch_add(1, std::memory_order_seq_cst);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (try_op()) {
+        m_sleepers.fetch_sub(1, std::memory_order_relaxed);
+        return;
+      }
+      /* returns immediately if notify() bumped the sequence since we read it */
+      syscall(SYS_futex,
+              reinterpret_cast<uint32_t*>(&m_seq),
+              FUTEX_WAIT,
+              seq,
+              nullptr,
+              nullptr,
+              0);
+      m_sleepers.fetch_sub(1, std::memory_order_relaxed);
+    } /* while() */
+  }
+
+  /**
+   * \brief Like \ref wait(), but give up after (roughly) \p timeout.
+   *
+   * \return The result of the last call to \p try_op().
+   */
+  template <typename TFunc>
+  bool wait_for(const TFunc& try_op, std::chrono::nanoseconds timeout) {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    for (size_t i = 0; i < kSpinCount; ++i) {
+      if (try_op()) {
+        return true;
+      }
+    } /* for(i..) */
+
+    while (true) {
+      auto left = deadline - std::chrono::steady_clock::now();
+      if (left <= std::chrono::nanoseconds::zero()) {
+        return try_op();
+      }
+      uint32_t seq = m_seq.load(std::memory_order_acquire);
+      m_sleepers.fetch_add(1, std::memory_order_seq_cst);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (try_op()) {
+        m_sleepers.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+      }
+      auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(left);
+      struct timespec ts {};
+      ts.tv_sec = ns.count() / 1000000000;
+      ts.tv_nsec = ns.count() % 1000000000;
+      syscall(SYS_futex,
+              reinterpret_cast<uint32_t*>(&m_seq),
+              FUTEX_WAIT,
+              seq,
+              &ts,
+              nullptr,
+              0);
+      m_sleepers.fetch_sub(1, std::memory_order_relaxed);
+    } /* while() */
+  }
+
+  /**
+   * \brief Wake all sleeping processes/threads so they retry their
+   * operation. Should be called after every operation which might let a
+   * waiter proceed.
+   */
+  void notify(void) {
+    /*
+     * Pairs with the increment of the sleeper count in wait(): either we see
+     * the sleeper, or it sees the effects of our operation when it retries
+     * before sleeping.
+     */
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (0 != m_sleepers.load(std::memory_order_relaxed)) {
+      m_seq.fetch_add(1, std::memory_order_release);
+      syscall(SYS_futex,
+              reinterpret_cast<uint32_t*>(&m_seq),
+              FUTEX_WAKE,
+              INT_MAX,
+              nullptr,
+              nullptr,
+              0);
+    }
+  }
+
+ private:
+  static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t) &&
+                    std::atomic<uint32_t>::is_always_lock_free,
+                "futex word must be a plain lock-free 32-bit integer");
+
+  /* clang-format off */
+  std::atomic<uint32_t> m_seq{0};
+  std::atomic<uint32_t> m_sleepers{0};
+  /* clang-format on */
+};
+
+NS_END(multiprocess, rcppsw);
+
+#endif /* INCLUDE_RCPPSW_MULTIPROCESS_FUTEX_PARK_HPP_ */
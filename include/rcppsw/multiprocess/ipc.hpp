@@ -26,11 +26,13 @@
  * Includes
  ******************************************************************************/
 #include <boost/interprocess/allocators/allocator.hpp>
+#include <boost/interprocess/anonymous_shared_memory.hpp>
 #include <boost/interprocess/containers/deque.hpp>
 #include <boost/interprocess/containers/list.hpp>
 #include <boost/interprocess/containers/map.hpp>
 #include <boost/interprocess/containers/string.hpp>
 #include <boost/interprocess/ipc/message_queue.hpp>
+#include <boost/interprocess/managed_external_buffer.hpp>
 #include <boost/interprocess/managed_shared_memory.hpp>
 #include <boost/interprocess/sync/interprocess_condition.hpp>
 #include <boost/interprocess/sync/interprocess_mutex.hpp>
@@ -106,6 +108,20 @@ using ipc_map = bip::
 using ipc_string =
     bip::basic_string<char, std::char_traits<char>, ipc_allocator<char>>;
 
+/**
+ * \typedef ipc_buffer_segment
+ * \ingroup multiprocess
+ *
+ * \brief A managed segment in a caller-provided block of shared memory (e.g.,
+ * from bip::anonymous_shared_memory(), which is inherited by fork()ed
+ * children). Has the same segment manager as bip::managed_shared_memory, so the
+ * ipc_* containers/\ref ipc_allocator can be used with it.
+ */
+using ipc_buffer_segment =
+    bip::basic_managed_external_buffer<char,
+                                       bip::rbtree_best_fit<bip::mutex_family>,
+                                       bip::iset_index>;
+
 NS_END(multiprocess, rcppsw);
 
 #endif /* INCLUDE_RCPPSW_MULTIPROCESS_IPC_HPP_ */
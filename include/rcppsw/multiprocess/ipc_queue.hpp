@@ -44,7 +44,7 @@ NS_START(rcppsw, multiprocess);
  * \ingroup interprocess
  *
  * \brief Interprocess synchronized queue (like \ref multithread::mt_queue, but
- * for processes).
+ * for processes). For large elements and/or high rates, see \ref shm_ring.
  */
 template <class T>
 class ipc_queue {
@@ -161,14 +161,16 @@ class ipc_queue {
   }
 
   /**
-   * \brief Get the current # of elements in the queue. This function performs
-   * no locking, and even if it did, the result would be immediately out of
-   * date, so don't depend on this value among multiple processes without
-   * additional synchronization.
+   * \brief Get the current # of elements in the queue. The result may be
+   * immediately out of date, so don't depend on this value among multiple
+   * processes without additional synchronization.
    *
    * \return The current # elements in the queue.
    */
-  size_t size() const { return m_queue.size(); }
+  size_t size() const {
+    bip::scoped_lock<bip::interprocess_mutex> lock(m_io_mutex);
+    return m_queue.size();
+  }
 
  private:
   /* clang-format off */
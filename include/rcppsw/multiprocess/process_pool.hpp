@@ -0,0 +1,529 @@
+/**
+ * \file process_pool.hpp
+ *
+ * \copyright 2020 John Harwell, All rights reserved.
+ *
+ * This file is part of RCPPSW.
+ *
+ * RCPPSW is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * RCPPSW is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * RCPPSW.  If not, see <http://www.gnu.org/licenses/
+ */
+
+#ifndef INCLUDE_RCPPSW_MULTIPROCESS_PROCESS_POOL_HPP_
+#define INCLUDE_RCPPSW_MULTIPROCESS_PROCESS_POOL_HPP_
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <boost/optional.hpp>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <limits>
+#include <map>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "rcppsw/er/client.hpp"
+#include "rcppsw/multiprocess/forkable.hpp"
+#include "rcppsw/multiprocess/futex_park.hpp"
+#include "rcppsw/multiprocess/ipc.hpp"
+#include "rcppsw/multiprocess/shm_ring.hpp"
+#include "rcppsw/multithread/cache.hpp"
+#include "rcppsw/rcppsw.hpp"
+
+/*******************************************************************************
+ * Namespaces/Decls
+ ******************************************************************************/
+NS_START(rcppsw, multiprocess);
+
+/**
+ * \brief Get \p n cores to pin processes to, spread round-robin across the
+ * sockets of the machine (so that consecutive processes land on different
+ * sockets). Only cores in the calling process's affinity mask are used. If the
+ * mask cannot be read, all entries are -1 (no pinning).
+ */
+std::vector<int> cores_across_sockets(size_t n);
+
+/**
+ * \brief Set the affinity of the calling process to the single core \p core.
+ *
+ * Unlike the core argument of \ref forkable::start(), which names a socket,
+ * this pins to exactly one core.
+ *
+ * \return \c TRUE iff the affinity was set.
+ */
+bool pin_to_core(int core);
+
+/*******************************************************************************
+ * Class Definitions
+ ******************************************************************************/
+/**
+ * \class process_pool
+ * \ingroup multiprocess
+ *
+ * \brief A pool of pre-forked worker processes (each a \ref forkable) which run
+ * jobs submitted by the parent process, so the cost of fork() is paid once per
+ * worker rather than once per job (e.g., for parameter sweeps).
+ *
+ * Each worker has a job queue and a result queue (\ref spsc_shm_ring), in an
+ * anonymous shared memory segment (\ref ipc_buffer_segment) created before the
+ * workers are forked. Jobs are
+ * dispatched to the worker with the fewest jobs in flight. The parent gathers
+ * results with \ref collect() or \ref wait_all(), which also check for workers
+ * which have died: those are re-forked, and the jobs they had in flight are
+ * re-dispatched to them. A job which was running when its worker died \ref
+ * kMaxAttempts times is given up on, and returned without a result (jobs which
+ * were only queued on the worker are re-dispatched without penalty).
+ *
+ * A worker which cannot be forked (e.g., because fork() fails with EAGAIN) is
+ * treated like one which has died: the failure is reported, and forking it is
+ * retried by \ref collect() and \ref wait_all(), with its jobs left pending
+ * until it succeeds.
+ *
+ * The job function is inherited by the workers via fork(), so it can capture
+ * anything (including state built in the parent before the pool was
+ * created). Only the parent should use the pool object.
+ *
+ * \tparam TJob The job description. Must be trivially copyable.
+ * \tparam TResult The job result. Must be trivially copyable.
+ */
+template <typename TJob, typename TResult>
+class process_pool : public er::client<process_pool<TJob, TResult>> {
+ public:
+  static_assert(std::is_trivially_copyable<TJob>::value,
+                "process_pool jobs must be trivially copyable");
+  static_assert(std::is_trivially_copyable<TResult>::value,
+                "process_pool results must be trivially copyable");
+
+  using job_func = std::function<TResult(const TJob&)>;
+  using job_id = uint64_t;
+
+  /**
+   * \brief # of times a job is tried before it is given up on.
+   */
+  static constexpr size_t kMaxAttempts = 3;
+
+  /**
+   * \brief Default size of each job/result queue in bytes.
+   */
+  static constexpr size_t kDefaultQueueCapacity = 1 << 20;
+
+  /**
+   * \brief ID returned by \ref submit() for jobs which were rejected.
+   */
+  static constexpr job_id kRejectedID = std::numeric_limits<job_id>::max();
+
+  struct job_result {
+    job_id id;
+    /* Empty if the job was given up on */
+    boost::optional<TResult> result;
+  };
+
+  /**
+   * \param n_workers The # of worker processes.
+   * \param f The function which runs a job.
+   * \param pin If \c TRUE, pin each worker to a single core, with the cores
+   *            spread across sockets (see \ref cores_across_sockets()).
+   * \param queue_capacity Size of each job/result queue in bytes.
+   */
+  process_pool(size_t n_workers,
+               job_func f,
+               bool pin = false,
+               size_t queue_capacity = kDefaultQueueCapacity)
+      : ER_CLIENT_INIT("rcppsw.multiprocess.process_pool"),
+        m_func(std::move(f)),
+        mc_queue_capacity(queue_capacity),
+        m_region(bip::anonymous_shared_memory(
+            segment_size(std::max<size_t>(n_workers, 1), queue_capacity))),
+        m_segment(bip::create_only,
+                  m_region.get_address(),
+                  m_region.get_size()),
+        m_done(m_segment.construct<futex_park>(bip::anonymous_instance)()) {
+    n_workers = std::max<size_t>(n_workers, 1);
+    std::vector<int> cores = pin ? cores_across_sockets(n_workers)
+                                 : std::vector<int>(n_workers, -1);
+    for (size_t i = 0; i < n_workers; ++i) {
+      slot s;
+      s.jobs_mem = alloc_ring();
+      s.results_mem = alloc_ring();
+      s.running = m_segment.construct<std::atomic<uint64_t>>(
+          bip::anonymous_instance)(0);
+      s.core = cores[i];
+      m_slots.push_back(std::move(s));
+      /* if the fork fails, reap() retries it */
+      start_worker(i);
+    } /* for(i..) */
+  }
+
+  /**
+   * \brief Calls \ref term().
+   */
+  ~process_pool(void) { term(); }
+
+  /* Not move/copy constructable/assignable by default */
+  process_pool(const process_pool&) = delete;
+  const process_pool& operator=(const process_pool&) = delete;
+  process_pool(process_pool&&) = delete;
+  process_pool& operator=(process_pool&&) = delete;
+
+  size_t n_workers(void) const { return m_slots.size(); }
+
+  /**
+   * \brief Get the # of jobs submitted whose results have not been collected
+   * yet.
+   */
+  size_t n_pending(void) const { return m_pending.size() + m_ready.size(); }
+
+  /**
+   * \brief Get the # of times a dead worker has been re-forked.
+   */
+  size_t n_restarts(void) const { return m_n_restarts; }
+
+  /**
+   * \brief Queue a job, waiting for room in the chosen worker's queue if
+   * needed.
+   *
+   * \return The ID of the job, which its result will carry, or \ref
+   * kRejectedID if called after \ref term().
+   */
+  job_id submit(const TJob& job) {
+    if (m_terminated) {
+      ER_ERR("Job submitted after term()");
+      return kRejectedID;
+    }
+    job_id id = m_next_id++;
+    m_pending.insert({ id, pending_job{ job, 0, 0 } });
+    auto min = std::min_element(m_slots.begin(),
+                                m_slots.end(),
+                                [](const slot& a, const slot& b) {
+                                  return a.n_inflight < b.n_inflight;
+                                });
+    dispatch(id, static_cast<size_t>(min - m_slots.begin()));
+    return id;
+  }
+
+  /**
+   * \brief Get the results which are available, without waiting. Restarts any
+   * workers which have died.
+   */
+  std::vector<job_result> collect(void) {
+    harvest_all();
+    reap();
+    return take_ready();
+  }
+
+  /**
+   * \brief Wait until all submitted jobs are done, and get all results not
+   * collected yet.
+   */
+  std::vector<job_result> wait_all(void) {
+    harvest_all();
+    while (!m_pending.empty()) {
+      /* wake up now and then to check for dead workers */
+      m_done->wait_for(
+          [&]() {
+            return std::any_of(m_slots.begin(),
+                               m_slots.end(),
+                               [](const slot& s) {
+                                 return !s.results->empty();
+                               });
+          },
+          std::chrono::milliseconds(kReapIntervalMS));
+      harvest_all();
+      reap();
+    } /* while() */
+    return take_ready();
+  }
+
+  /**
+   * \brief Tell the workers to exit once they have run the jobs already
+   * dispatched to them, and wait for them. Results not collected are dropped
+   * (call \ref wait_all() first to get them), and no more jobs can be
+   * submitted. Idempotent.
+   */
+  void term(void) {
+    if (m_terminated) {
+      return;
+    }
+    m_terminated = true;
+    m_pending.clear();
+    m_ready.clear();
+    for (auto& s : m_slots) {
+      s.jobs->interrupt();
+      s.results->interrupt();
+    } /* for(&s..) */
+    for (auto& s : m_slots) {
+      if (running(s)) {
+        waitpid(s.proc->pid(), nullptr, 0);
+      }
+    } /* for(&s..) */
+  }
+
+ private:
+  static constexpr size_t kReapIntervalMS = 10;
+
+  struct job_record {
+    job_id id;
+    TJob job;
+  };
+  struct result_record {
+    job_id id;
+    TResult result;
+  };
+  struct pending_job {
+    TJob job;
+    size_t worker;
+    size_t attempts;
+  };
+
+  /**
+   * \brief A worker process: runs jobs from its job queue until the queue is
+   * interrupted and empty.
+   */
+  class worker : public forkable {
+   public:
+    worker(const job_func* f,
+           spsc_shm_ring* jobs,
+           spsc_shm_ring* results,
+           std::atomic<uint64_t>* running,
+           futex_park* done,
+           int core)
+        : m_func(f),
+          m_jobs(jobs),
+          m_results(results),
+          m_running(running),
+          m_done(done),
+          m_core(core) {}
+
+    void proc_main(void) override {
+      if (-1 != m_core) {
+        pin_to_core(m_core);
+      }
+      while (!(m_jobs->interrupted() && m_jobs->empty())) {
+        m_jobs->wait_consume(
+            [&](const uint8_t* data, size_t) {
+              auto* rec = reinterpret_cast<const job_record*>(data);
+              m_running->store(rec->id + 1, std::memory_order_release);
+              result_record res{ rec->id, (*m_func)(rec->job) };
+              m_running->store(0, std::memory_order_release);
+              m_results->write(&res, sizeof(res));
+              m_done->notify();
+            },
+            1);
+      } /* while() */
+
+      /* never return into the parent's code */
+      _exit(0);
+    }
+
+   private:
+    /* clang-format off */
+    const job_func*        m_func;
+    spsc_shm_ring*         m_jobs;
+    spsc_shm_ring*         m_results;
+    /* ID + 1 of the job being run, or 0 */
+    std::atomic<uint64_t>* m_running;
+    futex_park*            m_done;
+    /* core to pin to, or -1 */
+    int                    m_core;
+    /* clang-format on */
+  };
+
+  struct slot {
+    std::unique_ptr<worker> proc{nullptr};
+    void* jobs_mem{nullptr};
+    void* results_mem{nullptr};
+    spsc_shm_ring* jobs{nullptr};
+    spsc_shm_ring* results{nullptr};
+    std::atomic<uint64_t>* running{nullptr};
+    int core{-1};
+    size_t n_inflight{0};
+  };
+
+  static size_t segment_size(size_t n_workers, size_t queue_capacity) {
+    /* rings, plus slack for alignment and the segment's own bookkeeping */
+    return 2 * n_workers *
+               (spsc_shm_ring::footprint(queue_capacity) +
+                multithread::kCacheLineSize) +
+           (1 << 16);
+  }
+
+  void* alloc_ring(void) {
+    return m_segment.allocate_aligned(
+        spsc_shm_ring::footprint(mc_queue_capacity),
+        multithread::kCacheLineSize);
+  }
+
+  /**
+   * \brief (Re)create worker \p i's queues and fork it.
+   *
+   * \return \ref ERROR if fork() failed, in which case the worker is not
+   * running (see \ref running()).
+   */
+  status_t start_worker(size_t i) {
+    slot& s = m_slots[i];
+    s.jobs = spsc_shm_ring::create(s.jobs_mem, mc_queue_capacity);
+    s.results = spsc_shm_ring::create(s.results_mem, mc_queue_capacity);
+    s.running->store(0, std::memory_order_relaxed);
+    s.proc = std::make_unique<worker>(
+        &m_func, s.jobs, s.results, s.running, m_done, s.core);
+    /*
+     * The worker pins itself: forkable::start() takes a socket, not a core.
+     */
+    ER_CHECK(s.proc->start() > 0, "Failed to fork worker %zu", i);
+    return OK;
+
+  error:
+    return ERROR;
+  }
+
+  void dispatch(job_id id, size_t i) {
+    pending_job& job = m_pending.at(id);
+    job.worker = i;
+    ++m_slots[i].n_inflight;
+
+    job_record rec{ id, job.job };
+    while (!m_slots[i].jobs->try_write(&rec, sizeof(rec))) {
+      /*
+       * Make progress on results, so the worker does not block on them. Dead
+       * workers are not restarted here (that would re-dispatch the jobs
+       * in flight on them out from under our callers); if the worker has
+       * died, the job is left pending on it, and \ref reap() re-dispatches it
+       * along with the rest of the worker's jobs.
+       */
+      harvest_all();
+      if (exited(m_slots[i])) {
+        return;
+      }
+      std::this_thread::yield();
+    } /* while() */
+  }
+
+  /**
+   * \brief Determine if the worker in \p s was forked. Its PID is only passed
+   * to waitpid()/waitid() if so, since a PID <= 0 means any child process to
+   * them.
+   */
+  static bool running(const slot& s) { return s.proc->pid() > 0; }
+
+  /**
+   * \brief Determine if the worker in \p s has exited (or was never forked),
+   * without reaping it.
+   */
+  static bool exited(const slot& s) {
+    if (!running(s)) {
+      return true;
+    }
+    siginfo_t info{};
+    return 0 == waitid(P_PID,
+                       static_cast<id_t>(s.proc->pid()),
+                       &info,
+                       WEXITED | WNOHANG | WNOWAIT) &&
+           0 != info.si_pid;
+  }
+
+  void harvest(slot* s) {
+    s->results->consume(
+        [&](const uint8_t* data, size_t) {
+          auto* rec = reinterpret_cast<const result_record*>(data);
+          if (1 == m_pending.erase(rec->id)) {
+            --s->n_inflight;
+            m_ready.push_back({ rec->id, rec->result });
+          }
+        },
+        std::numeric_limits<size_t>::max());
+  }
+
+  std::vector<job_result> take_ready(void) {
+    std::vector<job_result> ret;
+    ret.swap(m_ready);
+    return ret;
+  }
+
+  void harvest_all(void) {
+    for (auto& s : m_slots) {
+      harvest(&s);
+    } /* for(&s..) */
+  }
+
+  /**
+   * \brief Re-fork any workers which have died (or could not be forked), and
+   * re-dispatch their jobs. A worker which still cannot be forked keeps its
+   * jobs pending until the next call.
+   */
+  void reap(void) {
+    if (m_terminated) {
+      return;
+    }
+    for (size_t i = 0; i < m_slots.size(); ++i) {
+      slot& s = m_slots[i];
+      if (running(s) &&
+          s.proc->pid() != waitpid(s.proc->pid(), nullptr, WNOHANG)) {
+        continue;
+      }
+      /* anything it finished before dying still counts */
+      harvest(&s);
+      uint64_t culprit = s.running->load(std::memory_order_acquire);
+      s.n_inflight = 0;
+
+      std::vector<job_id> redo;
+      std::vector<job_id> failed;
+      for (auto& p : m_pending) {
+        if (p.second.worker != i) {
+          continue;
+        }
+        if (p.first + 1 == culprit && ++p.second.attempts >= kMaxAttempts) {
+          failed.push_back(p.first);
+        } else {
+          redo.push_back(p.first);
+        }
+      } /* for(&p..) */
+      for (job_id id : failed) {
+        m_pending.erase(id);
+        m_ready.push_back({ id, boost::none });
+      } /* for(id..) */
+
+      if (OK != start_worker(i)) {
+        continue;
+      }
+      ++m_n_restarts;
+      for (job_id id : redo) {
+        dispatch(id, i);
+      } /* for(id..) */
+    } /* for(i..) */
+  }
+
+  /* clang-format off */
+  job_func                              m_func;
+  const size_t                          mc_queue_capacity;
+  bip::mapped_region                    m_region;
+  ipc_buffer_segment                    m_segment;
+  futex_park*                           m_done;
+  std::vector<slot>                     m_slots{};
+  std::map<job_id, pending_job>         m_pending{};
+  std::vector<job_result>               m_ready{};
+  job_id                                m_next_id{0};
+  size_t                                m_n_restarts{0};
+  bool                                  m_terminated{false};
+  /* clang-format on */
+};
+
+NS_END(multiprocess, rcppsw);
+
+#endif /* INCLUDE_RCPPSW_MULTIPROCESS_PROCESS_POOL_HPP_ */
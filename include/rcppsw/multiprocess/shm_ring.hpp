@@ -0,0 +1,391 @@
+/**
+ * \file shm_ring.hpp
+ *
+ * \copyright 2020 John Harwell, All rights reserved.
+ *
+ * This file is part of RCPPSW.
+ *
+ * RCPPSW is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * RCPPSW is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * RCPPSW.  If not, see <http://www.gnu.org/licenses/
+ */
+
+#ifndef INCLUDE_RCPPSW_MULTIPROCESS_SHM_RING_HPP_
+#define INCLUDE_RCPPSW_MULTIPROCESS_SHM_RING_HPP_
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <thread>
+
+#include "rcppsw/multiprocess/futex_park.hpp"
+#include "rcppsw/multithread/cache.hpp"
+#include "rcppsw/rcppsw.hpp"
+
+/*******************************************************************************
+ * Namespaces/Decls
+ ******************************************************************************/
+NS_START(rcppsw, multiprocess);
+
+/*******************************************************************************
+ * Class Definitions
+ ******************************************************************************/
+/**
+ * \class shm_ring
+ * \ingroup multiprocess
+ *
+ * \brief A lock-free byte ring buffer of variable-length records, which lives
+ * in shared memory, for passing large amounts of data between processes
+ * without copying it through a lock-protected queue (as \ref ipc_queue does).
+ *
+ * Producers reserve space for a record, build the record in place in the
+ * ring, and then commit it; the (single) consumer is handed a pointer to each
+ * record in the ring, so the only copies are the ones the producer and
+ * consumer choose to make. Records are contiguous (if a record would wrap
+ * around the end of the ring, the space up to the end is skipped) and aligned
+ * to \ref kAlign bytes, so POD structures can be built/read in place.
+ *
+ * The ring only contains positions and atomics (no pointers), so processes can
+ * map it at different addresses. Blocking operations wait via \ref
+ * futex_park.
+ *
+ * \tparam kMultiProducer If \c TRUE, any # of producers can write concurrently
+ *                        (they claim space with a CAS, and commit in claim
+ *                        order). Otherwise, only one producer is allowed.
+ *
+ * Usage: map \ref footprint() bytes of shared memory (aligned to \ref
+ * multithread::kCacheLineSize, e.g. via mmap(), or
+ * bip::managed_shared_memory::allocate_aligned()), call \ref create() on it in
+ * one process, and \ref attach() in the others.
+ */
+template <bool kMultiProducer = false>
+class shm_ring {
+ public:
+  /**
+   * \brief Alignment of all records.
+   */
+  static constexpr size_t kAlign = 16;
+
+  /**
+   * \brief Space claimed for a record by a producer, to be filled in and then
+   * passed to \ref commit().
+   */
+  class reservation {
+   public:
+    reservation(void) = default;
+
+    uint8_t* data(void) const { return m_data; }
+    size_t size(void) const { return m_size; }
+    bool valid(void) const { return nullptr != m_data; }
+
+   private:
+    friend class shm_ring;
+
+    reservation(uint8_t* data, size_t size, uint64_t pos, uint64_t span)
+        : m_data(data), m_size(size), m_pos(pos), m_span(span) {}
+
+    /* clang-format off */
+    uint8_t* m_data{nullptr};
+    size_t   m_size{0};
+    uint64_t m_pos{0};
+    uint64_t m_span{0};
+    /* clang-format on */
+  };
+
+  /**
+   * \brief Get the # of bytes of shared memory needed for a ring with
+   * (at least) \p capacity bytes for records.
+   */
+  static size_t footprint(size_t capacity) {
+    return sizeof(shm_ring) + ring_size(capacity);
+  }
+
+  /**
+   * \brief Construct a ring in \p mem, which must be \ref footprint(\p
+   * capacity) bytes.
+   */
+  static shm_ring* create(void* mem, size_t capacity) {
+    return new (mem) shm_ring(ring_size(capacity));
+  }
+
+  /**
+   * \brief Get the ring previously constructed in \p mem by \ref create()
+   * (possibly in another process).
+   */
+  static shm_ring* attach(void* mem) {
+    return std::launder(static_cast<shm_ring*>(mem));
+  }
+
+  /* Not move/copy constructable/assignable by default */
+  shm_ring(const shm_ring&) = delete;
+  const shm_ring& operator=(const shm_ring&) = delete;
+  shm_ring(shm_ring&&) = delete;
+  shm_ring& operator=(shm_ring&&) = delete;
+
+  size_t capacity(void) const { return mc_capacity; }
+
+  /**
+   * \brief Get the size of the largest record the ring can hold.
+   */
+  size_t max_record_size(void) const {
+    return mc_capacity / 2 - sizeof(record_header);
+  }
+
+  /**
+   * \brief Get the # of bytes used by committed records. Only approximate if
+   * other processes are using the ring.
+   */
+  size_t size_approx(void) const {
+    uint64_t commit = m_commit.load(std::memory_order_relaxed);
+    uint64_t read = m_read.load(std::memory_order_relaxed);
+    return commit >= read ? commit - read : 0;
+  }
+
+  bool empty(void) const {
+    return m_commit.load(std::memory_order_acquire) ==
+           m_read.load(std::memory_order_acquire);
+  }
+
+  /**
+   * \brief Claim space for a \p len byte record, if there is room (and \p len
+   * is at most \ref max_record_size()).
+   *
+   * \return The reservation, which is not \ref reservation::valid() if there
+   * was no room. Single producer: only one reservation can be outstanding at a
+   * time. Multi-producer: each producer must commit its reservations in the
+   * order it made them.
+   */
+  reservation try_reserve(size_t len) {
+    if (len > max_record_size()) {
+      return {};
+    }
+    uint64_t need = align(sizeof(record_header) + len);
+    uint64_t pos;
+    uint64_t pad;
+    if constexpr (kMultiProducer) {
+      pos = m_reserve.load(std::memory_order_relaxed);
+      do {
+        pad = wrap_pad(pos, need);
+        if (pos + pad + need - m_read.load(std::memory_order_acquire) >
+            mc_capacity) {
+          return {};
+        }
+      } while (!m_reserve.compare_exchange_weak(pos,
+                                                pos + pad + need,
+                                                std::memory_order_relaxed,
+                                                std::memory_order_relaxed));
+    } else {
+      /* the consumer's position is only reloaded when it looks full */
+      pos = m_commit.load(std::memory_order_relaxed);
+      pad = wrap_pad(pos, need);
+      if (pos + pad + need - m_read_cache > mc_capacity) {
+        m_read_cache = m_read.load(std::memory_order_acquire);
+        if (pos + pad + need - m_read_cache > mc_capacity) {
+          return {};
+        }
+      }
+    }
+
+    if (0 != pad) {
+      *header(pos) = { pad, 1 };
+    }
+    *header(pos + pad) = { len, 0 };
+    return { payload(pos + pad), len, pos, pad + need };
+  }
+
+  /**
+   * \brief Claim space for a \p len byte record, waiting for room if needed.
+   *
+   * \return The reservation, which is only not \ref reservation::valid() if
+   * \p len is too big, or the ring was interrupted.
+   */
+  reservation reserve(size_t len) {
+    reservation res;
+    if (len > max_record_size()) {
+      return res;
+    }
+    m_not_full.wait([&]() {
+      res = try_reserve(len);
+      return res.valid() || interrupted();
+    });
+    return res;
+  }
+
+  /**
+   * \brief Make a filled in record visible to the consumer.
+   */
+  void commit(const reservation& res) {
+    if constexpr (kMultiProducer) {
+      /* records become visible in the order they were reserved */
+      while (m_commit.load(std::memory_order_acquire) != res.m_pos) {
+        std::this_thread::yield();
+      } /* while() */
+    }
+    m_commit.store(res.m_pos + res.m_span, std::memory_order_release);
+    m_not_empty.notify();
+  }
+
+  /**
+   * \brief Copy \p len bytes from \p src into a new record, if there is room.
+   */
+  bool try_write(const void* src, size_t len) {
+    reservation res = try_reserve(len);
+    if (!res.valid()) {
+      return false;
+    }
+    std::memcpy(res.data(), src, len);
+    commit(res);
+    return true;
+  }
+
+  /**
+   * \brief Copy \p len bytes from \p src into a new record, waiting for room
+   * if needed.
+   *
+   * \return \c FALSE if \p len is too big or the ring was interrupted.
+   */
+  bool write(const void* src, size_t len) {
+    reservation res = reserve(len);
+    if (!res.valid()) {
+      return false;
+    }
+    std::memcpy(res.data(), src, len);
+    commit(res);
+    return true;
+  }
+
+  /**
+   * \brief Call \p f(data, len) for up to \p max committed records, in order,
+   * with \p data pointing at the record in the ring. The records are released
+   * to producers once all of them have been processed, so \p f must not hold
+   * onto \p data. Consumer only.
+   *
+   * \return The # of records processed.
+   */
+  template <typename TFunc>
+  size_t consume(const TFunc& f, size_t max) {
+    uint64_t read = m_read.load(std::memory_order_relaxed);
+    uint64_t commit = m_commit.load(std::memory_order_acquire);
+    size_t n = 0;
+    while (read != commit && n < max) {
+      const record_header* hdr = header(read);
+      if (0 != hdr->skip) {
+        read += hdr->size;
+        continue;
+      }
+      f(static_cast<const uint8_t*>(payload(read)),
+        static_cast<size_t>(hdr->size));
+      read += align(sizeof(record_header) + hdr->size);
+      ++n;
+    } /* while() */
+    m_read.store(read, std::memory_order_release);
+    m_not_full.notify();
+    return n;
+  }
+
+  /**
+   * \brief Wait until there is at least one record (or \ref interrupt() is
+   * called), then \ref consume() up to \p max records. Consumer only.
+   */
+  template <typename TFunc>
+  size_t wait_consume(const TFunc& f, size_t max) {
+    m_not_empty.wait([&]() { return interrupted() || !empty(); });
+    return consume(f, max);
+  }
+
+  /**
+   * \brief Wake up everything blocked on the ring, and make all future
+   * blocking calls non-blocking.
+   */
+  void interrupt(void) {
+    m_interrupt.store(1, std::memory_order_release);
+    m_not_empty.notify();
+    m_not_full.notify();
+  }
+
+  bool interrupted(void) const {
+    return 0 != m_interrupt.load(std::memory_order_acquire);
+  }
+
+ private:
+  struct record_header {
+    uint64_t size;
+    /* Nonzero if this is padding up to the end of the ring */
+    uint64_t skip;
+  };
+  static_assert(sizeof(record_header) == kAlign, "Bad record header size");
+
+  explicit shm_ring(size_t capacity) : mc_capacity(capacity) {}
+
+  static size_t ring_size(size_t capacity) {
+    size_t n = 256;
+    while (n < capacity) {
+      n <<= 1;
+    } /* while() */
+    return n;
+  }
+
+  static uint64_t align(uint64_t n) { return (n + kAlign - 1) & ~(kAlign - 1); }
+
+  /**
+   * \brief Get the padding needed before a record of \p need bytes at \p pos
+   * so that it does not wrap around the end of the ring.
+   */
+  uint64_t wrap_pad(uint64_t pos, uint64_t need) const {
+    uint64_t off = pos & (mc_capacity - 1);
+    return (off + need > mc_capacity) ? mc_capacity - off : 0;
+  }
+
+  uint8_t* buf(void) const {
+    return const_cast<uint8_t*>(reinterpret_cast<const uint8_t*>(this)) +
+           sizeof(shm_ring);
+  }
+  record_header* header(uint64_t pos) const {
+    return reinterpret_cast<record_header*>(buf() + (pos & (mc_capacity - 1)));
+  }
+  uint8_t* payload(uint64_t pos) const {
+    return buf() + (pos & (mc_capacity - 1)) + sizeof(record_header);
+  }
+
+  /* clang-format off */
+  const uint64_t mc_capacity;
+  std::atomic<uint32_t> m_interrupt{0};
+
+  /* producer side */
+  alignas(multithread::kCacheLineSize) std::atomic<uint64_t> m_reserve{0};
+  uint64_t              m_read_cache{0};
+  alignas(multithread::kCacheLineSize) std::atomic<uint64_t> m_commit{0};
+  futex_park            m_not_full{};
+
+  /* consumer side */
+  alignas(multithread::kCacheLineSize) std::atomic<uint64_t> m_read{0};
+  futex_park            m_not_empty{};
+  /* clang-format on */
+};
+
+/**
+ * \brief Single producer/single consumer \ref shm_ring.
+ */
+using spsc_shm_ring = shm_ring<false>;
+
+/**
+ * \brief Multiple producer/single consumer \ref shm_ring.
+ */
+using mpsc_shm_ring = shm_ring<true>;
+
+NS_END(multiprocess, rcppsw);
+
+#endif /* INCLUDE_RCPPSW_MULTIPROCESS_SHM_RING_HPP_ */
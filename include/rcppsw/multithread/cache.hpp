@@ -0,0 +1,44 @@
+/**
+ * \file cache.hpp
+ *
+ * \copyright 2020 John Harwell, All rights reserved.
+ *
+ * This file is part of RCPPSW.
+ *
+ * RCPPSW is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * RCPPSW is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * RCPPSW.  If not, see <http://www.gnu.org/licenses/
+ */
+
+#ifndef INCLUDE_RCPPSW_MULTITHREAD_CACHE_HPP_
+#define INCLUDE_RCPPSW_MULTITHREAD_CACHE_HPP_
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <cstddef>
+
+#include "rcppsw/rcppsw.hpp"
+
+/*******************************************************************************
+ * Namespaces/Decls
+ ******************************************************************************/
+NS_START(rcppsw, multithread);
+
+/**
+ * \brief Size of a cache line, for padding data written by different threads
+ * (or processes) apart to avoid false sharing.
+ */
+inline constexpr size_t kCacheLineSize = 64;
+
+NS_END(multithread, rcppsw);
+
+#endif /* INCLUDE_RCPPSW_MULTITHREAD_CACHE_HPP_ */
@@ -0,0 +1,264 @@
+/**
+ * \file concurrent_vector.hpp
+ *
+ * \copyright 2020 John Harwell, All rights reserved.
+ *
+ * This file is part of RCPPSW.
+ *
+ * RCPPSW is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * RCPPSW is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * RCPPSW.  If not, see <http://www.gnu.org/licenses/
+ */
+
+#ifndef INCLUDE_RCPPSW_MULTITHREAD_CONCURRENT_VECTOR_HPP_
+#define INCLUDE_RCPPSW_MULTITHREAD_CONCURRENT_VECTOR_HPP_
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "rcppsw/multithread/cache.hpp"
+#include "rcppsw/rcppsw.hpp"
+
+/*******************************************************************************
+ * Namespaces/Decls
+ ******************************************************************************/
+NS_START(rcppsw, multithread);
+
+/*******************************************************************************
+ * Class Definitions
+ ******************************************************************************/
+/**
+ * \class concurrent_vector
+ * \ingroup multithread
+ *
+ * \brief An append-only vector which any number of threads can append to and
+ * read from concurrently without locking. Lock-free replacement for \ref
+ * mt_vector when many threads are collecting results.
+ *
+ * Appending claims an index with a single atomic increment. Elements live in
+ * chunks of doubling size (32, 64, 128, ...) which are allocated on demand and
+ * never moved, so references and indices stay valid for the lifetime of the
+ * vector. Each element has a flag which is set once it has been constructed,
+ * so that readers only ever see fully constructed ("published") elements.
+ *
+ * At the end of a phase, \ref flatten() copies everything into a contiguous
+ * std::vector.
+ *
+ * \tparam T The type of the elements.
+ */
+template <typename T>
+class concurrent_vector {
+ public:
+  using value_type = T;
+
+  concurrent_vector(void) {
+    for (auto& c : m_chunks) {
+      c.store(nullptr, std::memory_order_relaxed);
+    } /* for(&c..) */
+  }
+
+  ~concurrent_vector(void) { clear(); }
+
+  /* Not move/copy constructable/assignable by default */
+  concurrent_vector(const concurrent_vector&) = delete;
+  const concurrent_vector& operator=(const concurrent_vector&) = delete;
+  concurrent_vector(concurrent_vector&&) = delete;
+  concurrent_vector& operator=(concurrent_vector&&) = delete;
+
+  /**
+   * \brief Construct an element in place at the end of the vector. Thread
+   * safe, lock-free (other than when a new chunk needs to be allocated).
+   *
+   * \return The index of the new element, which never changes.
+   */
+  template <typename... Args>
+  size_t emplace_back(Args&&... args) {
+    size_t idx = m_size.fetch_add(1, std::memory_order_relaxed);
+    size_t k = chunk_index(idx);
+    chunk* c = m_chunks[k].load(std::memory_order_acquire);
+    if (nullptr == c) {
+      c = alloc_chunk(k);
+    }
+    size_t off = chunk_offset(idx, k);
+    new (&c->elts[off]) T(std::forward<Args>(args)...);
+    c->ready[off].store(1, std::memory_order_release);
+    return idx;
+  }
+
+  size_t push_back(const T& data) { return emplace_back(data); }
+  size_t push_back(T&& data) { return emplace_back(std::move(data)); }
+
+  /**
+   * \brief Get the # of elements which have been appended (or are in the
+   * process of being appended).
+   */
+  size_t size(void) const { return m_size.load(std::memory_order_acquire); }
+  bool empty(void) const { return 0 == size(); }
+
+  /**
+   * \brief Determine if the element at \p idx has been fully constructed.
+   */
+  bool published(size_t idx) const {
+    if (idx >= size()) {
+      return false;
+    }
+    size_t k = chunk_index(idx);
+    chunk* c = m_chunks[k].load(std::memory_order_acquire);
+    return nullptr != c &&
+           0 != c->ready[chunk_offset(idx, k)].load(std::memory_order_acquire);
+  }
+
+  /**
+   * \brief Get the element at \p idx, which must be \ref published() (e.g.,
+   * an index returned by \ref emplace_back() on this thread, or any index
+   * after all appending threads have been joined).
+   */
+  T& operator[](size_t idx) { return *elt(idx); }
+  const T& operator[](size_t idx) const { return *elt(idx); }
+
+  /**
+   * \brief Call \p f(idx, element) for each published element, in index
+   * order. Elements which are still being constructed are skipped. Safe to
+   * call while other threads are appending.
+   */
+  template <typename TFunc>
+  void for_each(const TFunc& f) const {
+    size_t n = size();
+    for (size_t k = 0; k < kMaxChunks && chunk_start(k) < n; ++k) {
+      chunk* c = m_chunks[k].load(std::memory_order_acquire);
+      if (nullptr == c) {
+        continue;
+      }
+      size_t len = std::min(chunk_size(k), n - chunk_start(k));
+      for (size_t off = 0; off < len; ++off) {
+        if (0 != c->ready[off].load(std::memory_order_acquire)) {
+          f(chunk_start(k) + off, *slot(c, off));
+        }
+      } /* for(off..) */
+    } /* for(k..) */
+  }
+
+  /**
+   * \brief Copy all elements into a contiguous vector, in index order. Should
+   * be called once all appending threads are done (unpublished elements are
+   * skipped).
+   */
+  std::vector<T> flatten(void) const {
+    std::vector<T> res;
+    res.reserve(size());
+    for_each([&](size_t, const T& e) { res.push_back(e); });
+    return res;
+  }
+
+  /**
+   * \brief Destroy all elements and free all chunks. NOT thread safe.
+   */
+  void clear(void) {
+    size_t n = size();
+    for (size_t k = 0; k < kMaxChunks; ++k) {
+      chunk* c = m_chunks[k].exchange(nullptr, std::memory_order_acq_rel);
+      if (nullptr == c) {
+        continue;
+      }
+      size_t len = chunk_start(k) < n
+                       ? std::min(chunk_size(k), n - chunk_start(k))
+                       : 0;
+      for (size_t off = 0; off < len; ++off) {
+        if (0 != c->ready[off].load(std::memory_order_relaxed)) {
+          slot(c, off)->~T();
+        }
+      } /* for(off..) */
+      delete c;
+    } /* for(k..) */
+    m_size.store(0, std::memory_order_release);
+  }
+
+ private:
+  /**
+   * \brief The first chunk holds 2^kFirstChunkBits elements.
+   */
+  static constexpr size_t kFirstChunkBits = 5;
+  static constexpr size_t kMaxChunks = 64 - kFirstChunkBits;
+
+  using storage_type = typename std::aligned_storage<sizeof(T), alignof(T)>::type;
+
+  struct chunk {
+    explicit chunk(size_t n)
+        : elts(std::make_unique<storage_type[]>(n)),
+          ready(std::make_unique<std::atomic<uint8_t>[]>(n)) {}
+
+    std::unique_ptr<storage_type[]> elts;
+    std::unique_ptr<std::atomic<uint8_t>[]> ready;
+  };
+
+  static size_t chunk_index(size_t idx) {
+    return (63 - static_cast<size_t>(__builtin_clzll(idx + chunk_size(0)))) -
+           kFirstChunkBits;
+  }
+  static size_t chunk_size(size_t k) {
+    return size_t(1) << (k + kFirstChunkBits);
+  }
+  static size_t chunk_start(size_t k) { return chunk_size(k) - chunk_size(0); }
+  static size_t chunk_offset(size_t idx, size_t k) {
+    return idx - chunk_start(k);
+  }
+
+  static T* slot(chunk* c, size_t off) {
+    return std::launder(reinterpret_cast<T*>(&c->elts[off]));
+  }
+
+  T* elt(size_t idx) const {
+    size_t k = chunk_index(idx);
+    return slot(m_chunks[k].load(std::memory_order_acquire),
+                chunk_offset(idx, k));
+  }
+
+  /**
+   * \brief Allocate chunk \p k if no other thread has. Returns the winner.
+   */
+  chunk* alloc_chunk(size_t k) {
+    /*
+     * Another thread may have installed it since the caller checked; chunks
+     * get big, so don't allocate one just to throw it away.
+     */
+    chunk* current = m_chunks[k].load(std::memory_order_acquire);
+    if (nullptr != current) {
+      return current;
+    }
+    auto* fresh = new chunk(chunk_size(k));
+    chunk* expected = nullptr;
+    if (m_chunks[k].compare_exchange_strong(
+            expected, fresh, std::memory_order_acq_rel)) {
+      return fresh;
+    }
+    delete fresh;
+    return expected;
+  }
+
+  /* clang-format off */
+  alignas(kCacheLineSize) std::atomic<size_t>      m_size{0};
+  std::array<std::atomic<chunk*>, kMaxChunks>      m_chunks;
+  /* clang-format on */
+};
+
+NS_END(multithread, rcppsw);
+
+#endif /* INCLUDE_RCPPSW_MULTITHREAD_CONCURRENT_VECTOR_HPP_ */
@@ -0,0 +1,243 @@
+/**
+ * \file mpmc_queue.hpp
+ *
+ * \copyright 2020 John Harwell, All rights reserved.
+ *
+ * This file is part of RCPPSW.
+ *
+ * RCPPSW is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * RCPPSW is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * RCPPSW.  If not, see <http://www.gnu.org/licenses/
+ */
+
+#ifndef INCLUDE_RCPPSW_MULTITHREAD_MPMC_QUEUE_HPP_
+#define INCLUDE_RCPPSW_MULTITHREAD_MPMC_QUEUE_HPP_
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "rcppsw/multithread/spin_park.hpp"
+#include "rcppsw/rcppsw.hpp"
+
+/*******************************************************************************
+ * Namespaces/Decls
+ ******************************************************************************/
+NS_START(rcppsw, multithread);
+
+/*******************************************************************************
+ * Class Definitions
+ ******************************************************************************/
+/**
+ * \class mpmc_queue
+ * \ingroup multithread
+ *
+ * \brief A bounded, lock-free multiple-producer/multiple-consumer FIFO queue
+ * (Vyukov's algorithm): a ring of slots, each with a sequence number which
+ * tells producers and consumers whether the slot is ready for them, so that
+ * each operation is a single CAS on the enqueue or dequeue position in the
+ * common case. Lock-free alternative to \ref mt_queue under contention.
+ *
+ * Elements are moved in and out, so move-only types are supported.
+ *
+ * The blocking \ref enqueue() and \ref dequeue() spin, then yield, then park
+ * (see \ref spin_park) while the queue is full/empty.
+ *
+ * \tparam T The type of the queued elements. Must be move constructible (and
+ *           move assignable for \ref try_dequeue()).
+ */
+template <typename T>
+class mpmc_queue {
+ public:
+  /**
+   * \param capacity The max # of elements in the queue. Rounded up to a power
+   * of 2.
+   */
+  explicit mpmc_queue(size_t capacity)
+      : mc_mask(pow2_ceil(std::max<size_t>(capacity, 2)) - 1),
+        m_slots(std::make_unique<slot[]>(mc_mask + 1)) {
+    for (size_t i = 0; i <= mc_mask; ++i) {
+      m_slots[i].seq.store(i, std::memory_order_relaxed);
+    } /* for(i..) */
+  }
+
+  ~mpmc_queue(void) {
+    while (try_dequeue_impl([](T&&) {})) {
+    } /* while() */
+  }
+
+  /* Not move/copy constructable/assignable by default */
+  mpmc_queue(const mpmc_queue&) = delete;
+  const mpmc_queue& operator=(const mpmc_queue&) = delete;
+  mpmc_queue(mpmc_queue&&) = delete;
+  mpmc_queue& operator=(mpmc_queue&&) = delete;
+
+  size_t capacity(void) const { return mc_mask + 1; }
+
+  /**
+   * \brief Get the # of elements in the queue. Only approximate if other
+   * threads are using the queue.
+   */
+  size_t size_approx(void) const {
+    size_t enq = m_enq_pos.load(std::memory_order_relaxed);
+    size_t deq = m_deq_pos.load(std::memory_order_relaxed);
+    return enq >= deq ? enq - deq : 0;
+  }
+
+  /**
+   * \brief Construct an element in place at the back of the queue, if there
+   * is room.
+   *
+   * \return \c TRUE if the element was enqueued, \c FALSE if the queue was
+   * full.
+   */
+  template <typename... Args>
+  bool try_emplace(Args&&... args) {
+    if (try_emplace_impl(std::forward<Args>(args)...)) {
+      m_not_empty.notify();
+      return true;
+    }
+    return false;
+  }
+
+  bool try_enqueue(const T& data) { return try_emplace(data); }
+  bool try_enqueue(T&& data) { return try_emplace(std::move(data)); }
+
+  /**
+   * \brief Move the element at the front of the queue into \p out, if there is
+   * one.
+   *
+   * \return \c TRUE if an element was dequeued, \c FALSE if the queue was
+   * empty.
+   */
+  bool try_dequeue(T& out) {
+    if (try_dequeue_impl([&](T&& elt) { out = std::move(elt); })) {
+      m_not_full.notify();
+      return true;
+    }
+    return false;
+  }
+
+  /**
+   * \brief Add an element to the queue, waiting for room if it is full.
+   */
+  void enqueue(T data) {
+    m_not_full.wait([&]() { return try_emplace_impl(std::move(data)); });
+    m_not_empty.notify();
+  }
+
+  /**
+   * \brief Get an element from the queue, waiting for one if it is empty.
+   */
+  T dequeue(void) {
+    std::optional<T> out;
+    m_not_empty.wait([&]() {
+      return try_dequeue_impl([&](T&& elt) { out.emplace(std::move(elt)); });
+    });
+    m_not_full.notify();
+    return std::move(*out);
+  }
+
+ private:
+  struct alignas(kCacheLineSize) slot {
+    std::atomic<size_t> seq{ 0 };
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+  };
+
+  static size_t pow2_ceil(size_t n) {
+    size_t p = 1;
+    while (p < n) {
+      p <<= 1;
+    } /* while() */
+    return p;
+  }
+
+  /*
+   * A slot is ready for the producer claiming position pos when its sequence
+   * number is pos, and ready for the consumer claiming position pos when its
+   * sequence number is pos + 1.
+   */
+  template <typename... Args>
+  bool try_emplace_impl(Args&&... args) {
+    size_t pos = m_enq_pos.load(std::memory_order_relaxed);
+    slot* s;
+    while (true) {
+      s = &m_slots[pos & mc_mask];
+      size_t seq = s->seq.load(std::memory_order_acquire);
+      auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+      if (0 == diff) {
+        if (m_enq_pos.compare_exchange_weak(
+                pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false; /* full */
+      } else {
+        pos = m_enq_pos.load(std::memory_order_relaxed);
+      }
+    } /* while() */
+    new (&s->storage) T(std::forward<Args>(args)...);
+    s->seq.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * \brief Claim the element at the front of the queue if there is one, and
+   * hand it to \p f(T&&) before destroying it.
+   */
+  template <typename TFunc>
+  bool try_dequeue_impl(const TFunc& f) {
+    size_t pos = m_deq_pos.load(std::memory_order_relaxed);
+    slot* s;
+    while (true) {
+      s = &m_slots[pos & mc_mask];
+      size_t seq = s->seq.load(std::memory_order_acquire);
+      auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+      if (0 == diff) {
+        if (m_deq_pos.compare_exchange_weak(
+                pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false; /* empty */
+      } else {
+        pos = m_deq_pos.load(std::memory_order_relaxed);
+      }
+    } /* while() */
+    T* elt = std::launder(reinterpret_cast<T*>(&s->storage));
+    f(std::move(*elt));
+    elt->~T();
+    s->seq.store(pos + mc_mask + 1, std::memory_order_release);
+    return true;
+  }
+
+  /* clang-format off */
+  const size_t                                     mc_mask;
+  std::unique_ptr<slot[]>                          m_slots;
+
+  /* producers and consumers each get their own cache line */
+  alignas(kCacheLineSize) std::atomic<size_t>      m_enq_pos{0};
+  alignas(kCacheLineSize) std::atomic<size_t>      m_deq_pos{0};
+  spin_park                                        m_not_empty{};
+  spin_park                                        m_not_full{};
+  /* clang-format on */
+};
+
+NS_END(multithread, rcppsw);
+
+#endif /* INCLUDE_RCPPSW_MULTITHREAD_MPMC_QUEUE_HPP_ */
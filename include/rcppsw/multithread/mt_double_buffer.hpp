@@ -0,0 +1,203 @@
+/**
+ * \file mt_double_buffer.hpp
+ *
+ * \copyright 2020 John Harwell, All rights reserved.
+ *
+ * This file is part of RCPPSW.
+ *
+ * RCPPSW is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * RCPPSW is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * RCPPSW.  If not, see <http://www.gnu.org/licenses/
+ */
+
+#ifndef INCLUDE_RCPPSW_MULTITHREAD_MT_DOUBLE_BUFFER_HPP_
+#define INCLUDE_RCPPSW_MULTITHREAD_MT_DOUBLE_BUFFER_HPP_
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <array>
+#include <atomic>
+#include <thread>
+
+#include "rcppsw/multithread/cache.hpp"
+#include "rcppsw/rcppsw.hpp"
+
+/*******************************************************************************
+ * Namespaces/Decls
+ ******************************************************************************/
+NS_START(rcppsw, multithread);
+
+/*******************************************************************************
+ * Class Definitions
+ ******************************************************************************/
+/**
+ * \class mt_double_buffer
+ * \ingroup multithread
+ *
+ * \brief Two copies of SOMETHING (usually a grid): a front buffer which any
+ * number of reader threads can read from without locking, and a back buffer
+ * which a single writer thread fills with the next timestep's values and then
+ * publishes with \ref swap().
+ *
+ * Readers pin the front buffer for the duration of a \ref read_guard, which
+ * increments a per-buffer reader count. \ref swap() atomically flips which
+ * buffer is the front, and then waits for the readers still pinning the old
+ * front to drain, so that when it returns the writer has exclusive access to
+ * the new back buffer. Readers never wait on the writer, and the writer only
+ * waits on readers which started before the swap.
+ *
+ * \tparam T The buffered type. Does not need to be copyable or assignable.
+ */
+template <typename T>
+class mt_double_buffer {
+ public:
+  /**
+   * \brief RAII handle pinning the front buffer for reading.
+   */
+  class read_guard {
+   public:
+    read_guard(const mt_double_buffer* buf, size_t idx, size_t epoch)
+        : m_buf(buf), m_idx(idx), m_epoch(epoch) {}
+    ~read_guard(void) {
+      if (nullptr != m_buf) {
+        m_buf->m_readers[m_idx].count.fetch_sub(1, std::memory_order_release);
+      }
+    }
+
+    read_guard(read_guard&& other) noexcept
+        : m_buf(other.m_buf), m_idx(other.m_idx), m_epoch(other.m_epoch) {
+      other.m_buf = nullptr;
+    }
+    read_guard(const read_guard&) = delete;
+    read_guard& operator=(const read_guard&) = delete;
+    read_guard& operator=(read_guard&&) = delete;
+
+    const T& operator*(void) const { return m_buf->m_buffers[m_idx]; }
+    const T* operator->(void) const { return &m_buf->m_buffers[m_idx]; }
+
+    /**
+     * \brief The # of swaps which had been performed when the guarded buffer
+     * was published.
+     */
+    size_t epoch(void) const { return m_epoch; }
+
+   private:
+    /* clang-format off */
+    const mt_double_buffer* m_buf;
+    size_t                  m_idx;
+    size_t                  m_epoch;
+    /* clang-format on */
+  };
+
+  /**
+   * \brief Construct both buffers with the same \p args.
+   */
+  template <typename... Args>
+  explicit mt_double_buffer(const Args&... args)
+      : m_buffers{ { T(args...), T(args...) } } {}
+
+  /* Not move/copy constructable/assignable by default */
+  mt_double_buffer(const mt_double_buffer&) = delete;
+  const mt_double_buffer& operator=(const mt_double_buffer&) = delete;
+  mt_double_buffer(mt_double_buffer&&) = delete;
+  mt_double_buffer& operator=(mt_double_buffer&&) = delete;
+
+  /**
+   * \brief Pin the current front buffer for reading. Callable from any thread;
+   * never blocks.
+   */
+  read_guard read(void) const {
+    while (true) {
+      size_t idx = m_state.load(std::memory_order_seq_cst);
+      m_readers[idx & 1].count.fetch_add(1, std::memory_order_seq_cst);
+
+      /*
+       * If a swap() happened between reading the state and announcing
+       * ourselves, the writer might not have seen us, so back off and retry
+       * with the new front.
+       */
+      if (m_state.load(std::memory_order_seq_cst) == idx) {
+        return read_guard(this, idx & 1, idx >> 1);
+      }
+      m_readers[idx & 1].count.fetch_sub(1, std::memory_order_release);
+    } /* while() */
+  }
+
+  /**
+   * \brief Get the back buffer. Writer thread only.
+   */
+  T& back(void) { return m_buffers[1 - front_idx()]; }
+
+  /**
+   * \brief Get the front buffer without pinning it. Writer thread only (the
+   * front buffer cannot change under the writer, because only the writer
+   * calls \ref swap()).
+   */
+  const T& front(void) const { return m_buffers[front_idx()]; }
+
+  /**
+   * \brief Publish the back buffer as the new front buffer, and wait for any
+   * readers of the old front buffer to finish with it. Writer thread only.
+   */
+  void swap(void) {
+    size_t old = m_state.load(std::memory_order_relaxed);
+    size_t old_idx = old & 1;
+    m_state.store((((old >> 1) + 1) << 1) | (1 - old_idx),
+                  std::memory_order_seq_cst);
+
+    /*
+     * Must be seq_cst (as are the reader's increment and re-check of the
+     * state in read()): with acquire, the load could be satisfied before the
+     * store above is visible, and miss a reader which then sees the old state
+     * on its re-check.
+     */
+    while (0 != m_readers[old_idx].count.load(std::memory_order_seq_cst)) {
+      std::this_thread::yield();
+    } /* while() */
+  }
+
+  /**
+   * \brief The # of times \ref swap() has been called.
+   */
+  size_t epoch(void) const {
+    return m_state.load(std::memory_order_acquire) >> 1;
+  }
+
+ private:
+  /**
+   * \brief Reader counts for each buffer are on separate cache lines, so that
+   * readers of the front buffer do not interfere with the writer draining the
+   * old front buffer.
+   */
+  struct alignas(kCacheLineSize) reader_count {
+    std::atomic<size_t> count{ 0 };
+  };
+
+  size_t front_idx(void) const {
+    return m_state.load(std::memory_order_acquire) & 1;
+  }
+
+  /* clang-format off */
+  std::array<T, 2>                            m_buffers;
+
+  /**
+   * \brief The index of the front buffer in the lowest bit, and the epoch in
+   * the rest, so that both can be updated with a single atomic store.
+   */
+  alignas(kCacheLineSize) std::atomic<size_t> m_state{ 0 };
+  mutable std::array<reader_count, 2>         m_readers{};
+  /* clang-format on */
+};
+
+NS_END(multithread, rcppsw);
+
+#endif /* INCLUDE_RCPPSW_MULTITHREAD_MT_DOUBLE_BUFFER_HPP_ */
@@ -24,10 +24,13 @@
 /*******************************************************************************
  * Includes
  ******************************************************************************/
+#include <atomic>
 #include <memory>
 #include <mutex>
 #include <string>
 
+#include "rcppsw/multithread/mpmc_queue.hpp"
+#include "rcppsw/multithread/spin_park.hpp"
 #include "rcppsw/patterns/fsm/base_fsm.hpp"
 #include "rcppsw/rcppsw.hpp"
 
@@ -44,25 +47,144 @@ namespace sm = patterns::fsm;
  * \class mt_fsm
  * \ingroup multithread
  *
- * \brief Extends \ref patterns::fsm::base_fsm to be threadsafe.
+ * \brief Extends \ref patterns::fsm::base_fsm to be threadsafe, in one of two
+ * ways:
+ *
+ * - \ref dispatch::ekLOCKED (default) - Injecting an event runs the state
+ *   engine on the calling thread while holding a mutex, so a slow state blocks
+ *   every other thread trying to inject an event.
+ *
+ * - \ref dispatch::ekINBOX - Injecting an event only puts it in a lock-free
+ *   inbox and never blocks. A single owner thread runs the state engine for
+ *   queued events in FIFO order via \ref drain() or \ref drain_wait(). The
+ *   inbox is unbounded by default (a lock-free list); if a capacity is given it
+ *   is a \ref mpmc_queue instead, and events injected while it is full are
+ *   dropped and counted in \ref stats(); use \ref try_inject_event() to find
+ *   out if a given event was dropped.
+ *
+ * In inbox mode, \ref inject_event() dispatches the event to the state the FSM
+ * is in when it is executed, rather than when it is injected. Only the owner
+ * thread should call \ref init(), or query the current state.
  */
 class mt_fsm : public rpfsm::base_fsm {
  public:
+  enum class dispatch {
+    ekLOCKED,
+    ekINBOX
+  };
+
+  /**
+   * \brief Inbox statistics, for tuning the inbox capacity/detecting an owner
+   * thread which cannot keep up.
+   */
+  struct inbox_stats {
+    /* clang-format off */
+    size_t n_posted;    /* # events accepted into the inbox */
+    size_t n_rejected;  /* # events dropped because the inbox was full */
+    size_t n_processed; /* # events the owner has run */
+    size_t max_depth;   /* High water mark of the # of queued events */
+    /* clang-format on */
+  };
+
   explicit mt_fsm(uint8_t max_states, uint8_t initial_state = 0)
-      : base_fsm(max_states, initial_state) {}
+      : mt_fsm(max_states, initial_state, dispatch::ekLOCKED) {}
 
-  ~mt_fsm(void) override = default;
+  /**
+   * \param mode How events injected from other threads are run.
+   * \param inbox_capacity For \ref dispatch::ekINBOX, the max # of queued
+   *                       events (0 = unbounded).
+   */
+  mt_fsm(uint8_t max_states,
+         uint8_t initial_state,
+         dispatch mode,
+         size_t inbox_capacity = 0);
+
+  ~mt_fsm(void) override;
 
   void init(void) override;
 
+  /**
+   * \brief Same as \ref base_fsm::inject_event(), but in inbox mode the event
+   * is queued for the owner thread, and the state it is sent to is decided when
+   * it is executed. If the inbox is bounded and full, the event is dropped and
+   * counted in \ref inbox_stats::n_rejected.
+   */
+  void inject_event(int signal, int type);
+  void inject_event(std::unique_ptr<sm::event_data> event) override;
+
+  /**
+   * \brief Same as \ref inject_event(), but report whether the event was
+   * accepted, so callers can apply backpressure.
+   *
+   * \return \c FALSE iff the event was dropped because the (bounded) inbox
+   * was full. Always \c TRUE in locked mode and with an unbounded inbox.
+   */
+  bool try_inject_event(int signal, int type);
+  bool try_inject_event(std::unique_ptr<sm::event_data> event);
+
+  /**
+   * \brief Run the state engine for the events currently in the inbox, in the
+   * order they were injected. Events injected during the call (including by
+   * the states being run) are left for the next call. Owner thread only.
+   *
+   * If a state throws, the exception propagates, and the events after it are
+   * kept (in order) for the next call.
+   *
+   * \return The # of events run.
+   */
+  size_t drain(void);
+
+  /**
+   * \brief Wait until the inbox is not empty (or \ref interrupt() is called),
+   * then \ref drain() it. Owner thread only.
+   */
+  size_t drain_wait(void);
+
+  /**
+   * \brief Wake up an owner blocked in \ref drain_wait(), and make all future
+   * calls to it non-blocking.
+   */
+  void interrupt(void);
+
+  dispatch mode(void) const { return mc_mode; }
+  inbox_stats stats(void) const;
+
  protected:
   void external_event(uint8_t new_state,
                       std::unique_ptr<sm::event_data> data) override;
 
  private:
-  /* clang-format on */
-  std::mutex m_mutex{};
+  struct inbox_entry {
+    uint8_t state{0};
+    /* Send to whatever the current state is at execution time */
+    bool current{false};
+    std::unique_ptr<sm::event_data> data{nullptr};
+  };
+
+  struct inbox_node {
+    inbox_entry entry;
+    inbox_node* next;
+  };
+
+  bool post(inbox_entry entry);
+  void run(inbox_entry* entry);
+  bool inbox_empty(void) const;
+
   /* clang-format off */
+  const dispatch                           mc_mode;
+  std::mutex                               m_mutex{};
+
+  std::unique_ptr<mpmc_queue<inbox_entry>> m_bounded{nullptr};
+  alignas(kCacheLineSize) std::atomic<inbox_node*> m_unbounded{nullptr};
+  std::atomic<size_t>                      m_n_posted{0};
+  std::atomic<size_t>                      m_n_rejected{0};
+  std::atomic<size_t>                      m_max_depth{0};
+  alignas(kCacheLineSize) std::atomic<size_t> m_n_processed{0};
+  /* Events taken from the unbounded inbox but not run yet (owner only) */
+  inbox_node*                              m_backlog{nullptr};
+  std::atomic<bool>                        m_interrupt{false};
+  spin_park                                m_not_empty{};
+  /* clang-format on */
 };
 
 NS_END(multithread, rcppsw);
@@ -43,7 +43,8 @@ NS_START(rcppsw, multithread);
  * \ingroup multithread
  *
  * \brief A thread-safe vector implementation. Use when you need fast access to
- *        a large contiguous chunk of memory.
+ *        a large contiguous chunk of memory. For many threads appending
+ *        concurrently, \ref concurrent_vector is much faster.
  */
 template <typename T>
 class mt_vector {
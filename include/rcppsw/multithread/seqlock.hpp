@@ -0,0 +1,175 @@
+/**
+ * \file seqlock.hpp
+ *
+ * \copyright 2020 John Harwell, All rights reserved.
+ *
+ * This file is part of RCPPSW.
+ *
+ * RCPPSW is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * RCPPSW is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * RCPPSW.  If not, see <http://www.gnu.org/licenses/
+ */
+
+#ifndef INCLUDE_RCPPSW_MULTITHREAD_SEQLOCK_HPP_
+#define INCLUDE_RCPPSW_MULTITHREAD_SEQLOCK_HPP_
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+
+#include "rcppsw/multithread/cache.hpp"
+#include "rcppsw/rcppsw.hpp"
+
+/*******************************************************************************
+ * Namespaces/Decls
+ ******************************************************************************/
+NS_START(rcppsw, multithread);
+
+/*******************************************************************************
+ * Class Definitions
+ ******************************************************************************/
+/**
+ * \class seqlock
+ * \ingroup multithread
+ *
+ * \brief A sequence lock protecting a small, trivially copyable value. Readers
+ * never write to shared memory: they copy the value out and retry if a writer
+ * was active while they were copying (detected via a sequence number which is
+ * odd while a write is in progress). Reads therefore scale with the # of
+ * cores, in contrast to \ref lockable, where every reader writes the lock
+ * word. Writers are serialized with each other by a mutex.
+ *
+ * Best for state which is read very often and written rarely (readers can
+ * starve under continuous writes), and which is small enough that copying it
+ * is cheap.
+ *
+ * \tparam T The protected type. Must be trivially copyable (but need not be
+ *           default constructible, unless the default constructor argument is
+ *           used).
+ */
+template <typename T>
+class seqlock {
+ public:
+  static_assert(std::is_trivially_copyable<T>::value,
+                "seqlock requires a trivially copyable type");
+
+  explicit seqlock(const T& init = T()) { write_words(init); }
+
+  /* Not move/copy constructable/assignable by default */
+  seqlock(const seqlock&) = delete;
+  const seqlock& operator=(const seqlock&) = delete;
+  seqlock(seqlock&&) = delete;
+  seqlock& operator=(seqlock&&) = delete;
+
+  /**
+   * \brief Get a consistent copy of the value. Never blocks writers.
+   */
+  T load(void) const {
+    while (true) {
+      size_t s0 = m_seq.load(std::memory_order_acquire);
+      if (0 == (s0 & 1)) {
+        T val = read_words();
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (m_seq.load(std::memory_order_relaxed) == s0) {
+          return val;
+        }
+      }
+      std::this_thread::yield();
+    } /* while() */
+  }
+
+  /**
+   * \brief Replace the value.
+   */
+  void store(const T& val) {
+    std::lock_guard<std::mutex> lock(m_write_mtx);
+    begin_write();
+    write_words(val);
+    end_write();
+  }
+
+  /**
+   * \brief Modify the value in place with \p f(T&), atomically with respect to
+   * other writers.
+   */
+  template <typename TFunc>
+  void update(const TFunc& f) {
+    std::lock_guard<std::mutex> lock(m_write_mtx);
+    T val = read_words();
+    f(val);
+    begin_write();
+    write_words(val);
+    end_write();
+  }
+
+  /**
+   * \brief Get the # of completed writes.
+   */
+  size_t version(void) const {
+    return m_seq.load(std::memory_order_acquire) / 2;
+  }
+
+ private:
+  /*
+   * The value is stored as an array of atomic words accessed with relaxed
+   * ordering, so that the racy copy made by readers is not a data race.
+   */
+  static constexpr size_t kWords = (sizeof(T) + sizeof(uint64_t) - 1) /
+                                   sizeof(uint64_t);
+
+  void begin_write(void) {
+    m_seq.store(m_seq.load(std::memory_order_relaxed) + 1,
+                std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+  }
+
+  void end_write(void) {
+    m_seq.store(m_seq.load(std::memory_order_relaxed) + 1,
+                std::memory_order_release);
+  }
+
+  T read_words(void) const {
+    std::array<uint64_t, kWords> buf;
+    for (size_t i = 0; i < kWords; ++i) {
+      buf[i] = m_words[i].load(std::memory_order_relaxed);
+    } /* for(i..) */
+    /* not T val, which would require T to be default constructible */
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+    std::memcpy(&storage, buf.data(), sizeof(T));
+    return *std::launder(reinterpret_cast<T*>(&storage));
+  }
+
+  void write_words(const T& val) {
+    std::array<uint64_t, kWords> buf{};
+    std::memcpy(buf.data(), &val, sizeof(T));
+    for (size_t i = 0; i < kWords; ++i) {
+      m_words[i].store(buf[i], std::memory_order_relaxed);
+    } /* for(i..) */
+  }
+
+  /* clang-format off */
+  alignas(kCacheLineSize) std::atomic<size_t>    m_seq{0};
+  std::array<std::atomic<uint64_t>, kWords>      m_words{};
+  std::mutex                                     m_write_mtx{};
+  /* clang-format on */
+};
+
+NS_END(multithread, rcppsw);
+
+#endif /* INCLUDE_RCPPSW_MULTITHREAD_SEQLOCK_HPP_ */
@@ -0,0 +1,222 @@
+/**
+ * \file snapshot.hpp
+ *
+ * \copyright 2020 John Harwell, All rights reserved.
+ *
+ * This file is part of RCPPSW.
+ *
+ * RCPPSW is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * RCPPSW is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * RCPPSW.  If not, see <http://www.gnu.org/licenses/
+ */
+
+#ifndef INCLUDE_RCPPSW_MULTITHREAD_SNAPSHOT_HPP_
+#define INCLUDE_RCPPSW_MULTITHREAD_SNAPSHOT_HPP_
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <array>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "rcppsw/multithread/cache.hpp"
+#include "rcppsw/rcppsw.hpp"
+
+/*******************************************************************************
+ * Namespaces/Decls
+ ******************************************************************************/
+NS_START(rcppsw, multithread);
+
+/*******************************************************************************
+ * Class Definitions
+ ******************************************************************************/
+/**
+ * \class snapshot
+ * \ingroup multithread
+ *
+ * \brief RCU-style (read-copy-update) holder for read-mostly shared state of
+ * any type: readers get an immutable view of the current version without
+ * locking, and writers publish a new version by building a modified copy,
+ * after which the old version is reclaimed once all readers which might still
+ * be looking at it are done.
+ *
+ * Readers announce themselves by incrementing one of several reader counters,
+ * picked by thread, each on its own cache line, so readers on different cores
+ * rarely touch the same cache line (unlike std::shared_ptr reference counts or
+ * \ref lockable). The counters are split by an epoch parity bit; a writer
+ * flips the parity after publishing and waits for the counters of the old
+ * parity to drain (the grace period) before destroying the old version.
+ *
+ * Writers are serialized with each other by a mutex, and block for the grace
+ * period, which is as long as the longest read section in progress.
+ *
+ * \tparam T The type of the state.
+ */
+template <typename T>
+class snapshot {
+ public:
+  /**
+   * \brief RAII read section, giving access to the version which was current
+   * when it was created. Keep it short: writers wait for it.
+   */
+  class read_guard {
+   public:
+    read_guard(const snapshot* snap, size_t stripe, size_t parity)
+        : m_snap(snap),
+          m_stripe(stripe),
+          m_parity(parity),
+          m_value(snap->m_current.load(std::memory_order_seq_cst)) {}
+
+    ~read_guard(void) {
+      if (nullptr != m_snap) {
+        m_snap->m_readers[m_stripe].count[m_parity].fetch_sub(
+            1, std::memory_order_release);
+      }
+    }
+
+    read_guard(read_guard&& other) noexcept
+        : m_snap(other.m_snap),
+          m_stripe(other.m_stripe),
+          m_parity(other.m_parity),
+          m_value(other.m_value) {
+      other.m_snap = nullptr;
+    }
+    read_guard(const read_guard&) = delete;
+    read_guard& operator=(const read_guard&) = delete;
+    read_guard& operator=(read_guard&&) = delete;
+
+    const T& operator*(void) const { return *m_value->value; }
+    const T* operator->(void) const { return m_value->value.get(); }
+
+    /**
+     * \brief Get a reference counted pointer to the version, which stays
+     * valid after the read section ends (for holding onto a version across a
+     * long computation, without holding up writers).
+     */
+    std::shared_ptr<const T> share(void) const { return m_value->value; }
+
+   private:
+    /* clang-format off */
+    const snapshot*       m_snap;
+    size_t                m_stripe;
+    size_t                m_parity;
+    const typename snapshot::version* m_value;
+    /* clang-format on */
+  };
+
+  explicit snapshot(std::shared_ptr<const T> init)
+      : m_current(new version{ std::move(init) }) {}
+
+  ~snapshot(void) { delete m_current.load(std::memory_order_acquire); }
+
+  /* Not move/copy constructable/assignable by default */
+  snapshot(const snapshot&) = delete;
+  const snapshot& operator=(const snapshot&) = delete;
+  snapshot(snapshot&&) = delete;
+  snapshot& operator=(snapshot&&) = delete;
+
+  /**
+   * \brief Begin a read section. Never blocks.
+   */
+  read_guard read(void) const {
+    size_t stripe = this_stripe();
+    while (true) {
+      size_t parity = m_parity.load(std::memory_order_seq_cst);
+      m_readers[stripe].count[parity].fetch_add(1, std::memory_order_seq_cst);
+
+      /*
+       * If a writer flipped the parity between reading it and announcing
+       * ourselves, it might not have seen us, so retry with the new parity.
+       */
+      if (m_parity.load(std::memory_order_seq_cst) == parity) {
+        return read_guard(this, stripe, parity);
+      }
+      m_readers[stripe].count[parity].fetch_sub(1, std::memory_order_release);
+    } /* while() */
+  }
+
+  /**
+   * \brief Get a reference counted pointer to the current version.
+   */
+  std::shared_ptr<const T> load(void) const { return read().share(); }
+
+  /**
+   * \brief Publish \p next as the current version, and reclaim the previous
+   * version after the grace period.
+   */
+  void store(std::shared_ptr<const T> next) {
+    std::lock_guard<std::mutex> lock(m_write_mtx);
+    publish(std::move(next));
+  }
+
+  /**
+   * \brief Publish a modified copy of the current version: \p f(T&) is called
+   * on a copy, which then becomes the current version. Requires \p T to be
+   * copy constructible.
+   */
+  template <typename TFunc>
+  void update(const TFunc& f) {
+    std::lock_guard<std::mutex> lock(m_write_mtx);
+    auto next = std::make_shared<T>(
+        *m_current.load(std::memory_order_acquire)->value);
+    f(*next);
+    publish(std::move(next));
+  }
+
+ private:
+  static constexpr size_t kStripes = 32;
+
+  struct version {
+    std::shared_ptr<const T> value;
+  };
+
+  struct alignas(kCacheLineSize) reader_stripe {
+    std::array<std::atomic<size_t>, 2> count{};
+  };
+
+  static size_t this_stripe(void) {
+    static thread_local size_t tl_stripe =
+        std::hash<std::thread::id>()(std::this_thread::get_id()) % kStripes;
+    return tl_stripe;
+  }
+
+  void publish(std::shared_ptr<const T> next) {
+    version* old = m_current.exchange(new version{ std::move(next) },
+                                      std::memory_order_seq_cst);
+
+    /* grace period: wait for readers which started before the exchange */
+    size_t parity = m_parity.load(std::memory_order_relaxed);
+    m_parity.store(1 - parity, std::memory_order_seq_cst);
+    for (auto& s : m_readers) {
+      /* seq_cst, so it cannot be satisfied before the parity flip is visible */
+      while (0 != s.count[parity].load(std::memory_order_seq_cst)) {
+        std::this_thread::yield();
+      } /* while() */
+    } /* for(&s..) */
+    delete old;
+  }
+
+  /* clang-format off */
+  std::atomic<version*>                       m_current;
+  alignas(kCacheLineSize) std::atomic<size_t> m_parity{0};
+  mutable std::array<reader_stripe, kStripes> m_readers{};
+  std::mutex                                  m_write_mtx{};
+  /* clang-format on */
+};
+
+NS_END(multithread, rcppsw);
+
+#endif /* INCLUDE_RCPPSW_MULTITHREAD_SNAPSHOT_HPP_ */
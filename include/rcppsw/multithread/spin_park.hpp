@@ -0,0 +1,152 @@
+/**
+ * \file spin_park.hpp
+ *
+ * \copyright 2020 John Harwell, All rights reserved.
+ *
+ * This file is part of RCPPSW.
+ *
+ * RCPPSW is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * RCPPSW is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * RCPPSW.  If not, see <http://www.gnu.org/licenses/
+ */
+
+#ifndef INCLUDE_RCPPSW_MULTITHREAD_SPIN_PARK_HPP_
+#define INCLUDE_RCPPSW_MULTITHREAD_SPIN_PARK_HPP_
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "rcppsw/multithread/cache.hpp"
+#include "rcppsw/rcppsw.hpp"
+
+/*******************************************************************************
+ * Namespaces/Decls
+ ******************************************************************************/
+NS_START(rcppsw, multithread);
+
+/*******************************************************************************
+ * Class Definitions
+ ******************************************************************************/
+/**
+ * \class spin_park
+ * \ingroup multithread
+ *
+ * \brief Waiting policy for the blocking operations of lock-free containers:
+ * spin on the non-blocking operation for a while, then yield the CPU for a
+ * while, and finally park the thread on a condition variable until another
+ * thread calls \ref notify().
+ *
+ * \ref notify() only touches the mutex if some thread is actually parked, so
+ * the non-blocking fast path of the container stays lock-free. It does issue a
+ * seq_cst fence before checking for parked threads, which is what guarantees
+ * that a notify() racing with a thread which is just parking is never missed.
+ * Parked threads therefore sleep until they are notified, rather than polling.
+ */
+class spin_park {
+ public:
+  /**
+   * \brief # of attempts before starting to yield.
+   */
+  static constexpr size_t kSpinCount = 64;
+
+  /**
+   * \brief # of attempts (with yields in between) before parking.
+   */
+  static constexpr size_t kYieldCount = 16;
+
+  spin_park(void) = default;
+
+  /* Not move/copy constructable/assignable by default */
+  spin_park(const spin_park&) = delete;
+  const spin_park& operator=(const spin_park&) = delete;
+  spin_park(spin_park&&) = delete;
+  spin_park& operator=(spin_park&&) = delete;
+
+  /**
+   * \brief Call \p try_op() until it returns \c TRUE, spinning, then yielding,
+   * then parking between attempts.
+   */
+  template <typename TFunc>
+  void wait(const TFunc& try_op) {
+    for (size_t i = 0; i < kSpinCount; ++i) {
+      if (try_op()) {
+        return;
+      }
+    } /* for(i..) */
+
+    for (size_t i = 0; i < kYieldCount; ++i) {
+      std::this_thread::yield();
+      if (try_op()) {
+        return;
+      }
+    } /* for(i..) */
+
+    m_parked.fetch_add(1, std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    {
+      std::unique_lock<std::mutex> lock(m_mtx);
+      while (!try_op()) {
+        m_cv.wait(lock);
+      } /* while() */
+    }
+    m_parked.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  /**
+   * \brief Wake one parked thread (if there are any) so it retries its
+   * operation. Should be called after every operation which might let a
+   * waiting thread proceed.
+   */
+  void notify(void) {
+    if (any_parked()) {
+      { std::lock_guard<std::mutex> lock(m_mtx); }
+      m_cv.notify_one();
+    }
+  }
+
+  /**
+   * \brief Wake all parked threads so they retry their operation, e.g. on
+   * shutdown.
+   */
+  void notify_all(void) {
+    if (any_parked()) {
+      { std::lock_guard<std::mutex> lock(m_mtx); }
+      m_cv.notify_all();
+    }
+  }
+
+ private:
+  bool any_parked(void) const {
+    /*
+     * Pairs with the increment of the parked count in wait(): either we see
+     * the parked thread, or it sees the effects of our operation when it
+     * retries under the lock. Taking the lock before notifying closes the
+     * window between its last retry and its wait on the condition variable.
+     */
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    return 0 != m_parked.load(std::memory_order_relaxed);
+  }
+
+  /* clang-format off */
+  std::atomic<size_t>     m_parked{0};
+  std::mutex              m_mtx{};
+  std::condition_variable m_cv{};
+  /* clang-format on */
+};
+
+NS_END(multithread, rcppsw);
+
+#endif /* INCLUDE_RCPPSW_MULTITHREAD_SPIN_PARK_HPP_ */
@@ -0,0 +1,328 @@
+/**
+ * \file spsc_ring.hpp
+ *
+ * \copyright 2020 John Harwell, All rights reserved.
+ *
+ * This file is part of RCPPSW.
+ *
+ * RCPPSW is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * RCPPSW is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * RCPPSW.  If not, see <http://www.gnu.org/licenses/
+ */
+
+#ifndef INCLUDE_RCPPSW_MULTITHREAD_SPSC_RING_HPP_
+#define INCLUDE_RCPPSW_MULTITHREAD_SPSC_RING_HPP_
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "rcppsw/multithread/spin_park.hpp"
+#include "rcppsw/multithread/threadable.hpp"
+#include "rcppsw/rcppsw.hpp"
+
+/*******************************************************************************
+ * Namespaces/Decls
+ ******************************************************************************/
+NS_START(rcppsw, multithread);
+
+/*******************************************************************************
+ * Class Definitions
+ ******************************************************************************/
+/**
+ * \class spsc_ring
+ * \ingroup multithread
+ *
+ * \brief A bounded, lock-free, single-producer/single-consumer FIFO ring
+ * buffer. Cheaper than \ref mpmc_queue when there is exactly one thread on
+ * each end: no CAS, and each side only reads the other side's position when
+ * its cached copy says the ring is full/empty.
+ *
+ * The batch operations \ref push_n() and \ref pop_n()/\ref consume() publish
+ * or retire a whole batch with a single atomic store (and a single wakeup of
+ * the other side).
+ *
+ * The non-blocking operations only take a lock to wake the other side if it is
+ * parked in a blocking operation; otherwise the cost is a fence and a relaxed
+ * load of its parked count (see \ref spin_park::notify()), which the batch
+ * operations pay once per batch.
+ *
+ * \tparam T The type of the elements.
+ * \tparam N The capacity of the ring. Must be a power of 2.
+ */
+template <typename T, size_t N>
+class spsc_ring {
+ public:
+  static_assert(N > 1 && 0 == (N & (N - 1)), "Capacity must be a power of 2");
+
+  spsc_ring(void) : m_slots(std::make_unique<storage_type[]>(N)) {}
+
+  ~spsc_ring(void) {
+    consume([](T&) {}, N);
+  }
+
+  /* Not move/copy constructable/assignable by default */
+  spsc_ring(const spsc_ring&) = delete;
+  const spsc_ring& operator=(const spsc_ring&) = delete;
+  spsc_ring(spsc_ring&&) = delete;
+  spsc_ring& operator=(spsc_ring&&) = delete;
+
+  static constexpr size_t capacity(void) { return N; }
+
+  /**
+   * \brief Get the # of elements in the ring. Exact from either of the two
+   * threads using the ring if the other one is idle, approximate otherwise.
+   */
+  size_t size_approx(void) const {
+    /*
+     * Head first: the tail never falls behind the head, so a tail read after
+     * it can't be less than it and the difference can't wrap. The head can be
+     * stale by then, hence the clamp.
+     */
+    size_t head = m_cons.head.load(std::memory_order_acquire);
+    size_t tail = m_prod.tail.load(std::memory_order_acquire);
+    return std::min(tail - head, N);
+  }
+
+  /*****************************************************************************
+   * Producer Side
+   ****************************************************************************/
+  /**
+   * \brief Construct an element in place at the back of the ring, if there is
+   * room.
+   */
+  template <typename... Args>
+  bool try_emplace(Args&&... args) {
+    size_t tail = m_prod.tail.load(std::memory_order_relaxed);
+    if (0 == free_slots(tail, 1)) {
+      return false;
+    }
+    new (slot(tail)) T(std::forward<Args>(args)...);
+    m_prod.tail.store(tail + 1, std::memory_order_release);
+    m_not_empty.notify();
+    return true;
+  }
+
+  bool try_push(const T& data) { return try_emplace(data); }
+  bool try_push(T&& data) { return try_emplace(std::move(data)); }
+
+  /**
+   * \brief Add an element to the back of the ring, waiting for room if it is
+   * full.
+   */
+  template <typename... Args>
+  void emplace(Args&&... args) {
+    m_not_full.wait([&]() {
+      return 0 != free_slots(m_prod.tail.load(std::memory_order_relaxed), 1);
+    });
+    try_emplace(std::forward<Args>(args)...);
+  }
+
+  /**
+   * \brief Move up to \p n elements starting at \p first into the ring.
+   *
+   * \return The # of elements pushed, which is less than \p n if the ring
+   * filled up.
+   */
+  template <typename TInputIter>
+  size_t push_n(TInputIter first, size_t n) {
+    size_t tail = m_prod.tail.load(std::memory_order_relaxed);
+    size_t count = std::min(n, free_slots(tail, n));
+    for (size_t i = 0; i < count; ++i, ++first) {
+      new (slot(tail + i)) T(std::move(*first));
+    } /* for(i..) */
+    if (count > 0) {
+      m_prod.tail.store(tail + count, std::memory_order_release);
+      m_not_empty.notify();
+    }
+    return count;
+  }
+
+  /*****************************************************************************
+   * Consumer Side
+   ****************************************************************************/
+  /**
+   * \brief Call \p f(T&) on up to \p max elements at the front of the ring, in
+   * place, and then remove them.
+   *
+   * \return The # of elements consumed.
+   */
+  template <typename TFunc>
+  size_t consume(const TFunc& f, size_t max) {
+    size_t head = m_cons.head.load(std::memory_order_relaxed);
+    size_t count = std::min(max, used_slots(head, max));
+    for (size_t i = 0; i < count; ++i) {
+      T* elt = slot(head + i);
+      f(*elt);
+      elt->~T();
+    } /* for(i..) */
+    if (count > 0) {
+      m_cons.head.store(head + count, std::memory_order_release);
+      m_not_full.notify();
+    }
+    return count;
+  }
+
+  /**
+   * \brief Move up to \p max elements from the front of the ring into \p out.
+   *
+   * \return The # of elements popped.
+   */
+  template <typename TOutputIter>
+  size_t pop_n(TOutputIter out, size_t max) {
+    return consume([&](T& elt) { *out++ = std::move(elt); }, max);
+  }
+
+  /**
+   * \brief Move the element at the front of the ring into \p out, if there is
+   * one.
+   */
+  bool try_pop(T& out) { return 1 == pop_n(&out, 1); }
+
+  /**
+   * \brief Same as \ref consume(), but wait until there is at least one
+   * element, or until \ref interrupt() is called.
+   *
+   * \return The # of elements consumed (0 only if interrupted).
+   */
+  template <typename TFunc>
+  size_t wait_consume(const TFunc& f, size_t max) {
+    m_not_empty.wait([&]() {
+      return m_interrupt.load(std::memory_order_acquire) ||
+             0 != used_slots(m_cons.head.load(std::memory_order_relaxed), 1);
+    });
+    return consume(f, max);
+  }
+
+  /**
+   * \brief Wake up a consumer blocked in \ref wait_consume(), and make all
+   * future calls to it non-blocking.
+   */
+  void interrupt(void) {
+    m_interrupt.store(true, std::memory_order_release);
+    m_not_empty.notify_all();
+  }
+
+ private:
+  using storage_type = typename std::aligned_storage<sizeof(T), alignof(T)>::type;
+
+  /*
+   * Each side's position lives on its own cache line, together with its cached
+   * copy of the other side's position, which only it touches.
+   */
+  struct alignas(kCacheLineSize) producer_data {
+    std::atomic<size_t> tail{ 0 };
+    size_t head_cache{ 0 };
+  };
+  struct alignas(kCacheLineSize) consumer_data {
+    std::atomic<size_t> head{ 0 };
+    size_t tail_cache{ 0 };
+  };
+
+  T* slot(size_t pos) const {
+    return std::launder(reinterpret_cast<T*>(&m_slots[pos & (N - 1)]));
+  }
+
+  /**
+   * \brief Get the # of free slots as seen by the producer, only reloading the
+   * consumer's position if there are fewer than \p wanted according to the
+   * cached copy.
+   */
+  size_t free_slots(size_t tail, size_t wanted) {
+    size_t n = N - (tail - m_prod.head_cache);
+    if (n < wanted) {
+      m_prod.head_cache = m_cons.head.load(std::memory_order_acquire);
+      n = N - (tail - m_prod.head_cache);
+    }
+    return n;
+  }
+
+  /**
+   * \brief Get the # of used slots as seen by the consumer; see \ref
+   * free_slots().
+   */
+  size_t used_slots(size_t head, size_t wanted) {
+    size_t n = m_cons.tail_cache - head;
+    if (n < wanted) {
+      m_cons.tail_cache = m_prod.tail.load(std::memory_order_acquire);
+      n = m_cons.tail_cache - head;
+    }
+    return n;
+  }
+
+  /* clang-format off */
+  std::unique_ptr<storage_type[]> m_slots;
+  producer_data                   m_prod{};
+  consumer_data                   m_cons{};
+  std::atomic<bool>               m_interrupt{false};
+  spin_park                       m_not_empty{};
+  spin_park                       m_not_full{};
+  /* clang-format on */
+};
+
+/**
+ * \class spsc_ring_drainer
+ * \ingroup multithread
+ *
+ * \brief A \ref threadable consumer for a \ref spsc_ring: the thread sleeps
+ * until there is data in the ring, and then hands everything available (up to
+ * the batch size) to the handler in a single wakeup. Calling \ref term() wakes
+ * the thread up so it can exit.
+ */
+template <typename T, size_t N>
+class spsc_ring_drainer : public threadable {
+ public:
+  using handler_type = std::function<void(T&)>;
+
+  /**
+   * \param ring The ring to drain.
+   * \param handler Called on each element, in place.
+   * \param batch_size Max # of elements handled per wakeup.
+   */
+  spsc_ring_drainer(spsc_ring<T, N>* ring,
+                    handler_type handler,
+                    size_t batch_size = N)
+      : m_ring(ring), m_handler(std::move(handler)), mc_batch_size(batch_size) {}
+
+  void* thread_main(void*) override {
+    while (!terminated()) {
+      m_ring->wait_consume(m_handler, mc_batch_size);
+    } /* while() */
+
+    /* finish what's left */
+    while (0 != m_ring->consume(m_handler, mc_batch_size)) {
+    } /* while() */
+    return nullptr;
+  }
+
+  void term(void) override {
+    threadable::term();
+    m_ring->interrupt();
+  }
+
+ private:
+  /* clang-format off */
+  spsc_ring<T, N>* m_ring;
+  handler_type     m_handler;
+  const size_t     mc_batch_size;
+  /* clang-format on */
+};
+
+NS_END(multithread, rcppsw);
+
+#endif /* INCLUDE_RCPPSW_MULTITHREAD_SPSC_RING_HPP_ */
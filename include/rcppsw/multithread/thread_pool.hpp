@@ -0,0 +1,267 @@
+/**
+ * \file thread_pool.hpp
+ *
+ * \copyright 2020 John Harwell, All rights reserved.
+ *
+ * This file is part of RCPPSW.
+ *
+ * RCPPSW is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * RCPPSW is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * RCPPSW.  If not, see <http://www.gnu.org/licenses/
+ */
+
+#ifndef INCLUDE_RCPPSW_MULTITHREAD_THREAD_POOL_HPP_
+#define INCLUDE_RCPPSW_MULTITHREAD_THREAD_POOL_HPP_
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "rcppsw/er/client.hpp"
+#include "rcppsw/multithread/spin_park.hpp"
+#include "rcppsw/multithread/threadable.hpp"
+#include "rcppsw/rcppsw.hpp"
+
+/*******************************************************************************
+ * Namespaces/Decls
+ ******************************************************************************/
+NS_START(rcppsw, multithread);
+
+/*******************************************************************************
+ * Class Definitions
+ ******************************************************************************/
+/**
+ * \class thread_pool
+ * \ingroup multithread
+ *
+ * \brief A fixed size pool of worker threads (each a \ref threadable) with work
+ * stealing. Each worker has its own task deque: tasks submitted from a worker
+ * go on the back of its own deque, which it pops from (LIFO, for cache
+ * locality), and idle workers steal from the front of other workers' deques
+ * (FIFO, so they take the oldest/biggest pieces of work). Tasks submitted from
+ * outside the pool are distributed round-robin. Idle workers spin, then park
+ * (see \ref spin_park).
+ *
+ * Each deque is protected by its own mutex, which is only contended when a
+ * worker is being stolen from.
+ *
+ * Once \ref term() has been called, the pool rejects new work, including work
+ * submitted by tasks which are still running: \ref submit() does not run the
+ * call, and \ref parallel_for() runs all chunks on the calling thread.
+ */
+class thread_pool : public er::client<thread_pool> {
+ public:
+  using task_type = std::function<void(void)>;
+
+  /**
+   * \param n_threads The # of worker threads.
+   * \param pin If \c TRUE, pin worker i to the i-th core (mod the # of
+   *            cores) which the process is allowed to run on, per
+   *            sched_getaffinity(). A worker which cannot be pinned is
+   *            reported, and runs unpinned.
+   *
+   * A worker thread which cannot be started fails an ER_ASSERT. Without
+   * asserts, the pool runs with the workers started before it (see \ref
+   * n_threads()), and if there are none it is closed, as if \ref term() had
+   * been called.
+   */
+  explicit thread_pool(size_t n_threads, bool pin = false);
+
+  /**
+   * \brief Calls \ref term().
+   */
+  ~thread_pool(void);
+
+  /* Not move/copy constructable/assignable by default */
+  thread_pool(const thread_pool&) = delete;
+  const thread_pool& operator=(const thread_pool&) = delete;
+  thread_pool(thread_pool&&) = delete;
+  thread_pool& operator=(thread_pool&&) = delete;
+
+  size_t n_threads(void) const { return m_n_started; }
+
+  /**
+   * \brief Run \p f(args...) on the pool.
+   *
+   * \return A future for the result of the call (or the exception it threw).
+   * If the pool has been terminated the call is not run, so the future's
+   * promise is broken: get() throws std::future_error with
+   * std::future_errc::broken_promise.
+   */
+  template <typename TFunc, typename... Args>
+  auto submit(TFunc&& f, Args&&... args)
+      -> std::future<typename std::invoke_result<TFunc, Args...>::type> {
+    using result_type = typename std::invoke_result<TFunc, Args...>::type;
+
+    /* std::function must be copyable, and packaged_task is not */
+    auto task = std::make_shared<std::packaged_task<result_type(void)>>(
+        std::bind(std::forward<TFunc>(f), std::forward<Args>(args)...));
+    auto future = task->get_future();
+
+    /* if rejected, the task is destroyed without being run */
+    push([task]() { (*task)(); });
+    return future;
+  }
+
+  /**
+   * \brief Call \p f(i) for each i in [\p begin, \p end), splitting the range
+   * into chunks of \p grain indices which are run on the pool. The calling
+   * thread runs pool tasks while it waits, so this can safely be called from
+   * within a pool task.
+   *
+   * If any call to \p f throws, the first exception is rethrown after all
+   * chunks have finished.
+   */
+  template <typename TFunc>
+  void parallel_for(size_t begin, size_t end, size_t grain, const TFunc& f) {
+    if (begin >= end) {
+      return;
+    }
+    grain = std::max<size_t>(grain, 1);
+    size_t n_chunks = (end - begin + grain - 1) / grain;
+    std::atomic<size_t> remaining(n_chunks);
+    std::exception_ptr error;
+    std::mutex error_mtx;
+
+    for (size_t c = 0; c < n_chunks; ++c) {
+      size_t start = begin + c * grain;
+      size_t stop = std::min(end, start + grain);
+      auto chunk = [&, start, stop]() {
+        try {
+          for (size_t i = start; i < stop; ++i) {
+            f(i);
+          } /* for(i..) */
+        } catch (...) {
+          std::lock_guard<std::mutex> lock(error_mtx);
+          if (!error) {
+            error = std::current_exception();
+          }
+        }
+        remaining.fetch_sub(1, std::memory_order_acq_rel);
+      };
+      if (!push(chunk)) {
+        /* the pool has been terminated, so do it ourselves */
+        chunk();
+      }
+    } /* for(c..) */
+
+    while (0 != remaining.load(std::memory_order_acquire)) {
+      if (!run_one()) {
+        std::this_thread::yield();
+      }
+    } /* while() */
+
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+
+  /**
+   * \brief Stop accepting work, wait for in-progress submissions to finish
+   * queueing, let the workers finish all queued tasks, and join them.
+   * Idempotent.
+   */
+  void term(void);
+
+ private:
+  /**
+   * \brief A worker thread and its task deque.
+   */
+  class worker : public threadable {
+   public:
+    worker(thread_pool* pool, size_t id) : m_pool(pool), mc_id(id) {}
+
+    void* thread_main(void* arg) override;
+
+    /**
+     * \brief Pop the newest task (owner side).
+     */
+    bool pop(task_type* task);
+
+    /**
+     * \brief Pop the oldest task (thief side).
+     */
+    bool steal(task_type* task);
+
+    void push(task_type task);
+
+    /**
+     * \brief Bind the (started) worker thread to \p core.
+     */
+    status_t pin(size_t core);
+
+   private:
+    /* clang-format off */
+    thread_pool*          m_pool;
+    const size_t          mc_id;
+    std::mutex            m_mtx{};
+    std::deque<task_type> m_tasks{};
+    /* clang-format on */
+  };
+
+  /**
+   * \brief Queue a task on the current worker's deque if called from a worker
+   * of this pool, or round-robin otherwise.
+   *
+   * \return \c FALSE if the task was rejected because \ref term() has been
+   * called.
+   */
+  bool push(task_type task);
+
+  /**
+   * \brief Find a task for worker \p self (own deque first, then stealing);
+   * \p self can be -1 for threads outside the pool.
+   */
+  bool find_task(int self, task_type* task);
+
+  /**
+   * \brief Run one queued task on the calling thread, if there is one.
+   */
+  bool run_one(void);
+
+  /**
+   * \brief Get the index of the worker of this pool the calling thread is, or
+   * -1.
+   */
+  int current_worker(void) const;
+
+  /* clang-format off */
+  std::vector<std::unique_ptr<worker>> m_workers{};
+  std::atomic<size_t>                  m_next{0};
+  size_t                               m_n_started{0};
+
+  /*
+   * Set by term() to reject new work, and then (once the in-progress calls to
+   * push() have finished) to tell the workers to exit when idle.
+   */
+  std::atomic<bool>                    m_closed{false};
+  std::atomic<size_t>                  m_n_pushing{0};
+  std::atomic<bool>                    m_stop{false};
+  std::atomic<bool>                    m_joined{false};
+  spin_park                            m_idle{};
+  /* clang-format on */
+};
+
+NS_END(multithread, rcppsw);
+
+#endif /* INCLUDE_RCPPSW_MULTITHREAD_THREAD_POOL_HPP_ */
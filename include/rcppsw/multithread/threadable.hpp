@@ -27,6 +27,9 @@
 #include <pthread.h>
 #include <sys/syscall.h>
 #include <sys/types.h>
+#include <unistd.h>
+
+#include <atomic>
 
 #include "rcppsw/rcppsw.hpp"
 
@@ -85,7 +88,7 @@ class threadable {
   /**
    * \brief Check if a thread object has been told to terminate elsewhere.
    */
-  bool terminated(void) const { return m_thread_run; }
+  bool terminated(void) const { return !m_thread_run; }
 
   /**
    * \brief Exit a thread from within the thread itself.
@@ -124,7 +127,7 @@ class threadable {
   } /* entry_point() */
 
   /* clancg-format off */
-  bool m_thread_run{ false };
+  std::atomic<bool> m_thread_run{ false };
   pthread_t m_thread{};
   void* m_arg{ nullptr };
   /* clancg-format on */
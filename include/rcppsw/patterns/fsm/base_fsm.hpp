@@ -125,9 +125,10 @@ class base_fsm : public er::client<base_fsm> {
    * \brief Injects the signal of the specified type from the event argument
    * into the state machine. This variant of inject_event() is provided for use
    * with \ref event_data_hold(), to avoid the event data overwrite which occurs
-   * with the other version.
+   * with the other version. Virtual so that derived FSMs which do not run
+   * events on the calling thread can decide when the current state is read.
    */
-  void inject_event(std::unique_ptr<event_data> event);
+  virtual void inject_event(std::unique_ptr<event_data> event);
 
   /**
    * \brief Initialize/reset the state machine.
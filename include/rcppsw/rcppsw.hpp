@@ -131,8 +131,9 @@ namespace config {}
 
 /**
  * \brief Data structures: 2D/3D lattice grids, 2D/3D discretizing grids to
- * overlay onto continuous space, Poisson queue, rtree for 2D space,
- * heterogeneous stacked 2D grid, type map for using in C++ quasi-reflection.
+ * overlay onto continuous space, Poisson queue, rtree and spatial hash for 2D
+ * space, heterogeneous stacked 2D grid, type map for using in C++
+ * quasi-reflection.
  */
 namespace ds {}
 
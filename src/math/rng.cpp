@@ -68,6 +68,13 @@ double rng::exponential(double lambda) {
   return dist(this->impl->engine);
 } /* exponential() */
 
+void rng::exponential(double lambda, double* out, size_t n) {
+  std::exponential_distribution<double> dist(lambda);
+  for (size_t i = 0; i < n; ++i) {
+    out[i] = dist(this->impl->engine);
+  } /* for(i..) */
+} /* exponential() */
+
 bool rng::bernoulli(double p) {
   std::bernoulli_distribution dist(p);
   return dist(this->impl->engine);
@@ -0,0 +1,85 @@
+/**
+ * \file process_pool.cpp
+ *
+ * \copyright 2020 John Harwell, All rights reserved.
+ *
+ * This file is part of RCPPSW.
+ *
+ * RCPPSW is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * RCPPSW is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * RCPPSW.  If not, see <http://www.gnu.org/licenses/
+ */
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "rcppsw/multiprocess/process_pool.hpp"
+
+#include <sched.h>
+
+#include <fstream>
+#include <string>
+
+/*******************************************************************************
+ * Namespaces/Decls
+ ******************************************************************************/
+NS_START(rcppsw, multiprocess);
+
+/*******************************************************************************
+ * Non-Member Functions
+ ******************************************************************************/
+std::vector<int> cores_across_sockets(size_t n) {
+  /* only the cores this process may run on (cgroups, taskset, etc.) */
+  cpu_set_t allowed;
+  CPU_ZERO(&allowed);
+  if (0 != sched_getaffinity(0, sizeof(allowed), &allowed)) {
+    return std::vector<int>(n, -1);
+  }
+
+  /* socket ID -> cores on that socket */
+  std::map<int, std::vector<int>> sockets;
+  for (int core = 0; core < CPU_SETSIZE; ++core) {
+    if (!CPU_ISSET(static_cast<size_t>(core), &allowed)) {
+      continue;
+    }
+    std::ifstream in("/sys/devices/system/cpu/cpu" + std::to_string(core) +
+                     "/topology/physical_package_id");
+    int socket = 0;
+    if (!(in >> socket)) {
+      socket = 0;
+    }
+    sockets[socket].push_back(core);
+  } /* for(core..) */
+  if (sockets.empty()) {
+    return std::vector<int>(n, -1);
+  }
+
+  std::vector<std::vector<int>*> order;
+  for (auto& s : sockets) {
+    order.push_back(&s.second);
+  } /* for(&s..) */
+
+  std::vector<int> cores;
+  for (size_t i = 0; i < n; ++i) {
+    const std::vector<int>& socket = *order[i % order.size()];
+    cores.push_back(socket[(i / order.size()) % socket.size()]);
+  } /* for(i..) */
+  return cores;
+} /* cores_across_sockets() */
+
+bool pin_to_core(int core) {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(static_cast<size_t>(core), &set);
+  return 0 == sched_setaffinity(0, sizeof(set), &set);
+} /* pin_to_core() */
+
+NS_END(multiprocess, rcppsw);
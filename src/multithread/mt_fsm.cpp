@@ -28,20 +28,180 @@
  ******************************************************************************/
 NS_START(rcppsw, multithread);
 
+/*******************************************************************************
+ * Constructors/Destructors
+ ******************************************************************************/
+mt_fsm::mt_fsm(uint8_t max_states,
+               uint8_t initial_state,
+               dispatch mode,
+               size_t inbox_capacity)
+    : base_fsm(max_states, initial_state), mc_mode(mode) {
+  if (dispatch::ekINBOX == mc_mode && inbox_capacity > 0) {
+    m_bounded = std::make_unique<mpmc_queue<inbox_entry>>(inbox_capacity);
+  }
+}
+
+mt_fsm::~mt_fsm(void) {
+  for (inbox_node* node :
+       { m_unbounded.exchange(nullptr, std::memory_order_acquire), m_backlog }) {
+    while (nullptr != node) {
+      inbox_node* next = node->next;
+      delete node;
+      node = next;
+    } /* while() */
+  } /* for(node..) */
+}
+
 /*******************************************************************************
  * Member Functions
  ******************************************************************************/
 void mt_fsm::external_event(uint8_t new_state,
                             std::unique_ptr<sm::event_data> data) {
+  if (dispatch::ekINBOX == mc_mode) {
+    post({ new_state, false, std::move(data) });
+    return;
+  }
   m_mutex.lock();
   base_fsm::external_event(new_state, std::move(data));
   m_mutex.unlock();
 } /* external_event() */
 
 void mt_fsm::init(void) {
+  if (dispatch::ekINBOX == mc_mode) {
+    base_fsm::init();
+    return;
+  }
   m_mutex.lock();
   base_fsm::init();
   m_mutex.unlock();
 } /* init() */
 
+void mt_fsm::inject_event(int signal, int type) {
+  inject_event(std::make_unique<sm::event_data>(signal, type));
+} /* inject_event() */
+
+void mt_fsm::inject_event(std::unique_ptr<sm::event_data> event) {
+  try_inject_event(std::move(event));
+} /* inject_event() */
+
+bool mt_fsm::try_inject_event(int signal, int type) {
+  return try_inject_event(std::make_unique<sm::event_data>(signal, type));
+} /* try_inject_event() */
+
+bool mt_fsm::try_inject_event(std::unique_ptr<sm::event_data> event) {
+  if (dispatch::ekINBOX == mc_mode) {
+    return post({ 0, true, std::move(event) });
+  }
+  base_fsm::inject_event(std::move(event));
+  return true;
+} /* try_inject_event() */
+
+bool mt_fsm::post(inbox_entry entry) {
+  /*
+   * Counted before the enqueue, so that the owner can never have run more
+   * events than have been counted as posted. The depth below still needs to be
+   * clamped, as events posted after this one may already have been run.
+   */
+  size_t posted = m_n_posted.fetch_add(1, std::memory_order_relaxed) + 1;
+  if (nullptr != m_bounded) {
+    if (!m_bounded->try_enqueue(std::move(entry))) {
+      m_n_posted.fetch_sub(1, std::memory_order_relaxed);
+      m_n_rejected.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+  } else {
+    /* LIFO push; the owner reverses each batch it takes */
+    auto* node = new inbox_node{ std::move(entry), nullptr };
+    node->next = m_unbounded.load(std::memory_order_relaxed);
+    while (!m_unbounded.compare_exchange_weak(node->next,
+                                              node,
+                                              std::memory_order_release,
+                                              std::memory_order_relaxed)) {
+    } /* while() */
+  }
+  size_t processed = m_n_processed.load(std::memory_order_relaxed);
+  size_t depth = posted > processed ? posted - processed : 0;
+  size_t max = m_max_depth.load(std::memory_order_relaxed);
+  while (depth > max && !m_max_depth.compare_exchange_weak(
+                            max, depth, std::memory_order_relaxed)) {
+  } /* while() */
+  m_not_empty.notify();
+  return true;
+} /* post() */
+
+void mt_fsm::run(inbox_entry* entry) {
+  base_fsm::external_event(entry->current ? current_state() : entry->state,
+                           std::move(entry->data));
+  m_n_processed.fetch_add(1, std::memory_order_release);
+} /* run() */
+
+size_t mt_fsm::drain(void) {
+  size_t n = 0;
+  if (nullptr != m_bounded) {
+    size_t max = m_bounded->capacity();
+    inbox_entry entry;
+    while (n < max && m_bounded->try_dequeue(entry)) {
+      run(&entry);
+      ++n;
+    } /* while() */
+    return n;
+  }
+
+  /*
+   * Events left over from a previous call in which a state threw go first;
+   * otherwise take everything queued so far, oldest first.
+   */
+  if (nullptr == m_backlog) {
+    inbox_node* batch =
+        m_unbounded.exchange(nullptr, std::memory_order_acquire);
+    while (nullptr != batch) {
+      inbox_node* next = batch->next;
+      batch->next = m_backlog;
+      m_backlog = batch;
+      batch = next;
+    } /* while() */
+  }
+
+  /*
+   * Each node is owned by a unique_ptr while it runs, and the rest stay in the
+   * backlog, so nothing leaks if a state throws.
+   */
+  while (nullptr != m_backlog) {
+    std::unique_ptr<inbox_node> node(m_backlog);
+    m_backlog = node->next;
+    run(&node->entry);
+    ++n;
+  } /* while() */
+  return n;
+} /* drain() */
+
+size_t mt_fsm::drain_wait(void) {
+  m_not_empty.wait([&]() {
+    return m_interrupt.load(std::memory_order_acquire) || !inbox_empty();
+  });
+  return drain();
+} /* drain_wait() */
+
+void mt_fsm::interrupt(void) {
+  m_interrupt.store(true, std::memory_order_release);
+  m_not_empty.notify_all();
+} /* interrupt() */
+
+bool mt_fsm::inbox_empty(void) const {
+  if (nullptr != m_bounded) {
+    return 0 == m_bounded->size_approx();
+  }
+  return nullptr == m_backlog &&
+         nullptr == m_unbounded.load(std::memory_order_acquire);
+} /* inbox_empty() */
+
+mt_fsm::inbox_stats mt_fsm::stats(void) const {
+  /* processed first, so that it is not read as larger than posted */
+  size_t processed = m_n_processed.load(std::memory_order_acquire);
+  return { m_n_posted.load(std::memory_order_relaxed),
+           m_n_rejected.load(std::memory_order_relaxed),
+           processed,
+           m_max_depth.load(std::memory_order_relaxed) };
+} /* stats() */
+
 NS_END(multithread, rcppsw);
@@ -0,0 +1,229 @@
+/**
+ * \file thread_pool.cpp
+ *
+ * \copyright 2020 John Harwell, All rights reserved.
+ *
+ * This file is part of RCPPSW.
+ *
+ * RCPPSW is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * RCPPSW is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * RCPPSW.  If not, see <http://www.gnu.org/licenses/
+ */
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "rcppsw/multithread/thread_pool.hpp"
+
+#include <sched.h>
+
+#include "rcsw/multithread/threadm.h"
+
+/*******************************************************************************
+ * Namespaces/Decls
+ ******************************************************************************/
+NS_START(rcppsw, multithread);
+
+namespace {
+/*
+ * The pool and worker index of the calling thread, if it is a pool worker.
+ */
+thread_local const thread_pool* tl_pool = nullptr;
+thread_local int tl_worker = -1;
+
+/*
+ * The cores the calling process is allowed to run on, which can be a subset of
+ * [0, hardware_concurrency()) (cgroups, taskset, etc.).
+ */
+std::vector<size_t> allowed_cores(void) {
+  std::vector<size_t> cores;
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (0 == sched_getaffinity(0, sizeof(set), &set)) {
+    for (size_t core = 0; core < CPU_SETSIZE; ++core) {
+      if (CPU_ISSET(core, &set)) {
+        cores.push_back(core);
+      }
+    } /* for(core..) */
+  }
+  if (cores.empty()) {
+    size_t n = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    for (size_t core = 0; core < n; ++core) {
+      cores.push_back(core);
+    } /* for(core..) */
+  }
+  return cores;
+}
+} /* namespace */
+
+/*******************************************************************************
+ * Constructors/Destructors
+ ******************************************************************************/
+thread_pool::thread_pool(size_t n_threads, bool pin)
+    : ER_CLIENT_INIT("rcppsw.multithread.thread_pool") {
+  n_threads = std::max<size_t>(n_threads, 1);
+  std::vector<size_t> cores = pin ? allowed_cores() : std::vector<size_t>();
+
+  for (size_t i = 0; i < n_threads; ++i) {
+    m_workers.push_back(std::make_unique<worker>(this, i));
+  } /* for(i..) */
+
+  /* all workers must exist before any of them start stealing */
+  for (size_t i = 0; i < n_threads; ++i) {
+    status_t ret = m_workers[i]->start(nullptr);
+    ER_ASSERT(OK == ret, "Cannot start worker thread %zu", i);
+    if (OK != ret) {
+      break;
+    }
+    ++m_n_started;
+    size_t core = pin ? cores[i % cores.size()] : 0;
+    if (pin && OK != m_workers[i]->pin(core)) {
+      ER_WARN("Cannot pin worker thread %zu to core %zu", i, core);
+    }
+  } /* for(i..) */
+
+  /* push() only hands work to started workers, so with none, reject it all */
+  if (0 == m_n_started) {
+    m_closed.store(true, std::memory_order_seq_cst);
+  }
+}
+
+thread_pool::~thread_pool(void) { term(); }
+
+/*******************************************************************************
+ * Member Functions
+ ******************************************************************************/
+void thread_pool::term(void) {
+  if (m_joined.exchange(true)) {
+    return;
+  }
+  /*
+   * Pairs with push(): either it sees the pool is closed, or we see it in
+   * progress and wait for its task to be queued before the workers are told
+   * to stop, so that no accepted task is left behind.
+   */
+  m_closed.store(true, std::memory_order_seq_cst);
+  while (0 != m_n_pushing.load(std::memory_order_seq_cst)) {
+    std::this_thread::yield();
+  } /* while() */
+  m_stop.store(true, std::memory_order_release);
+  m_idle.notify_all();
+
+  /* only the workers which were started (all of them, unless the constructor
+   * failed) can be joined */
+  for (size_t i = 0; i < m_n_started; ++i) {
+    m_workers[i]->term();
+    m_workers[i]->join();
+  } /* for(i..) */
+} /* term() */
+
+bool thread_pool::push(task_type task) {
+  m_n_pushing.fetch_add(1, std::memory_order_seq_cst);
+  if (m_closed.load(std::memory_order_seq_cst)) {
+    m_n_pushing.fetch_sub(1, std::memory_order_release);
+    return false;
+  }
+  int self = current_worker();
+  size_t idx = (-1 != self)
+                   ? static_cast<size_t>(self)
+                   : m_next.fetch_add(1, std::memory_order_relaxed) %
+                         m_n_started;
+  m_workers[idx]->push(std::move(task));
+  m_n_pushing.fetch_sub(1, std::memory_order_release);
+  m_idle.notify();
+  return true;
+} /* push() */
+
+bool thread_pool::find_task(int self, task_type* task) {
+  if (-1 != self && m_workers[static_cast<size_t>(self)]->pop(task)) {
+    return true;
+  }
+  /* start with the next worker, so that thieves spread out */
+  size_t n = m_workers.size();
+  size_t start = (-1 != self) ? static_cast<size_t>(self) + 1 : 0;
+  for (size_t i = 0; i < n; ++i) {
+    size_t victim = (start + i) % n;
+    if (static_cast<int>(victim) != self && m_workers[victim]->steal(task)) {
+      return true;
+    }
+  } /* for(i..) */
+  return false;
+} /* find_task() */
+
+bool thread_pool::run_one(void) {
+  task_type task;
+  if (find_task(current_worker(), &task)) {
+    task();
+    return true;
+  }
+  return false;
+} /* run_one() */
+
+int thread_pool::current_worker(void) const {
+  return (this == tl_pool) ? tl_worker : -1;
+} /* current_worker() */
+
+/*******************************************************************************
+ * Worker
+ ******************************************************************************/
+void* thread_pool::worker::thread_main(void*) {
+  tl_pool = m_pool;
+  tl_worker = static_cast<int>(mc_id);
+
+  while (true) {
+    task_type task;
+    m_pool->m_idle.wait([&]() {
+      /*
+       * Read the stop flag first: once it is set, every accepted task has been
+       * queued, so if we don't find one there is nothing left to do.
+       */
+      bool stop = m_pool->m_stop.load(std::memory_order_acquire);
+      return m_pool->find_task(static_cast<int>(mc_id), &task) || stop;
+    });
+    if (!task) {
+      /* told to stop, and there is nothing left to do */
+      break;
+    }
+    task();
+  } /* while() */
+  return nullptr;
+} /* thread_main() */
+
+bool thread_pool::worker::pop(task_type* task) {
+  std::lock_guard<std::mutex> lock(m_mtx);
+  if (m_tasks.empty()) {
+    return false;
+  }
+  *task = std::move(m_tasks.back());
+  m_tasks.pop_back();
+  return true;
+} /* pop() */
+
+bool thread_pool::worker::steal(task_type* task) {
+  std::lock_guard<std::mutex> lock(m_mtx);
+  if (m_tasks.empty()) {
+    return false;
+  }
+  *task = std::move(m_tasks.front());
+  m_tasks.pop_front();
+  return true;
+} /* steal() */
+
+status_t thread_pool::worker::pin(size_t core) {
+  return threadm_core_lock(thread_handle(), core);
+} /* pin() */
+
+void thread_pool::worker::push(task_type task) {
+  std::lock_guard<std::mutex> lock(m_mtx);
+  m_tasks.push_back(std::move(task));
+} /* push() */
+
+NS_END(multithread, rcppsw);
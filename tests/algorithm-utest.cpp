@@ -21,6 +21,7 @@
 /*******************************************************************************
  * Includes
  ******************************************************************************/
+#include <algorithm>
 #include <vector>
 #include <cmath>
 #include <functional>
@@ -33,7 +34,12 @@
 #include "rcppsw/algorithm/closest_pair2D.hpp"
 #include "rcppsw/math/vector2.hpp"
 #include "rcppsw/algorithm/clustering/entropy.hpp"
+#include "rcppsw/algorithm/clustering/entropy_eh_omp.hpp"
+#include "rcppsw/algorithm/clustering/entropy_eh_grid_omp.hpp"
 #include "rcppsw/algorithm/clustering/kmeans.hpp"
+#include "rcppsw/algorithm/clustering/kmeans_hamerly_omp.hpp"
+#include "rcppsw/algorithm/clustering/kmeans_stream.hpp"
+#include "rcppsw/algorithm/clustering/kmeans_soa.hpp"
 
 /*******************************************************************************
  * Namespaces
@@ -102,3 +108,174 @@ CATCH_TEST_CASE("Kmeans", "[ralg::clustering]") {
     }
   } /* for(i..) */
 }
+
+CATCH_TEST_CASE("Kmeans Hamerly", "[ralg::clustering]") {
+  std::vector<double> data = {1.0, 2.0, 2.3, 1.8, 0.5, 9.8, 7.6, 8.4, 9.1, 6.4};
+  using impl_type = clustering::kmeans_hamerly_omp<double>;
+
+  for (auto method : {impl_type::seeding::ekFIRST_K,
+                      impl_type::seeding::ekPLUSPLUS}) {
+    auto impl = std::make_unique<impl_type>(4, method, 17);
+    clustering::kmeans<double> alg(data,
+                                   std::move(impl),
+                                   2,
+                                   10);
+    auto res = alg.run([](double a, double b) { return std::fabs(a - b); });
+    CATCH_REQUIRE(10 == res.size());
+
+    /* kmeans++ can pick the centers in either order */
+    for (size_t i = 0; i < res.size(); ++i) {
+      if (i < 5) {
+        CATCH_REQUIRE(res[i] == res[0]);
+      } else {
+        CATCH_REQUIRE(res[i] != res[0]);
+      }
+    } /* for(i..) */
+  } /* for(method..) */
+}
+
+CATCH_TEST_CASE("Kmeans Stream", "[ralg::clustering]") {
+  std::vector<std::vector<double>> batches = {{1.0, 9.8, 2.0},
+                                              {7.6, 2.3, 1.8},
+                                              {8.4, 0.5},
+                                              {9.1, 6.4}};
+  clustering::kmeans_stream<double> alg(
+      2, 4, [](double a, double b) { return std::fabs(a - b); }, 0, 17);
+
+  for (auto& batch : batches) {
+    alg.add_points(batch);
+  } /* for(&batch..) */
+  CATCH_REQUIRE(alg.seeded());
+  CATCH_REQUIRE(10 == alg.n_points());
+
+  std::vector<double> data = {1.0, 2.0, 2.3, 1.8, 0.5, 9.8, 7.6, 8.4, 9.1, 6.4};
+  auto res = alg.membership(data);
+  CATCH_REQUIRE(10 == res.size());
+
+  /* kmeans++ can pick the centers in either order */
+  for (size_t i = 0; i < res.size(); ++i) {
+    if (i < 5) {
+      CATCH_REQUIRE(res[i] == res[0]);
+    } else {
+      CATCH_REQUIRE(res[i] != res[0]);
+    }
+  } /* for(i..) */
+
+  /* without a count cap, the centers are the means of their points */
+  CATCH_REQUIRE(std::fabs(alg.centers()[res[0]] - 1.52) < 1e-9);
+  CATCH_REQUIRE(std::fabs(alg.centers()[res[5]] - 8.26) < 1e-9);
+}
+
+CATCH_TEST_CASE("Kmeans SoA", "[ralg::clustering]") {
+  std::vector<math::vector2d> data = {{1.0, 1.0}, {2.0, 1.5}, {2.3, 0.8},
+                                      {1.8, 1.2}, {0.5, 0.9}, {9.8, 9.0},
+                                      {7.6, 8.1}, {8.4, 9.5}, {9.1, 8.8},
+                                      {6.4, 7.7}};
+  auto points = clustering::soa_points<2>::from(data);
+  CATCH_REQUIRE(10 == points.size());
+  CATCH_REQUIRE(0 == reinterpret_cast<uintptr_t>(points.dim(1)) % 64);
+
+  clustering::kmeans_soa<2, clustering::metric::l2> alg(2, 10, 4);
+  auto res = alg.run(points);
+  CATCH_REQUIRE(10 == res.size());
+
+  for (size_t i = 0; i < res.size(); ++i) {
+    if (i < 5) {
+      CATCH_REQUIRE(res[i] == 0);
+    } else {
+      CATCH_REQUIRE(res[i] == 1);
+    }
+  } /* for(i..) */
+  CATCH_REQUIRE(std::fabs(alg.centers()[1][0] - 8.26) < 1e-9);
+
+  /* metrics also work as distance functions for the other implementations */
+  math::vector2d other(4, 5);
+  CATCH_REQUIRE(7.0 == clustering::metric::l1()(data[0], other));
+  CATCH_REQUIRE(5.0 == clustering::metric::l2()(data[0], other));
+  CATCH_REQUIRE(25.0 == clustering::metric::squared_l2()(data[0], other));
+}
+
+CATCH_TEST_CASE("Entropy Grid", "[ralg::clustering]") {
+  std::vector<math::vector2d> data;
+  for (size_t i = 0; i < 200; ++i) {
+    data.emplace_back((i * 37) % 101 / 10.0, (i * 53) % 89 / 10.0);
+  } /* for(i..) */
+  auto dist = [](const math::vector2d& a, const math::vector2d& b) {
+    return (a - b).length();
+  };
+
+  /* the spatial index must give the same entropy as comparing all pairs */
+  clustering::entropy_balch2000<math::vector2d> brute(
+      std::make_unique<clustering::entropy_eh_omp<math::vector2d>>(4),
+      math::ranged(0.0, 5.0),
+      0.25);
+  clustering::entropy_balch2000<math::vector2d> grid(
+      std::make_unique<clustering::entropy_eh_grid_omp<math::vector2d>>(4),
+      math::ranged(0.0, 5.0),
+      0.25);
+  double expected = brute.run(data, dist);
+  CATCH_REQUIRE(expected > 0.0);
+  CATCH_REQUIRE(std::fabs(grid.run(data, dist) - expected) < 1e-9);
+
+  /*
+   * Horizons past the largest one rebuild the neighbor lists midway through,
+   * which must not change the clusters.
+   */
+  using impl_type = clustering::eh_clustering_impl<math::vector2d>;
+  using membership = clustering::membership_type<clustering::policy::EH>;
+  clustering::entropy_eh_omp<math::vector2d> brute_impl(4);
+  clustering::entropy_eh_grid_omp<math::vector2d> grid_impl(4);
+  membership brute_members(data.size());
+  membership grid_members(data.size());
+  impl_type::cluster_vector brute_clusters;
+  impl_type::cluster_vector grid_clusters;
+  for (size_t i = 0; i < data.size(); ++i) {
+    brute_clusters.emplace_back(i, data, &brute_members);
+    grid_clusters.emplace_back(i, data, &grid_members);
+  } /* for(i..) */
+  brute_impl.initialize(&data, &brute_members);
+  grid_impl.max_horizon(1.0);
+  grid_impl.initialize(&data, &grid_members);
+
+  for (double horizon : { 0.5, 1.0, 1.5, 2.5, 2.0, 3.0 }) {
+    brute_impl.horizon(horizon);
+    grid_impl.horizon(horizon);
+    brute_impl.iterate(data, dist, &brute_clusters);
+    grid_impl.iterate(data, dist, &grid_clusters);
+    for (size_t i = 0; i < data.size(); ++i) {
+      CATCH_REQUIRE(brute_members[i] == grid_members[i]);
+    } /* for(i..) */
+  } /* for(horizon..) */
+}
+
+CATCH_TEST_CASE("EH Members", "[ralg::clustering]") {
+  clustering::eh_members a;
+  clustering::eh_members b;
+  std::vector<size_t> scratch;
+
+  /* the same members inserted in different orders, with repeats */
+  for (size_t idx : {1UL, 4UL, 9UL, 16UL, 25UL}) {
+    a.insert(idx);
+  } /* for(idx..) */
+  for (size_t idx : {25UL, 9UL, 1UL, 16UL, 9UL, 4UL, 25UL}) {
+    b.insert(idx);
+  } /* for(idx..) */
+  a.merge(&scratch);
+  b.merge(&scratch);
+
+  CATCH_REQUIRE(5 == b.size());
+  CATCH_REQUIRE(a.hash() == b.hash());
+  CATCH_REQUIRE(a == b);
+  CATCH_REQUIRE(std::is_sorted(b.begin(), b.end()));
+  CATCH_REQUIRE(b.contains(16));
+  CATCH_REQUIRE(!b.contains(17));
+
+  b.insert(3);
+  b.merge(&scratch);
+  CATCH_REQUIRE(a != b);
+  CATCH_REQUIRE(a.hash() != b.hash());
+
+  b.clear();
+  CATCH_REQUIRE(b.empty());
+  CATCH_REQUIRE(0 == b.hash());
+}
@@ -0,0 +1,49 @@
+/**
+ * @file benchmark.hpp
+ *
+ * @copyright 2020 John Harwell, All rights reserved.
+ *
+ * This file is part of RCPPSW.
+ *
+ * RCPPSW is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * RCPPSW is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * RCPPSW.  If not, see <http://www.gnu.org/licenses/
+ */
+
+#ifndef TESTS_BENCHMARK_HPP_
+#define TESTS_BENCHMARK_HPP_
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <chrono>
+
+/*******************************************************************************
+ * Helper Functions
+ ******************************************************************************/
+/*
+ * Benchmarks are tagged [.benchmark], so they only run when asked for
+ * explicitly (e.g. `ds-flat_grid2D-utest [.benchmark]`), and should be run from
+ * an optimized build.
+ */
+
+/*
+ * Wall-clock time in milliseconds taken to run \p f().
+ */
+template <typename TFunc>
+double time_ms(const TFunc& f) {
+  auto start = std::chrono::steady_clock::now();
+  f();
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+#endif /* TESTS_BENCHMARK_HPP_ */
@@ -0,0 +1,262 @@
+/**
+ * @file ds-flat_grid2D-utest.cpp
+ *
+ * @copyright 2020 John Harwell, All rights reserved.
+ *
+ * This file is part of RCPPSW.
+ *
+ * RCPPSW is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * RCPPSW is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * RCPPSW.  If not, see <http://www.gnu.org/licenses/
+ */
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_PREFIX_ALL
+#include "catch.hpp"
+
+#include "benchmark.hpp"
+
+#include "rcppsw/ds/flat_grid2D.hpp"
+#include "rcppsw/ds/flat_grid2D_overlay.hpp"
+#include "rcppsw/ds/grid2D.hpp"
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace ds = rcppsw::ds;
+namespace math = rcppsw::math;
+
+/*******************************************************************************
+ * Helper Functions
+ ******************************************************************************/
+/*
+ * Sum the cells in row-major order, or at the given (precomputed) random
+ * coordinates, through the grid's access() function.
+ */
+template <typename TGrid>
+static double sum_sequential(const TGrid& grid, size_t xdim, size_t ydim) {
+  double sum = 0.0;
+  for (size_t i = 0; i < xdim; ++i) {
+    for (size_t j = 0; j < ydim; ++j) {
+      sum += grid.access(i, j);
+    } /* for(j..) */
+  } /* for(i..) */
+  return sum;
+}
+
+template <typename TGrid>
+static double sum_random(const TGrid& grid,
+                         const std::vector<math::vector2z>& coords) {
+  double sum = 0.0;
+  for (auto& c : coords) {
+    sum += grid.access(c.x(), c.y());
+  } /* for(&c..) */
+  return sum;
+}
+
+/*******************************************************************************
+ * Test Cases
+ ******************************************************************************/
+CATCH_TEST_CASE("Access", "[ds::flat_grid2D]") {
+  ds::grid2D<int> ref(13, 7);
+  ds::flat_grid2D<int> grid(13, 7);
+
+  CATCH_REQUIRE(13 == grid.xdsize());
+  CATCH_REQUIRE(7 == grid.ydsize());
+  CATCH_REQUIRE(0 == reinterpret_cast<uintptr_t>(grid.data()) %
+                         ds::flat_grid2D<int>::kAlignment);
+
+  for (size_t i = 0; i < 13; ++i) {
+    for (size_t j = 0; j < 7; ++j) {
+      ref.access(i, j) = static_cast<int>(i * 100 + j);
+      grid.access(i, j) = static_cast<int>(i * 100 + j);
+    } /* for(j..) */
+  } /* for(i..) */
+
+  /* same subgrid/subcircle semantics as base_grid2D */
+  auto view = grid.subcircle({ 3, 3 }, 2);
+  auto ref_view = ref.subcircle({ 3, 3 }, 2);
+  CATCH_REQUIRE(view.shape()[0] == ref_view.shape()[0]);
+  CATCH_REQUIRE(view.shape()[1] == ref_view.shape()[1]);
+  for (size_t i = 0; i < view.shape()[0]; ++i) {
+    for (size_t j = 0; j < view.shape()[1]; ++j) {
+      CATCH_REQUIRE(view[i][j] == ref_view[i][j]);
+    } /* for(j..) */
+  } /* for(i..) */
+
+  const auto& cgrid = grid;
+  CATCH_REQUIRE(1206 == cgrid.access(12, 6));
+  CATCH_REQUIRE(1206 == cgrid[math::vector2z(12, 6)]);
+}
+
+CATCH_TEST_CASE("Overlay", "[ds::flat_grid2D]") {
+  ds::flat_grid2D_overlay<int> grid(math::vector2d(0.0, 0.0),
+                                    math::vector2d(10.0, 5.0),
+                                    rcppsw::types::discretize_ratio(0.5),
+                                    rcppsw::types::discretize_ratio(0.5));
+  CATCH_REQUIRE(20 == grid.xdsize());
+  CATCH_REQUIRE(10 == grid.ydsize());
+  CATCH_REQUIRE(math::vector2z(20, 10) == grid.dimsd());
+}
+
+CATCH_TEST_CASE("Access Benchmark", "[.benchmark][ds::flat_grid2D]") {
+  std::mt19937 gen(17);
+
+  for (size_t dim : { 256, 1024, 4096 }) {
+    ds::grid2D<double> ref(dim, dim);
+    ds::flat_grid2D<double> grid(dim, dim);
+    grid.fill(1.0);
+    for (size_t i = 0; i < dim; ++i) {
+      for (size_t j = 0; j < dim; ++j) {
+        ref.access(i, j) = 1.0;
+      } /* for(j..) */
+    } /* for(i..) */
+
+    std::uniform_int_distribution<size_t> dist(0, dim - 1);
+    std::vector<math::vector2z> coords(dim * dim);
+    for (auto& c : coords) {
+      c = math::vector2z(dist(gen), dist(gen));
+    } /* for(&c..) */
+
+    /* through the base class, as the arena code does */
+    const ds::base_grid2D<double>& base = ref;
+    double s1 = 0.0;
+    double s2 = 0.0;
+    double seq_ref = time_ms([&] { s1 = sum_sequential(base, dim, dim); });
+    double seq_flat = time_ms([&] { s2 = sum_sequential(grid, dim, dim); });
+    CATCH_REQUIRE(s1 == s2);
+
+    double rand_ref = time_ms([&] { s1 = sum_random(base, coords); });
+    double rand_flat = time_ms([&] { s2 = sum_random(grid, coords); });
+    CATCH_REQUIRE(s1 == s2);
+
+    std::printf("%5zu^2: sequential grid2D=%.2fms flat_grid2D=%.2fms, "
+                "random grid2D=%.2fms flat_grid2D=%.2fms\n",
+                dim,
+                seq_ref,
+                seq_flat,
+                rand_ref,
+                rand_flat);
+  } /* for(dim..) */
+}
+
+CATCH_TEST_CASE("Layout For Each", "[ds::flat_grid2D]") {
+  /* every layout must visit exactly the cells in the box, in storage order */
+  auto check = [](const auto& layout, size_t dim) {
+    std::mt19937 gen(dim);
+    std::uniform_int_distribution<size_t> dist(0, dim);
+    for (size_t n = 0; n < 200; ++n) {
+      size_t x0 = dist(gen), x1 = dist(gen), y0 = dist(gen), y1 = dist(gen);
+      math::vector2z ll(std::min(x0, x1), std::min(y0, y1));
+      math::vector2z ur(std::max(x0, x1), std::max(y0, y1));
+
+      size_t count = 0;
+      size_t prev = 0;
+      bool ok = true;
+      layout.for_each(ll, ur, [&](size_t i, size_t j, size_t off) {
+        ok = ok && i >= ll.x() && i < ur.x() && j >= ll.y() && j < ur.y();
+        ok = ok && off == layout.offset(i, j) && (0 == count || off > prev);
+        prev = off;
+        ++count;
+      });
+      CATCH_REQUIRE(ok);
+      CATCH_REQUIRE(count == (ur.x() - ll.x()) * (ur.y() - ll.y()));
+    } /* for(n..) */
+  };
+  for (size_t dim : { 1, 7, 64, 100 }) {
+    check(ds::grid2D_layout::row_major(dim, dim), dim);
+    check(ds::grid2D_layout::tiled<8>(dim, dim), dim);
+    check(ds::grid2D_layout::morton(dim, dim), dim);
+  } /* for(dim..) */
+
+  /* a small box straddling the middle of a large Morton grid */
+  ds::grid2D_layout::morton big(8192, 8192);
+  size_t count = 0;
+  big.for_each({ 4095, 4095 }, { 4098, 4098 }, [&](size_t, size_t, size_t) {
+    ++count;
+  });
+  CATCH_REQUIRE(9 == count);
+}
+
+/*
+ * Sum the cells of a subcircle view of each of the given centers, visiting
+ * them in storage order if the view supports it.
+ */
+template <typename TGrid>
+static double scan_neighborhoods(const TGrid& grid,
+                                 const std::vector<math::vector2z>& centers,
+                                 size_t radius) {
+  double sum = 0.0;
+  for (auto& c : centers) {
+    auto view = grid.subcircle(c, radius);
+    if constexpr (TGrid::layout_type::kRowMajor) {
+      for (size_t i = 0; i < view.shape()[0]; ++i) {
+        for (size_t j = 0; j < view.shape()[1]; ++j) {
+          sum += view[i][j];
+        } /* for(j..) */
+      } /* for(i..) */
+    } else {
+      view.for_each([&](size_t, size_t, double cell) { sum += cell; });
+    }
+  } /* for(&c..) */
+  return sum;
+}
+
+CATCH_TEST_CASE("Layout Benchmark", "[.benchmark][ds::flat_grid2D]") {
+  std::mt19937 gen(17);
+
+  for (size_t dim : { 64, 512, 2048, 8192 }) {
+    ds::flat_grid2D<double> row(dim, dim);
+    ds::flat_grid2D<double, ds::grid2D_layout::tiled<8>> tiled(dim, dim);
+    ds::flat_grid2D<double, ds::grid2D_layout::morton> morton(dim, dim);
+    row.fill(1.0);
+    tiled.fill(1.0);
+    morton.fill(1.0);
+
+    std::uniform_int_distribution<size_t> dist(0, dim - 1);
+    std::vector<math::vector2z> centers(10000);
+    for (auto& c : centers) {
+      c = math::vector2z(dist(gen), dist(gen));
+    } /* for(&c..) */
+
+    for (size_t radius : { 2, 8, 32 }) {
+      double s1 = 0.0;
+      double s2 = 0.0;
+      double s3 = 0.0;
+      double t_row = time_ms([&] {
+        s1 = scan_neighborhoods(row, centers, radius);
+      });
+      double t_tiled = time_ms([&] {
+        s2 = scan_neighborhoods(tiled, centers, radius);
+      });
+      double t_morton = time_ms([&] {
+        s3 = scan_neighborhoods(morton, centers, radius);
+      });
+      CATCH_REQUIRE(s1 == s2);
+      CATCH_REQUIRE(s1 == s3);
+      std::printf("%5zu^2 r=%2zu: row_major=%.2fms tiled=%.2fms "
+                  "morton=%.2fms\n",
+                  dim,
+                  radius,
+                  t_row,
+                  t_tiled,
+                  t_morton);
+    } /* for(radius..) */
+  } /* for(dim..) */
+}
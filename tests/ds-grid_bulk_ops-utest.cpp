@@ -0,0 +1,170 @@
+/**
+ * @file ds-grid_bulk_ops-utest.cpp
+ *
+ * @copyright 2020 John Harwell, All rights reserved.
+ *
+ * This file is part of RCPPSW.
+ *
+ * RCPPSW is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * RCPPSW is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * RCPPSW.  If not, see <http://www.gnu.org/licenses/
+ */
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <cstdio>
+
+#define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_PREFIX_ALL
+#include "catch.hpp"
+
+#include "benchmark.hpp"
+
+#include "rcppsw/ds/flat_grid2D.hpp"
+#include "rcppsw/ds/grid2D.hpp"
+#include "rcppsw/ds/grid3D.hpp"
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace ds = rcppsw::ds;
+
+/*******************************************************************************
+ * Helper Functions
+ ******************************************************************************/
+/*
+ * The per-cell access() loops the bulk operations replace, through the base
+ * class as the arena code does.
+ */
+template <typename TFunc>
+static void naive_apply(ds::base_grid2D<double>& grid, const TFunc& f) {
+  for (size_t i = 0; i < grid.xdsize(); ++i) {
+    for (size_t j = 0; j < grid.ydsize(); ++j) {
+      f(grid.access(i, j));
+    } /* for(j..) */
+  } /* for(i..) */
+}
+
+/*******************************************************************************
+ * Test Cases
+ ******************************************************************************/
+CATCH_TEST_CASE("grid2D", "[ds::grid_bulk_ops]") {
+  ds::grid2D<int> grid(13, 7);
+
+  for (size_t n_threads : { 1, 4 }) {
+    grid.fill(3, n_threads);
+    grid.transform([](int cell) { return cell + 1; }, n_threads);
+    grid.decay(2, n_threads);
+    for (size_t i = 0; i < 13; ++i) {
+      for (size_t j = 0; j < 7; ++j) {
+        CATCH_REQUIRE(8 == grid.access(i, j));
+      } /* for(j..) */
+    } /* for(i..) */
+
+    grid.for_each_cell(
+        [](size_t i, size_t j, int& cell) {
+          cell = static_cast<int>(i * 100 + j);
+        },
+        n_threads);
+    for (size_t i = 0; i < 13; ++i) {
+      for (size_t j = 0; j < 7; ++j) {
+        CATCH_REQUIRE(static_cast<int>(i * 100 + j) == grid.access(i, j));
+      } /* for(j..) */
+    } /* for(i..) */
+
+    int sum = grid.reduce(0, [](int a, int b) { return a + b; }, n_threads);
+    CATCH_REQUIRE(7 * (100 * 78) + 13 * 21 == sum);
+    int max = grid.reduce(
+        0, [](int a, int b) { return std::max(a, b); }, n_threads);
+    CATCH_REQUIRE(1206 == max);
+  } /* for(n_threads..) */
+}
+
+CATCH_TEST_CASE("grid3D", "[ds::grid_bulk_ops]") {
+  ds::grid3D<int> grid(5, 4, 3);
+
+  grid.for_each_cell([](size_t i, size_t j, size_t k, int& cell) {
+    cell = static_cast<int>(i * 100 + j * 10 + k);
+  });
+  for (size_t i = 0; i < 5; ++i) {
+    for (size_t j = 0; j < 4; ++j) {
+      for (size_t k = 0; k < 3; ++k) {
+        CATCH_REQUIRE(static_cast<int>(i * 100 + j * 10 + k) ==
+                      grid.access(i, j, k));
+      } /* for(k..) */
+    } /* for(j..) */
+  } /* for(i..) */
+
+  grid.fill(1, 2);
+  CATCH_REQUIRE(60 == grid.reduce(0, [](int a, int b) { return a + b; }, 2));
+}
+
+CATCH_TEST_CASE("flat_grid2D", "[ds::grid_bulk_ops]") {
+  /* padding cells must not be visited or reduced */
+  ds::flat_grid2D<int, ds::grid2D_layout::morton> grid(5, 3);
+  grid.fill(2);
+  grid.decay(3);
+
+  size_t count = 0;
+  grid.for_each_cell([&](size_t, size_t, int& cell) {
+    CATCH_REQUIRE(6 == cell);
+    ++count;
+  });
+  CATCH_REQUIRE(15 == count);
+  CATCH_REQUIRE(90 == grid.reduce(0, [](int a, int b) { return a + b; }));
+}
+
+CATCH_TEST_CASE("Benchmark", "[.benchmark][ds::grid_bulk_ops]") {
+  for (size_t dim : { 256, 1024, 4096 }) {
+    ds::grid2D<double> grid(dim, dim);
+    ds::base_grid2D<double>& base = grid;
+
+    double naive_fill = time_ms([&] {
+      naive_apply(base, [](double& cell) { cell = 1.0; });
+    });
+    double bulk_fill = time_ms([&] { grid.fill(1.0); });
+
+    double naive_decay = time_ms([&] {
+      naive_apply(base, [](double& cell) { cell *= 0.99; });
+    });
+    double bulk_decay = time_ms([&] { grid.decay(0.99); });
+
+    double naive_transform = time_ms([&] {
+      naive_apply(base, [](double& cell) { cell = cell * 0.5 + 1.0; });
+    });
+    double bulk_transform = time_ms([&] {
+      grid.transform([](double cell) { return cell * 0.5 + 1.0; });
+    });
+
+    double s1 = 0.0;
+    double s2 = 0.0;
+    double naive_reduce = time_ms([&] {
+      naive_apply(base, [&](double& cell) { s1 += cell; });
+    });
+    double bulk_reduce = time_ms([&] {
+      s2 = grid.reduce(0.0, [](double a, double b) { return a + b; });
+    });
+    CATCH_REQUIRE(s1 == s2);
+
+    std::printf("%5zu^2: fill %.2f/%.2fms, decay %.2f/%.2fms, "
+                "transform %.2f/%.2fms, reduce %.2f/%.2fms (naive/bulk)\n",
+                dim,
+                naive_fill,
+                bulk_fill,
+                naive_decay,
+                bulk_decay,
+                naive_transform,
+                bulk_transform,
+                naive_reduce,
+                bulk_reduce);
+  } /* for(dim..) */
+}
@@ -0,0 +1,149 @@
+/**
+ * @file ds-poisson_queue-utest.cpp
+ *
+ * @copyright 2020 John Harwell, All rights reserved.
+ *
+ * This file is part of RCPPSW.
+ *
+ * RCPPSW is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * RCPPSW is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * RCPPSW.  If not, see <http://www.gnu.org/licenses/
+ */
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_PREFIX_ALL
+#include "catch.hpp"
+
+#include "rcppsw/ds/poisson_queue.hpp"
+#include "rcppsw/math/rng.hpp"
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace ds = rcppsw::ds;
+namespace math = rcppsw::math;
+namespace rtypes = rcppsw::types;
+
+/*******************************************************************************
+ * Test Cases
+ ******************************************************************************/
+CATCH_TEST_CASE("Contains", "[ds::poisson_queue]") {
+  math::rng rng(0);
+  ds::poisson_queue<int, true> indexed(1.0, 1.0, &rng);
+  ds::poisson_queue<int> scan(1.0, 1.0, &rng);
+
+  /* 3 copies of 7, interleaved with other items */
+  size_t t = 0;
+  for (int item : { 7, 1, 7, 2, 7, 3 }) {
+    indexed.enqueue(item, rtypes::timestep(t));
+    scan.enqueue(item, rtypes::timestep(t));
+    ++t;
+  } /* for(item..) */
+  CATCH_REQUIRE(6 == indexed.size());
+  CATCH_REQUIRE(indexed.contains(7));
+  CATCH_REQUIRE(indexed.contains(3));
+  CATCH_REQUIRE(!indexed.contains(4));
+
+  /* 7 is in the queue until its last copy is dequeued */
+  std::vector<int> expected = { 7, 1, 7, 2, 7, 3 };
+  for (size_t i = 0; i < expected.size(); ++i) {
+    auto item = indexed.dequeue(rtypes::timestep(t), false);
+    auto item2 = scan.dequeue(rtypes::timestep(t), false);
+    ++t;
+    CATCH_REQUIRE(item.is_initialized());
+    CATCH_REQUIRE(expected[i] == *item);
+    CATCH_REQUIRE(*item2 == *item);
+    CATCH_REQUIRE((i < 4) == indexed.contains(7));
+    CATCH_REQUIRE(scan.contains(7) == indexed.contains(7));
+    CATCH_REQUIRE((i < 1) == indexed.contains(1));
+    CATCH_REQUIRE((i < 5) == indexed.contains(3));
+  } /* for(i..) */
+  CATCH_REQUIRE(0 == indexed.size());
+
+  /* nothing to dequeue, or a fake dequeue: the index is untouched */
+  indexed.enqueue(7, rtypes::timestep(t));
+  CATCH_REQUIRE(!indexed.dequeue(rtypes::timestep(t), true).is_initialized());
+  CATCH_REQUIRE(indexed.contains(7));
+  CATCH_REQUIRE(7 == *indexed.dequeue(rtypes::timestep(t), false));
+  CATCH_REQUIRE(!indexed.dequeue(rtypes::timestep(t), false).is_initialized());
+  CATCH_REQUIRE(!indexed.contains(7));
+  CATCH_REQUIRE(7 == indexed.enqueue_data().count);
+  CATCH_REQUIRE(9 == indexed.dequeue_data().count);
+}
+
+CATCH_TEST_CASE("Advance", "[ds::poisson_queue]") {
+  /*
+   * poisson_queue_advance() over a vector of unique_ptr queues must do
+   * exactly what checking each queue by hand does, given the same samples.
+   */
+  using queue_type = ds::poisson_queue<size_t, true>;
+  const std::vector<std::pair<double, double>> kRates = {
+    { 0.5, 0.3 }, { 0.1, 0.2 }, { 0.0, 0.5 }, { 0.3, 0.0 }
+  };
+
+  math::rng rng1(17);
+  math::rng rng2(17);
+  std::vector<std::unique_ptr<queue_type>> queues;
+  std::vector<std::unique_ptr<queue_type>> ref;
+  for (auto& r : kRates) {
+    queues.push_back(std::make_unique<queue_type>(r.first, r.second, &rng1));
+    ref.push_back(std::make_unique<queue_type>(r.first, r.second, &rng2));
+  } /* for(&r..) */
+
+  std::map<const queue_type*, size_t> n_dequeued;
+  for (size_t t = 0; t < 2000; ++t) {
+    rtypes::timestep ts(t);
+    ds::poisson_queue_advance(
+        queues,
+        ts,
+        [&](queue_type& q) { q.enqueue(t, ts); },
+        [&](queue_type& q) {
+          if (q.dequeue(ts, false)) {
+            ++n_dequeued[&q];
+          }
+        });
+    for (auto& q : ref) {
+      if (q->enqueue_check(ts)) {
+        q->enqueue(t, ts);
+      }
+      if (q->dequeue_check(ts)) {
+        q->dequeue(ts, false);
+      }
+    } /* for(&q..) */
+  } /* for(t..) */
+
+  for (size_t i = 0; i < kRates.size(); ++i) {
+    auto enq = queues[i]->enqueue_data();
+    auto deq = queues[i]->dequeue_data();
+    CATCH_REQUIRE(ref[i]->enqueue_data().total_count == enq.total_count);
+    CATCH_REQUIRE(ref[i]->dequeue_data().total_count == deq.total_count);
+    CATCH_REQUIRE((kRates[i].first > 0.0) == (enq.total_count > 0));
+    CATCH_REQUIRE((kRates[i].second > 0.0) == (deq.total_count > 0));
+    CATCH_REQUIRE(enq.total_count - n_dequeued[queues[i].get()] ==
+                  queues[i]->size());
+
+    /* same contents, and each item leaves the index when it is dequeued */
+    CATCH_REQUIRE(ref[i]->size() == queues[i]->size());
+    while (0 != queues[i]->size()) {
+      auto item = queues[i]->dequeue(rtypes::timestep(2000), false);
+      CATCH_REQUIRE(*item == *ref[i]->dequeue(rtypes::timestep(2000), false));
+      CATCH_REQUIRE(!queues[i]->contains(*item));
+    } /* while() */
+  } /* for(i..) */
+}
@@ -0,0 +1,255 @@
+/**
+ * @file ds-rtree2D-utest.cpp
+ *
+ * @copyright 2020 John Harwell, All rights reserved.
+ *
+ * This file is part of RCPPSW.
+ *
+ * RCPPSW is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * RCPPSW is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * RCPPSW.  If not, see <http://www.gnu.org/licenses/
+ */
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <algorithm>
+#include <cstdio>
+#include <iterator>
+#include <random>
+#include <utility>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_PREFIX_ALL
+#include "catch.hpp"
+
+#include "benchmark.hpp"
+
+#include "rcppsw/ds/rtree2D.hpp"
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace ds = rcppsw::ds;
+namespace math = rcppsw::math;
+
+using tree_type = ds::rtree2D<double, int, 8>;
+
+/*******************************************************************************
+ * Helper Functions
+ ******************************************************************************/
+/*
+ * A 10 x 10 grid of unit squares, with key 10 * i + j for the square with
+ * lower left corner (2i, 2j).
+ */
+static std::vector<tree_type::value_type> make_values(void) {
+  std::vector<tree_type::value_type> values;
+  for (int i = 0; i < 10; ++i) {
+    for (int j = 0; j < 10; ++j) {
+      tree_type::box_type box(tree_type::point_type(2.0 * i, 2.0 * j),
+                              tree_type::point_type(2.0 * i + 1, 2.0 * j + 1));
+      values.emplace_back(box, 10 * i + j);
+    } /* for(j..) */
+  } /* for(i..) */
+  return values;
+}
+
+static std::vector<int> sorted(std::vector<int> keys) {
+  std::sort(keys.begin(), keys.end());
+  return keys;
+}
+
+/*******************************************************************************
+ * Test Cases
+ ******************************************************************************/
+CATCH_TEST_CASE("Insert/Remove/Update", "[ds::rtree2D]") {
+  tree_type tree;
+  tree.insert(1, { 0.0, 0.0 }, { 1.0, 1.0 });
+  tree.insert(2, { 5.0, 5.0 }, { 6.0, 6.0 });
+  CATCH_REQUIRE(2 == tree.size());
+  CATCH_REQUIRE(tree.contains(1));
+  CATCH_REQUIRE(tree.query(2));
+  CATCH_REQUIRE(!tree.contains(3));
+
+  /* re-inserting a key moves it */
+  tree.insert(1, { 10.0, 10.0 }, { 11.0, 11.0 });
+  CATCH_REQUIRE(2 == tree.size());
+  CATCH_REQUIRE(tree.query({ 0.0, 0.0 }, { 1.0, 1.0 }).empty());
+  CATCH_REQUIRE(std::vector<int>{ 1 } ==
+                tree.query({ 10.5, 10.5 }, { 12.0, 12.0 }));
+
+  tree.update(2, { 5.0, 5.0 }, { 6.0, 6.0 });
+  tree.update(3, { 20.0, 20.0 }, { 21.0, 21.0 });
+  CATCH_REQUIRE(3 == tree.size());
+  tree.update(3, { 30.0, 30.0 }, { 31.0, 31.0 });
+  CATCH_REQUIRE(std::vector<int>{ 3 } ==
+                tree.query({ 29.0, 29.0 }, { 30.0, 30.0 }));
+
+  CATCH_REQUIRE(1 == tree.remove(2));
+  CATCH_REQUIRE(0 == tree.remove(2));
+  CATCH_REQUIRE(!tree.contains(2));
+  CATCH_REQUIRE(2 == tree.size());
+
+  tree.clear();
+  CATCH_REQUIRE(0 == tree.size());
+  CATCH_REQUIRE(!tree.contains(1));
+}
+
+CATCH_TEST_CASE("Queries", "[ds::rtree2D]") {
+  tree_type tree(make_values());
+  CATCH_REQUIRE(100 == tree.size());
+
+  /* covers the squares at (0..2, 0..1) */
+  std::vector<int> keys;
+  tree.query({ 0.5, 0.5 }, { 4.5, 2.5 }, std::back_inserter(keys));
+  CATCH_REQUIRE(std::vector<int>({ 0, 1, 10, 11, 20, 21 }) == sorted(keys));
+
+  size_t count = 0;
+  tree.visit({ -1.0, -1.0 }, { 100.0, 100.0 }, [&](int) { ++count; });
+  CATCH_REQUIRE(100 == count);
+
+  /* the squares at distance <= 1.5 from (3, 3): the 4 around it */
+  keys.clear();
+  tree.query_radius({ 3.0, 3.0 }, 1.5, std::back_inserter(keys));
+  CATCH_REQUIRE(std::vector<int>({ 11, 12, 21, 22 }) == sorted(keys));
+  count = 0;
+  tree.visit_radius({ 3.5, 3.5 }, 0.4, [&](int) { ++count; });
+  CATCH_REQUIRE(0 == count);
+
+  keys.clear();
+  tree.nearest({ 8.5, 8.5 }, 3, std::back_inserter(keys));
+  CATCH_REQUIRE(3 == keys.size());
+  CATCH_REQUIRE(44 == keys[0]);
+
+  std::vector<std::pair<math::vector2d, math::vector2d>> boxes = {
+    { { 0.5, 0.5 }, { 0.6, 0.6 } },
+    { { 100.0, 100.0 }, { 101.0, 101.0 } },
+    { { 18.5, 18.5 }, { 19.0, 19.0 } },
+  };
+  std::vector<std::pair<size_t, int>> hits;
+  tree.visit_batch(boxes, [&](size_t i, int key) { hits.emplace_back(i, key); });
+  CATCH_REQUIRE(2 == hits.size());
+  CATCH_REQUIRE(std::make_pair(size_t(0), 0) == hits[0]);
+  CATCH_REQUIRE(std::make_pair(size_t(2), 99) == hits[1]);
+}
+
+CATCH_TEST_CASE("Rebuild", "[ds::rtree2D]") {
+  tree_type tree;
+  tree.insert(1000, { 0.0, 0.0 }, { 1.0, 1.0 });
+  CATCH_REQUIRE(OK == tree.rebuild(make_values()));
+  CATCH_REQUIRE(100 == tree.size());
+  CATCH_REQUIRE(!tree.contains(1000));
+  CATCH_REQUIRE(tree.contains(99));
+
+  /* duplicate keys are rejected, and leave the tree as it was */
+  auto values = make_values();
+  values.push_back(values.front());
+  CATCH_REQUIRE(ERROR == tree.rebuild(values));
+  CATCH_REQUIRE(100 == tree.size());
+  CATCH_REQUIRE(tree.contains(99));
+}
+
+CATCH_TEST_CASE("Freeze", "[ds::rtree2D]") {
+  tree_type tree(make_values());
+  CATCH_REQUIRE(!tree.frozen());
+  tree.freeze();
+  CATCH_REQUIRE(tree.frozen());
+
+  CATCH_REQUIRE(ERROR == tree.insert(1000, { 0.0, 0.0 }, { 1.0, 1.0 }));
+  CATCH_REQUIRE(ERROR == tree.update(0, { 5.0, 5.0 }, { 6.0, 6.0 }));
+  CATCH_REQUIRE(0 == tree.remove(0));
+  CATCH_REQUIRE(ERROR == tree.clear());
+  CATCH_REQUIRE(ERROR == tree.rebuild(make_values()));
+
+  /* still queryable, and unchanged */
+  CATCH_REQUIRE(100 == tree.size());
+  CATCH_REQUIRE(!tree.contains(1000));
+  CATCH_REQUIRE(std::vector<int>{ 0 } ==
+                tree.query({ 0.5, 0.5 }, { 0.6, 0.6 }));
+}
+
+CATCH_TEST_CASE("Churn Benchmark", "[.benchmark][ds::rtree2D]") {
+  /*
+   * 10k objects which all move every tick: removed and re-inserted in a bare
+   * boost rtree, finding the victim by scanning the tree as rtree2D::remove()
+   * did before the side index; removed and re-inserted in an rtree2D; and
+   * moved with rtree2D::update().
+   */
+  const size_t kN = 10000;
+  const size_t kTicks = 5;
+  std::mt19937 gen(17);
+  std::uniform_real_distribution<double> pos(0.0, 100.0);
+  std::uniform_real_distribution<double> step(-0.5, 0.5);
+
+  std::vector<math::vector2d> objs(kN);
+  for (auto& o : objs) {
+    o = math::vector2d(pos(gen), pos(gen));
+  } /* for(&o..) */
+
+  auto make_box = [&](size_t i) {
+    return tree_type::box_type(
+        tree_type::point_type(objs[i].x(), objs[i].y()),
+        tree_type::point_type(objs[i].x() + 0.1, objs[i].y() + 0.1));
+  };
+  tree_type::tree_type scan;
+  tree_type churn;
+  tree_type updated;
+  for (size_t i = 0; i < kN; ++i) {
+    scan.insert(tree_type::value_type(make_box(i), static_cast<int>(i)));
+    churn.insert(tree_type::value_type(make_box(i), static_cast<int>(i)));
+    updated.insert(tree_type::value_type(make_box(i), static_cast<int>(i)));
+  } /* for(i..) */
+
+  double scan_ms = 0.0;
+  double churn_ms = 0.0;
+  double update_ms = 0.0;
+  math::vector2d extent(0.1, 0.1);
+  for (size_t t = 0; t < kTicks; ++t) {
+    for (auto& o : objs) {
+      o += math::vector2d(step(gen), step(gen));
+    } /* for(&o..) */
+    scan_ms += time_ms([&] {
+      for (size_t i = 0; i < kN; ++i) {
+        int key = static_cast<int>(i);
+        auto it = std::find_if(scan.begin(), scan.end(), [&](auto& v) {
+          return key == v.second;
+        });
+        scan.remove(*it);
+        scan.insert(tree_type::value_type(make_box(i), key));
+      } /* for(i..) */
+    });
+    churn_ms += time_ms([&] {
+      for (size_t i = 0; i < kN; ++i) {
+        churn.remove(static_cast<int>(i));
+        churn.insert(static_cast<int>(i), objs[i], objs[i] + extent);
+      } /* for(i..) */
+    });
+    update_ms += time_ms([&] {
+      /* the second pass is a no-op: nothing has moved */
+      for (size_t pass = 0; pass < 2; ++pass) {
+        for (size_t i = 0; i < kN; ++i) {
+          updated.update(static_cast<int>(i), objs[i], objs[i] + extent);
+        } /* for(i..) */
+      } /* for(pass..) */
+    });
+  } /* for(t..) */
+  CATCH_REQUIRE(kN == scan.size());
+  CATCH_REQUIRE(sorted(churn.query({ 0.0, 0.0 }, { 50.0, 50.0 })) ==
+                sorted(updated.query({ 0.0, 0.0 }, { 50.0, 50.0 })));
+
+  std::printf("%zu objects: scan remove+insert=%.2fms "
+              "indexed remove+insert=%.2fms update=%.2fms per tick\n",
+              kN,
+              scan_ms / kTicks,
+              churn_ms / kTicks,
+              update_ms / kTicks);
+}
@@ -0,0 +1,244 @@
+/**
+ * @file ds-sparse_grid-utest.cpp
+ *
+ * @copyright 2020 John Harwell, All rights reserved.
+ *
+ * This file is part of RCPPSW.
+ *
+ * RCPPSW is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * RCPPSW is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * RCPPSW.  If not, see <http://www.gnu.org/licenses/
+ */
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_PREFIX_ALL
+#include "catch.hpp"
+
+#include "rcppsw/ds/base_grid2D.hpp"
+#include "rcppsw/ds/base_grid3D.hpp"
+#include "rcppsw/ds/grid2D.hpp"
+#include "rcppsw/ds/grid3D.hpp"
+#include "rcppsw/ds/sparse_grid2D.hpp"
+#include "rcppsw/ds/sparse_grid3D.hpp"
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace ds = rcppsw::ds;
+namespace math = rcppsw::math;
+
+/*******************************************************************************
+ * Helper Functions
+ ******************************************************************************/
+/*
+ * Written against the cell access interface shared with base_grid2D, so it
+ * works on dense and sparse grids alike.
+ */
+template <typename TGrid>
+static void mark_diagonal(TGrid& grid) {
+  for (size_t i = 0; i < grid.xdsize() && i < grid.ydsize(); ++i) {
+    grid.access(i, i) = static_cast<int>(i) + 1;
+  } /* for(i..) */
+}
+
+template <typename TGrid>
+static long sum_cells(const TGrid& grid) {
+  long sum = 0;
+  for (size_t i = 0; i < grid.xdsize(); ++i) {
+    for (size_t j = 0; j < grid.ydsize(); ++j) {
+      sum += grid[math::vector2z(i, j)];
+    } /* for(j..) */
+  } /* for(i..) */
+  return sum;
+}
+
+/*******************************************************************************
+ * Test Cases
+ ******************************************************************************/
+CATCH_TEST_CASE("Lazy Allocation", "[ds::sparse_grid2D]") {
+  using grid_type = ds::sparse_grid2D<int, 16>;
+  grid_type grid(1000, 1000, -1);
+  const grid_type& cgrid = grid;
+
+  CATCH_REQUIRE(1000 == grid.xdsize());
+  CATCH_REQUIRE(1000 == grid.ydsize());
+  CATCH_REQUIRE(-1 == grid.default_value());
+  CATCH_REQUIRE(0 == grid.n_chunks());
+  CATCH_REQUIRE(0 == grid.resident_cells());
+  CATCH_REQUIRE(0 == grid.resident_bytes());
+
+  /* reads through a const reference never allocate */
+  for (size_t i = 0; i < 1000; i += 7) {
+    for (size_t j = 0; j < 1000; j += 7) {
+      CATCH_REQUIRE(-1 == cgrid.access(i, j));
+    } /* for(j..) */
+  } /* for(i..) */
+  CATCH_REQUIRE(-1 == cgrid[math::vector2z(999, 999)]);
+  CATCH_REQUIRE(0 == grid.n_chunks());
+  CATCH_REQUIRE(!grid.allocated(500, 500));
+
+  /* a write allocates exactly one chunk, filled with the default */
+  grid.access(500, 500) = 7;
+  CATCH_REQUIRE(1 == grid.n_chunks());
+  CATCH_REQUIRE(grid_type::kChunkSize == grid.resident_cells());
+  CATCH_REQUIRE(grid_type::kChunkSize * sizeof(int) == grid.resident_bytes());
+  CATCH_REQUIRE(grid.allocated(500, 500));
+  CATCH_REQUIRE(grid.allocated(496, 511));
+  CATCH_REQUIRE(!grid.allocated(495, 500));
+  CATCH_REQUIRE(7 == cgrid.access(500, 500));
+  CATCH_REQUIRE(-1 == cgrid.access(501, 500));
+
+  /* more writes to the same chunk do not allocate */
+  grid[math::vector2z(511, 496)] = 8;
+  grid.access(math::vector2z(496, 511)) = 9;
+  CATCH_REQUIRE(1 == grid.n_chunks());
+  CATCH_REQUIRE(8 == cgrid.access(511, 496));
+  CATCH_REQUIRE(9 == cgrid.access(496, 511));
+
+  CATCH_REQUIRE(grid.contains(999, 0));
+  CATCH_REQUIRE(!grid.contains(1000, 0));
+  CATCH_REQUIRE(!grid.contains(math::vector2z(0, 1000)));
+}
+
+CATCH_TEST_CASE("Chunk Boundaries", "[ds::sparse_grid2D]") {
+  /* dimensions which are not a multiple of the chunk size */
+  ds::sparse_grid2D<int, 4> grid(10, 6);
+
+  /* the 4 cells around a chunk corner are in 4 different chunks */
+  grid.access(3, 3) = 1;
+  grid.access(3, 4) = 2;
+  grid.access(4, 3) = 3;
+  grid.access(4, 4) = 4;
+  CATCH_REQUIRE(4 == grid.n_chunks());
+
+  /* the partial chunks at the far edges */
+  grid.access(9, 5) = 5;
+  grid.access(8, 0) = 6;
+  CATCH_REQUIRE(6 == grid.n_chunks());
+  CATCH_REQUIRE(6 * 16 == grid.resident_cells());
+
+  const auto& cgrid = grid;
+  CATCH_REQUIRE(1 == cgrid.access(3, 3));
+  CATCH_REQUIRE(2 == cgrid.access(3, 4));
+  CATCH_REQUIRE(3 == cgrid.access(4, 3));
+  CATCH_REQUIRE(4 == cgrid.access(4, 4));
+  CATCH_REQUIRE(5 == cgrid.access(9, 5));
+  CATCH_REQUIRE(6 == cgrid.access(8, 0));
+  CATCH_REQUIRE(0 == cgrid.access(9, 4));
+  CATCH_REQUIRE(21 == sum_cells(cgrid));
+
+  /* chunks which are back to all default values are freed */
+  grid.access(8, 0) = 0;
+  grid.access(9, 5) = 0;
+  CATCH_REQUIRE(2 == grid.shrink());
+  CATCH_REQUIRE(4 == grid.n_chunks());
+  CATCH_REQUIRE(0 == cgrid.access(9, 5));
+
+  grid.clear();
+  CATCH_REQUIRE(0 == grid.n_chunks());
+  CATCH_REQUIRE(0 == cgrid.access(3, 3));
+}
+
+CATCH_TEST_CASE("Dense Equivalence", "[ds::sparse_grid2D]") {
+  /* same results as a dense grid through the shared access interface */
+  ds::grid2D<int> dense(37, 53);
+  ds::sparse_grid2D<int, 8> sparse(37, 53);
+  for (size_t i = 0; i < 37; ++i) {
+    for (size_t j = 0; j < 53; ++j) {
+      dense.access(i, j) = 0;
+    } /* for(j..) */
+  } /* for(i..) */
+
+  /* through the base class, as the arena code does */
+  ds::base_grid2D<int>& base = dense;
+  mark_diagonal(base);
+  mark_diagonal(sparse);
+  CATCH_REQUIRE(sum_cells(base) == sum_cells(sparse));
+  CATCH_REQUIRE(37 * 38 / 2 == sum_cells(sparse));
+
+  /* only the chunks on the diagonal */
+  CATCH_REQUIRE(5 == sparse.n_chunks());
+}
+
+CATCH_TEST_CASE("3D", "[ds::sparse_grid3D]") {
+  using grid_type = ds::sparse_grid3D<double, 4>;
+  grid_type grid(math::vector3z(10, 10, 6), 0.5);
+  const grid_type& cgrid = grid;
+
+  CATCH_REQUIRE(10 == grid.xdsize());
+  CATCH_REQUIRE(10 == grid.ydsize());
+  CATCH_REQUIRE(6 == grid.zdsize());
+  CATCH_REQUIRE(0.5 == cgrid.access(9, 9, 5));
+  CATCH_REQUIRE(0.5 == cgrid[math::vector3z(0, 0, 0)]);
+  CATCH_REQUIRE(0 == grid.n_chunks());
+
+  /* the 8 cells around a chunk corner are in 8 different chunks */
+  for (size_t i = 3; i <= 4; ++i) {
+    for (size_t j = 3; j <= 4; ++j) {
+      for (size_t k = 3; k <= 4; ++k) {
+        grid.access(i, j, k) = static_cast<double>(i * 100 + j * 10 + k);
+      } /* for(k..) */
+    } /* for(j..) */
+  } /* for(i..) */
+  CATCH_REQUIRE(8 == grid.n_chunks());
+  CATCH_REQUIRE(8 * grid_type::kChunkSize == grid.resident_cells());
+  CATCH_REQUIRE(8 * 64 * sizeof(double) == grid.resident_bytes());
+  CATCH_REQUIRE(344.0 == cgrid.access(3, 4, 4));
+  CATCH_REQUIRE(433.0 == cgrid.access(math::vector3z(4, 3, 3)));
+  CATCH_REQUIRE(0.5 == cgrid.access(5, 4, 4));
+  CATCH_REQUIRE(grid.allocated(7, 7, 7));
+  CATCH_REQUIRE(!grid.allocated(8, 7, 7));
+
+  /* the partial chunk at the far corner */
+  grid[math::vector3z(9, 9, 5)] = 1.0;
+  CATCH_REQUIRE(9 == grid.n_chunks());
+  CATCH_REQUIRE(1.0 == cgrid.access(9, 9, 5));
+  CATCH_REQUIRE(0.5 == cgrid.access(8, 8, 4));
+
+  CATCH_REQUIRE(grid.contains(9, 9, 5));
+  CATCH_REQUIRE(!grid.contains(9, 9, 6));
+  CATCH_REQUIRE(!grid.contains(math::vector3z(10, 0, 0)));
+
+  grid.access(9, 9, 5) = 0.5;
+  CATCH_REQUIRE(1 == grid.shrink());
+  CATCH_REQUIRE(8 == grid.n_chunks());
+  grid.clear();
+  CATCH_REQUIRE(0 == grid.n_chunks());
+  CATCH_REQUIRE(0.5 == cgrid.access(3, 3, 3));
+
+  /* same cell layout as a dense grid */
+  ds::grid3D<double> grid3D(10, 10, 6);
+  ds::base_grid3D<double>& dense = grid3D;
+  ds::sparse_grid3D<double, 4> sparse(10, 10, 6);
+  double dsum = 0.0;
+  double ssum = 0.0;
+  for (size_t i = 0; i < 10; ++i) {
+    for (size_t j = 0; j < 10; ++j) {
+      for (size_t k = 0; k < 6; ++k) {
+        dense.access(i, j, k) = sparse.access(i, j, k) =
+            static_cast<double>(i * j + k);
+      } /* for(k..) */
+    } /* for(j..) */
+  } /* for(i..) */
+  for (size_t i = 0; i < 10; ++i) {
+    for (size_t j = 0; j < 10; ++j) {
+      for (size_t k = 0; k < 6; ++k) {
+        dsum += dense.access(i, j, k) * static_cast<double>(i + 2 * j + 3 * k);
+        ssum += sparse.access(i, j, k) * static_cast<double>(i + 2 * j + 3 * k);
+      } /* for(k..) */
+    } /* for(j..) */
+  } /* for(i..) */
+  CATCH_REQUIRE(dsum == ssum);
+  CATCH_REQUIRE(3 * 3 * 2 == sparse.n_chunks());
+}
@@ -0,0 +1,305 @@
+/**
+ * @file ds-spatial_hash2D-utest.cpp
+ *
+ * @copyright 2020 John Harwell, All rights reserved.
+ *
+ * This file is part of RCPPSW.
+ *
+ * RCPPSW is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * RCPPSW is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * RCPPSW.  If not, see <http://www.gnu.org/licenses/
+ */
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <new>
+#include <random>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_PREFIX_ALL
+#include "catch.hpp"
+
+#include "benchmark.hpp"
+
+#include "rcppsw/ds/rtree2D.hpp"
+#include "rcppsw/ds/spatial_hash2D.hpp"
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace ds = rcppsw::ds;
+namespace math = rcppsw::math;
+namespace rtypes = rcppsw::types;
+
+using hash_type = ds::spatial_hash2D<int>;
+
+/*******************************************************************************
+ * Allocation Counting
+ ******************************************************************************/
+/*
+ * Count heap allocations made by this program, so the allocation-free queries
+ * can be checked.
+ */
+static size_t g_n_allocs = 0;
+
+void* operator new(size_t size) {
+  ++g_n_allocs;
+  if (void* p = std::malloc(size ? size : 1)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+/* not inlined, so GCC does not pair the free() with a new expression */
+__attribute__((noinline)) void operator delete(void* p) noexcept {
+  std::free(p);
+}
+__attribute__((noinline)) void operator delete(void* p, size_t) noexcept {
+  std::free(p);
+}
+
+/*******************************************************************************
+ * Helper Functions
+ ******************************************************************************/
+static std::vector<int> sorted(std::vector<int> keys) {
+  std::sort(keys.begin(), keys.end());
+  return keys;
+}
+
+/*******************************************************************************
+ * Test Cases
+ ******************************************************************************/
+CATCH_TEST_CASE("Insert/Remove/Update", "[ds::spatial_hash2D]") {
+  hash_type hash(rtypes::discretize_ratio(1.0));
+  hash.insert(1, { 0.2, 0.2 }, { 0.3, 0.3 });
+  hash.insert(2, { 5.5, 5.5 }, { 5.6, 5.6 });
+  CATCH_REQUIRE(2 == hash.size());
+  CATCH_REQUIRE(2 == hash.n_buckets());
+  CATCH_REQUIRE(hash.contains(1));
+  CATCH_REQUIRE(hash.query(2));
+  CATCH_REQUIRE(!hash.contains(3));
+
+  /* moving within a bucket does not touch the buckets */
+  hash.update(1, { 0.7, 0.7 }, { 0.8, 0.8 });
+  CATCH_REQUIRE(hash.query({ 0.0, 0.0 }, { 0.5, 0.5 }).empty());
+  CATCH_REQUIRE(std::vector<int>{ 1 } ==
+                hash.query({ 0.6, 0.6 }, { 0.9, 0.9 }));
+
+  /* re-inserting a key moves it, here to another bucket */
+  hash.insert(1, { 10.5, 10.5 }, { 10.6, 10.6 });
+  CATCH_REQUIRE(2 == hash.size());
+  CATCH_REQUIRE(hash.query({ 0.0, 0.0 }, { 1.0, 1.0 }).empty());
+  CATCH_REQUIRE(std::vector<int>{ 1 } ==
+                hash.query({ 10.0, 10.0 }, { 11.0, 11.0 }));
+
+  /* update() inserts missing keys */
+  hash.update(3, { -20.5, -20.5 }, { -20.4, -20.4 });
+  CATCH_REQUIRE(3 == hash.size());
+  CATCH_REQUIRE(std::vector<int>{ 3 } ==
+                hash.query({ -21.0, -21.0 }, { -20.0, -20.0 }));
+
+  CATCH_REQUIRE(1 == hash.remove(2));
+  CATCH_REQUIRE(0 == hash.remove(2));
+  CATCH_REQUIRE(!hash.contains(2));
+  CATCH_REQUIRE(2 == hash.size());
+  CATCH_REQUIRE(hash.query({ 5.0, 5.0 }, { 6.0, 6.0 }).empty());
+
+  /* empty buckets are kept until shrink() */
+  size_t n_buckets = hash.n_buckets();
+  CATCH_REQUIRE(2 == hash.shrink());
+  CATCH_REQUIRE(n_buckets - 2 == hash.n_buckets());
+
+  hash.clear();
+  CATCH_REQUIRE(0 == hash.size());
+  CATCH_REQUIRE(!hash.contains(1));
+  CATCH_REQUIRE(hash.query({ -100.0, -100.0 }, { 100.0, 100.0 }).empty());
+}
+
+CATCH_TEST_CASE("Queries", "[ds::spatial_hash2D]") {
+  /*
+   * Random small boxes, checked against a brute force scan, with bucket sizes
+   * both smaller and larger than the boxes.
+   */
+  std::mt19937 gen(17);
+  std::uniform_real_distribution<double> pos(-50.0, 50.0);
+  std::uniform_real_distribution<double> ext(0.0, 2.0);
+
+  for (double size : { 0.5, 1.0, 4.0 }) {
+    hash_type hash{ rtypes::discretize_ratio(size) };
+    std::vector<std::pair<math::vector2d, math::vector2d>> boxes;
+    for (int i = 0; i < 1000; ++i) {
+      math::vector2d ll(pos(gen), pos(gen));
+      math::vector2d ur = ll + math::vector2d(ext(gen), ext(gen));
+      boxes.emplace_back(ll, ur);
+      hash.insert(i, ll, ur);
+    } /* for(i..) */
+
+    for (int n = 0; n < 100; ++n) {
+      math::vector2d ll(pos(gen), pos(gen));
+      math::vector2d ur = ll + math::vector2d(5 * ext(gen), 5 * ext(gen));
+      std::vector<int> expected;
+      for (int i = 0; i < 1000; ++i) {
+        auto& b = boxes[static_cast<size_t>(i)];
+        if (b.first.x() <= ur.x() && ll.x() <= b.second.x() &&
+            b.first.y() <= ur.y() && ll.y() <= b.second.y()) {
+          expected.push_back(i);
+        }
+      } /* for(i..) */
+      CATCH_REQUIRE(expected == sorted(hash.query(ll, ur)));
+
+      math::vector2d center(pos(gen), pos(gen));
+      double radius = 5 * ext(gen);
+      expected.clear();
+      for (int i = 0; i < 1000; ++i) {
+        auto& b = boxes[static_cast<size_t>(i)];
+        double dx = std::max({ b.first.x() - center.x(),
+                               0.0,
+                               center.x() - b.second.x() });
+        double dy = std::max({ b.first.y() - center.y(),
+                               0.0,
+                               center.y() - b.second.y() });
+        if (dx * dx + dy * dy <= radius * radius) {
+          expected.push_back(i);
+        }
+      } /* for(i..) */
+      std::vector<int> keys;
+      hash.query_radius(center, radius, std::back_inserter(keys));
+      CATCH_REQUIRE(expected == sorted(keys));
+    } /* for(n..) */
+  } /* for(size..) */
+}
+
+CATCH_TEST_CASE("Large Objects", "[ds::spatial_hash2D]") {
+  /* objects spanning many buckets are reported once per query */
+  hash_type hash(rtypes::discretize_ratio(1.0));
+  hash.insert(1, { 0.5, 0.5 }, { 10.5, 3.5 });
+  hash.insert(2, { 2.5, 2.5 }, { 2.6, 2.6 });
+  CATCH_REQUIRE(44 == hash.n_buckets());
+
+  CATCH_REQUIRE(std::vector<int>({ 1, 2 }) ==
+                sorted(hash.query({ 0.0, 0.0 }, { 20.0, 20.0 })));
+  CATCH_REQUIRE(std::vector<int>{ 1 } ==
+                hash.query({ 8.0, 1.0 }, { 9.0, 3.0 }));
+
+  size_t count = 0;
+  hash.visit_radius({ 5.0, 2.0 }, 4.0, [&](int) { ++count; });
+  CATCH_REQUIRE(2 == count);
+
+  /* near the object, but not within the radius */
+  std::vector<int> keys;
+  hash.query_radius({ 12.0, 5.0 }, 1.0, std::back_inserter(keys));
+  CATCH_REQUIRE(keys.empty());
+
+  /* moving it by less than a bucket shifts the buckets it is in */
+  hash.update(1, { 0.7, 0.7 }, { 11.2, 3.7 });
+  CATCH_REQUIRE(std::vector<int>{ 1 } ==
+                hash.query({ 11.1, 0.0 }, { 11.5, 1.0 }));
+  CATCH_REQUIRE(std::vector<int>({ 1, 2 }) ==
+                sorted(hash.query({ 0.0, 0.0 }, { 20.0, 20.0 })));
+
+  /* removing it empties all of them */
+  CATCH_REQUIRE(1 == hash.remove(1));
+  CATCH_REQUIRE(std::vector<int>{ 2 } ==
+                hash.query({ 0.0, 0.0 }, { 20.0, 20.0 }));
+  hash.shrink();
+  CATCH_REQUIRE(1 == hash.n_buckets());
+}
+
+CATCH_TEST_CASE("Allocation Free Queries", "[ds::spatial_hash2D]") {
+  hash_type hash(rtypes::discretize_ratio(1.0));
+  for (int i = 0; i < 100; ++i) {
+    hash.insert(i, { 0.5 * i, 0.5 * i }, { 0.5 * i + 0.2, 0.5 * i + 0.2 });
+  } /* for(i..) */
+  hash.insert(1000, { 0.0, 0.0 }, { 40.0, 2.0 });
+
+  size_t before = g_n_allocs;
+  size_t count = 0;
+  int sum = 0;
+  hash.visit_radius({ 10.0, 10.0 }, 5.0, [&](int key) {
+    ++count;
+    sum += key;
+  });
+  hash.visit({ 0.0, 0.0 }, { 50.0, 50.0 }, [&](int) { ++count; });
+
+  /* moving within a bucket does not allocate either */
+  hash.update(10, { 5.1, 5.1 }, { 5.3, 5.3 });
+  CATCH_REQUIRE(before == g_n_allocs);
+  CATCH_REQUIRE(0 < count);
+  CATCH_REQUIRE(0 < sum);
+}
+
+CATCH_TEST_CASE("Benchmark", "[.benchmark][ds::spatial_hash2D]") {
+  /*
+   * N agents doing a random walk in an arena which keeps their density
+   * constant; each step every agent moves, and then does a radius query.
+   */
+  using tree_type = ds::rtree2D<double, int, 16>;
+  const double kSize = 0.1;
+  const double kRadius = 1.0;
+  const size_t kSteps = 10;
+
+  for (size_t n : { 100UL, 1000UL, 10000UL, 100000UL }) {
+    double dim = std::sqrt(static_cast<double>(n));
+    std::mt19937 gen(17);
+    std::uniform_real_distribution<double> pos(0.0, dim);
+    std::uniform_real_distribution<double> step(-0.05, 0.05);
+    std::vector<math::vector2d> agents(n);
+    for (auto& a : agents) {
+      a = math::vector2d(pos(gen), pos(gen));
+    } /* for(&a..) */
+
+    hash_type hash{ rtypes::discretize_ratio(kRadius) };
+    tree_type tree;
+    math::vector2d extent(kSize, kSize);
+    for (size_t i = 0; i < n; ++i) {
+      hash.insert(static_cast<int>(i), agents[i], agents[i] + extent);
+      tree.insert(static_cast<int>(i), agents[i], agents[i] + extent);
+    } /* for(i..) */
+
+    size_t c1 = 0;
+    size_t c2 = 0;
+    double hash_ms = 0.0;
+    double tree_ms = 0.0;
+    for (size_t s = 0; s < kSteps; ++s) {
+      for (auto& a : agents) {
+        a += math::vector2d(step(gen), step(gen));
+      } /* for(&a..) */
+      hash_ms += time_ms([&] {
+        for (size_t i = 0; i < n; ++i) {
+          hash.update(static_cast<int>(i), agents[i], agents[i] + extent);
+        } /* for(i..) */
+        for (auto& a : agents) {
+          hash.visit_radius(a, kRadius, [&](int) { ++c1; });
+        } /* for(&a..) */
+      });
+      tree_ms += time_ms([&] {
+        for (size_t i = 0; i < n; ++i) {
+          tree.update(static_cast<int>(i), agents[i], agents[i] + extent);
+        } /* for(i..) */
+        for (auto& a : agents) {
+          tree.visit_radius(a, kRadius, [&](int) { ++c2; });
+        } /* for(&a..) */
+      });
+    } /* for(s..) */
+    CATCH_REQUIRE(c1 == c2);
+
+    std::printf("%6zu agents: spatial_hash2D=%.2fms rtree2D=%.2fms per step\n",
+                n,
+                hash_ms / kSteps,
+                tree_ms / kSteps);
+  } /* for(n..) */
+}
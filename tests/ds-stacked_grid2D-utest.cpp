@@ -0,0 +1,145 @@
+/**
+ * @file ds-stacked_grid2D-utest.cpp
+ *
+ * @copyright 2020 John Harwell, All rights reserved.
+ *
+ * This file is part of RCPPSW.
+ *
+ * RCPPSW is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * RCPPSW is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * RCPPSW.  If not, see <http://www.gnu.org/licenses/
+ */
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <cstdlib>
+#include <tuple>
+#include <type_traits>
+
+#define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_PREFIX_ALL
+#include "catch.hpp"
+
+#include "rcppsw/ds/stacked_grid2D.hpp"
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace ds = rcppsw::ds;
+namespace math = rcppsw::math;
+namespace rtypes = rcppsw::types;
+
+using layers_type = std::tuple<int, double, char>;
+using layer_major_type =
+    ds::stacked_grid2D<layers_type, ds::stacked_grid2D_layout::layer_major>;
+using cell_major_type =
+    ds::stacked_grid2D<layers_type, ds::stacked_grid2D_layout::cell_major>;
+
+/*******************************************************************************
+ * Helper Functions
+ ******************************************************************************/
+/*
+ * Write every cell of every layer through access<N>(), then check that
+ * access_all() (const and non-const) sees the same values, and that writes
+ * through access_all() are seen by access<N>().
+ */
+template <typename TGrid>
+static void check_layout(void) {
+  TGrid grid(math::vector2d(0.0, 0.0),
+             math::vector2d(10.0, 5.0),
+             rtypes::discretize_ratio(0.5),
+             rtypes::discretize_ratio(0.5));
+  const TGrid& cgrid = grid;
+
+  CATCH_REQUIRE(20 == grid.xdsize());
+  CATCH_REQUIRE(10 == grid.ydsize());
+  CATCH_REQUIRE(10.0 == grid.xrsize());
+  CATCH_REQUIRE(5.0 == grid.yrsize());
+  CATCH_REQUIRE(0.5 == grid.resolution().v());
+
+  for (size_t i = 0; i < grid.xdsize(); ++i) {
+    for (size_t j = 0; j < grid.ydsize(); ++j) {
+      grid.template access<0>(i, j) = static_cast<int>(i * 100 + j);
+      grid.template access<1>(math::vector2z(i, j)) =
+          static_cast<double>(i) + 0.5 * static_cast<double>(j);
+      grid.template access<2>(i, j) = static_cast<char>('a' + (i + j) % 26);
+    } /* for(j..) */
+  } /* for(i..) */
+
+  for (size_t i = 0; i < grid.xdsize(); ++i) {
+    for (size_t j = 0; j < grid.ydsize(); ++j) {
+      auto refs = grid.access_all(i, j);
+      auto crefs = cgrid.access_all(math::vector2z(i, j));
+      static_assert(std::is_same<decltype(refs),
+                                 typename TGrid::refs_type>::value,
+                    "non-const access_all() returns refs_type");
+      static_assert(std::is_same<decltype(crefs),
+                                 typename TGrid::const_refs_type>::value,
+                    "const access_all() returns const_refs_type");
+
+      CATCH_REQUIRE(static_cast<int>(i * 100 + j) == std::get<0>(refs));
+      CATCH_REQUIRE(std::get<0>(refs) == std::get<0>(crefs));
+      CATCH_REQUIRE(std::get<1>(refs) == std::get<1>(crefs));
+      CATCH_REQUIRE(std::get<2>(refs) == std::get<2>(crefs));
+      CATCH_REQUIRE(cgrid.template access<1>(i, j) == std::get<1>(crefs));
+      CATCH_REQUIRE(cgrid.template access<2>(math::vector2z(i, j)) ==
+                    std::get<2>(crefs));
+
+      /* the references alias the cells */
+      CATCH_REQUIRE(&std::get<0>(refs) == &grid.template access<0>(i, j));
+      CATCH_REQUIRE(&std::get<1>(crefs) == &cgrid.template access<1>(i, j));
+    } /* for(j..) */
+  } /* for(i..) */
+
+  auto refs = grid.access_all(math::vector2z(3, 4));
+  std::get<0>(refs) = -1;
+  std::get<1>(refs) = -2.0;
+  std::get<2>(refs) = 'z';
+  CATCH_REQUIRE(-1 == cgrid.template access<0>(3, 4));
+  CATCH_REQUIRE(-2.0 == cgrid.template access<1>(3, 4));
+  CATCH_REQUIRE('z' == cgrid.template access<2>(3, 4));
+
+  /* neighbors are untouched */
+  CATCH_REQUIRE(305 == cgrid.template access<0>(3, 5));
+  CATCH_REQUIRE(403 == cgrid.template access<0>(4, 3));
+}
+
+/*******************************************************************************
+ * Test Cases
+ ******************************************************************************/
+CATCH_TEST_CASE("Layer Major", "[ds::stacked_grid2D]") {
+  check_layout<layer_major_type>();
+
+  /* layers are separate grids in this layout */
+  layer_major_type grid(math::vector2d(0.0, 0.0),
+                        math::vector2d(2.0, 2.0),
+                        rtypes::discretize_ratio(1.0),
+                        rtypes::discretize_ratio(1.0));
+  grid.access<1>(1, 1) = 3.5;
+  CATCH_REQUIRE(3.5 == grid.layer<1>()->access(1, 1));
+  CATCH_REQUIRE(2 == grid.layer<0>()->xdsize());
+}
+
+CATCH_TEST_CASE("Cell Major", "[ds::stacked_grid2D]") {
+  check_layout<cell_major_type>();
+
+  /* the layers of a cell are stored together */
+  cell_major_type grid(math::vector2d(0.0, 0.0),
+                       math::vector2d(2.0, 2.0),
+                       rtypes::discretize_ratio(1.0),
+                       rtypes::discretize_ratio(1.0));
+  auto refs = grid.access_all(1, 0);
+  auto* first = reinterpret_cast<const char*>(&grid.access<0>(1, 0));
+  auto* second = reinterpret_cast<const char*>(&std::get<1>(refs));
+  CATCH_REQUIRE(static_cast<size_t>(std::abs(second - first)) <
+                sizeof(layers_type));
+}
@@ -0,0 +1,131 @@
+/**
+ * @file ds-timer_wheel-utest.cpp
+ *
+ * @copyright 2020 John Harwell, All rights reserved.
+ *
+ * This file is part of RCPPSW.
+ *
+ * RCPPSW is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * RCPPSW is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * RCPPSW.  If not, see <http://www.gnu.org/licenses/
+ */
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <functional>
+#include <queue>
+#include <random>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_PREFIX_ALL
+#include "catch.hpp"
+
+#include "rcppsw/ds/poisson_queue.hpp"
+#include "rcppsw/ds/timer_wheel.hpp"
+#include "rcppsw/math/rng.hpp"
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace ds = rcppsw::ds;
+namespace math = rcppsw::math;
+namespace rtypes = rcppsw::types;
+
+/*******************************************************************************
+ * Test Cases
+ ******************************************************************************/
+CATCH_TEST_CASE("Empty", "[ds::timer_wheel]") {
+  ds::timer_wheel<int> wheel;
+  CATCH_REQUIRE(wheel.empty());
+  CATCH_REQUIRE(0 == wheel.advance(rtypes::timestep(100000), [](int) {}));
+  CATCH_REQUIRE(rtypes::timestep(100000) == wheel.now());
+
+  /* a queue with no arrivals has no next enqueue time to register */
+  math::rng rng(0);
+  ds::poisson_queue<int> queue(0.0, 0.5, &rng);
+  CATCH_REQUIRE(!queue.next_enqueue_time().is_initialized());
+  CATCH_REQUIRE(queue.next_dequeue_time().is_initialized());
+}
+
+CATCH_TEST_CASE("Order", "[ds::timer_wheel]") {
+  /*
+   * With 2 levels, anything >= 4096 timesteps out goes to the overflow list,
+   * so this covers both cascades and overflow re-examination.
+   */
+  ds::timer_wheel<size_t, 2> wheel;
+  std::priority_queue<size_t, std::vector<size_t>, std::greater<size_t>> ref;
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<size_t> dist(1, 20000);
+
+  for (size_t i = 0; i < 5000; ++i) {
+    size_t at = dist(gen);
+    wheel.schedule(rtypes::timestep(at), at);
+    ref.push(at);
+  } /* for(i..) */
+  for (size_t at : { 63, 64, 65, 4095, 4096, 4097, 8191, 8192, 12288 }) {
+    wheel.schedule(rtypes::timestep(at), at);
+    ref.push(at);
+  } /* for(at..) */
+  CATCH_REQUIRE(ref.size() == wheel.size());
+
+  /* advance by uneven amounts, so boundaries fall in the middle of a call */
+  std::uniform_int_distribution<size_t> step(1, 150);
+  size_t now = 0;
+  bool ok = true;
+  while (!ref.empty()) {
+    size_t prev = now;
+    now += step(gen);
+    wheel.advance(rtypes::timestep(now), [&](size_t at) {
+      ok = ok && !ref.empty() && at == ref.top() && at > prev && at <= now;
+      ref.pop();
+    });
+  } /* while() */
+  CATCH_REQUIRE(ok);
+  CATCH_REQUIRE(wheel.empty());
+}
+
+CATCH_TEST_CASE("Cancel", "[ds::timer_wheel]") {
+  ds::timer_wheel<int> wheel;
+  auto id1 = wheel.schedule(rtypes::timestep(10), 1);
+  auto id2 = wheel.schedule(rtypes::timestep(5000), 2);
+  wheel.schedule(rtypes::timestep(20), 3);
+
+  CATCH_REQUIRE(wheel.cancel(id2));
+  CATCH_REQUIRE(!wheel.cancel(id2));
+  CATCH_REQUIRE(2 == wheel.size());
+
+  std::vector<int> fired;
+  wheel.advance(rtypes::timestep(10), [&](int v) { fired.push_back(v); });
+  CATCH_REQUIRE(std::vector<int>{ 1 } == fired);
+
+  /* a fired handle is stale, even once its node is reused */
+  wheel.schedule(rtypes::timestep(30), 4);
+  CATCH_REQUIRE(!wheel.cancel(id1));
+  CATCH_REQUIRE(2 == wheel.size());
+
+  /* callbacks can reschedule, including into the current call */
+  fired.clear();
+  wheel.advance(rtypes::timestep(100), [&](int v) {
+    fired.push_back(v);
+    if (3 == v) {
+      wheel.schedule(rtypes::timestep(25), 5);
+      wheel.schedule(rtypes::timestep(1000), 6);
+    }
+  });
+  CATCH_REQUIRE(std::vector<int>({ 3, 5, 4 }) == fired);
+  CATCH_REQUIRE(1 == wheel.size());
+
+  wheel.clear();
+  CATCH_REQUIRE(wheel.empty());
+  CATCH_REQUIRE(0 == wheel.advance(rtypes::timestep(2000), [](int) {}));
+}
@@ -83,6 +83,20 @@ CATCH_TEST_CASE("Exponential", "[math::rng]") {
   CATCH_REQUIRE(res1 == res2);
 }
 
+CATCH_TEST_CASE("Exponential Batch", "[math::rng]") {
+  math::rng r1(0);
+  math::rng r2(0);
+
+  std::vector<double> res1;
+  std::vector<double> res2(100);
+
+  for (size_t i = 0; i < 100; ++i) {
+    res1.push_back(r1.exponential(2.0));
+  } /* for(i..) */
+  r2.exponential(2.0, res2.data(), res2.size());
+  CATCH_REQUIRE(res1 == res2);
+}
+
 CATCH_TEST_CASE("Bernoulli", "[math::rng]") {
   math::rng r1(0);
   math::rng r2(0);
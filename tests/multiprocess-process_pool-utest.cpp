@@ -0,0 +1,194 @@
+/**
+ * @file multiprocess-process_pool-utest.cpp
+ *
+ * @copyright 2020 John Harwell, All rights reserved.
+ *
+ * This file is part of RCPPSW.
+ *
+ * RCPPSW is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * RCPPSW is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * RCPPSW.  If not, see <http://www.gnu.org/licenses/
+ */
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <sched.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include <map>
+#include <set>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_PREFIX_ALL
+#include "catch.hpp"
+
+#include "rcppsw/multiprocess/process_pool.hpp"
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace mp = rcppsw::multiprocess;
+
+/*******************************************************************************
+ * Helper Classes
+ ******************************************************************************/
+struct job {
+  int x;
+  /* If nonzero, the worker running the job dies */
+  int crash;
+};
+
+struct result {
+  long y;
+  pid_t pid;
+};
+
+using pool_type = mp::process_pool<job, result>;
+
+static result square(const job& j) {
+  if (0 != j.crash) {
+    raise(SIGKILL);
+  }
+  return { static_cast<long>(j.x) * j.x, getpid() };
+}
+
+struct affinity {
+  int n_cpus;
+  int cpu;
+};
+
+static affinity read_affinity(const job&) {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  affinity ret{ -1, -1 };
+  if (0 != sched_getaffinity(0, sizeof(set), &set)) {
+    return ret;
+  }
+  ret.n_cpus = CPU_COUNT(&set);
+  for (size_t i = 0; i < CPU_SETSIZE; ++i) {
+    if (CPU_ISSET(i, &set)) {
+      ret.cpu = static_cast<int>(i);
+      break;
+    }
+  } /* for(i..) */
+  return ret;
+}
+
+/*******************************************************************************
+ * Test Cases
+ ******************************************************************************/
+CATCH_TEST_CASE("Sanity", "[multiprocess::process_pool]") {
+  pool_type pool(3, square);
+  CATCH_REQUIRE(3 == pool.n_workers());
+
+  std::map<pool_type::job_id, int> ids;
+  for (int i = 0; i < 500; ++i) {
+    ids[pool.submit(job{ i, 0 })] = i;
+  } /* for(i..) */
+
+  auto results = pool.wait_all();
+  CATCH_REQUIRE(500 == results.size());
+  CATCH_REQUIRE(0 == pool.n_pending());
+  std::set<pid_t> pids;
+  for (auto& r : results) {
+    CATCH_REQUIRE(r.result.is_initialized());
+    CATCH_REQUIRE(static_cast<long>(ids[r.id]) * ids[r.id] == r.result->y);
+    pids.insert(r.result->pid);
+  } /* for(&r..) */
+  CATCH_REQUIRE(pids.count(getpid()) == 0);
+  CATCH_REQUIRE(0 == pool.n_restarts());
+}
+
+CATCH_TEST_CASE("Dead Workers", "[multiprocess::process_pool]") {
+  /*
+   * Small queues, so that submit() has to wait for room while workers are
+   * dying; every job must still come back exactly once.
+   */
+  pool_type pool(2, square, false, 1024);
+
+  std::map<pool_type::job_id, int> ids;
+  for (int i = 0; i < 300; ++i) {
+    ids[pool.submit(job{ i, 0 })] = i;
+  } /* for(i..) */
+  pool_type::job_id bad = pool.submit(job{ 7, 1 });
+  for (int i = 300; i < 600; ++i) {
+    ids[pool.submit(job{ i, 0 })] = i;
+  } /* for(i..) */
+
+  auto results = pool.wait_all();
+  CATCH_REQUIRE(601 == results.size());
+  std::set<pool_type::job_id> seen;
+  for (auto& r : results) {
+    CATCH_REQUIRE(seen.insert(r.id).second);
+    if (bad == r.id) {
+      CATCH_REQUIRE(!r.result.is_initialized());
+    } else {
+      CATCH_REQUIRE(r.result.is_initialized());
+      CATCH_REQUIRE(static_cast<long>(ids[r.id]) * ids[r.id] == r.result->y);
+    }
+  } /* for(&r..) */
+  CATCH_REQUIRE(pool_type::kMaxAttempts == pool.n_restarts());
+
+  /* a worker killed from outside is restarted too */
+  pool.submit(job{ 1, 0 });
+  auto live = pool.wait_all();
+  CATCH_REQUIRE(1 == live.size());
+  kill(live.front().result->pid, SIGKILL);
+  for (int i = 0; i < 300; ++i) {
+    pool.submit(job{ i, 0 });
+  } /* for(i..) */
+  CATCH_REQUIRE(300 == pool.wait_all().size());
+}
+
+CATCH_TEST_CASE("Term", "[multiprocess::process_pool]") {
+  pool_type pool(2, square);
+  pool.submit(job{ 1, 0 });
+  pool.term();
+  CATCH_REQUIRE(0 == pool.n_pending());
+  CATCH_REQUIRE(pool_type::kRejectedID == pool.submit(job{ 2, 0 }));
+  CATCH_REQUIRE(pool.collect().empty());
+  pool.term();
+}
+
+CATCH_TEST_CASE("Pinning", "[multiprocess::process_pool]") {
+  const size_t kN_WORKERS = 4;
+  std::vector<int> cores = mp::cores_across_sockets(kN_WORKERS);
+  CATCH_REQUIRE(kN_WORKERS == cores.size());
+
+  cpu_set_t allowed;
+  CPU_ZERO(&allowed);
+  CATCH_REQUIRE(0 == sched_getaffinity(0, sizeof(allowed), &allowed));
+  for (int c : cores) {
+    CATCH_REQUIRE(CPU_ISSET(static_cast<size_t>(c), &allowed));
+  } /* for(c..) */
+
+  mp::process_pool<job, affinity> pool(kN_WORKERS, read_affinity, true);
+
+  /*
+   * With no results collected in between, job i goes to worker i (the first
+   * worker with the fewest jobs in flight).
+   */
+  std::map<mp::process_pool<job, affinity>::job_id, size_t> ids;
+  for (size_t i = 0; i < kN_WORKERS; ++i) {
+    ids[pool.submit(job{ 0, 0 })] = i;
+  } /* for(i..) */
+
+  auto results = pool.wait_all();
+  CATCH_REQUIRE(kN_WORKERS == results.size());
+  for (auto& r : results) {
+    CATCH_REQUIRE(r.result.is_initialized());
+    CATCH_REQUIRE(1 == r.result->n_cpus);
+    CATCH_REQUIRE(cores[ids[r.id]] == r.result->cpu);
+  } /* for(&r..) */
+}
@@ -0,0 +1,238 @@
+/**
+ * @file multiprocess-shm_ring-utest.cpp
+ *
+ * @copyright 2020 John Harwell, All rights reserved.
+ *
+ * This file is part of RCPPSW.
+ *
+ * RCPPSW is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * RCPPSW is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * RCPPSW.  If not, see <http://www.gnu.org/licenses/
+ */
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_PREFIX_ALL
+#include "catch.hpp"
+
+#include "rcppsw/multiprocess/futex_park.hpp"
+#include "rcppsw/multiprocess/shm_ring.hpp"
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace mp = rcppsw::multiprocess;
+
+/*******************************************************************************
+ * Helper Functions
+ ******************************************************************************/
+/* Anonymous shared mapping, which is inherited across fork() */
+static void* shm_map(size_t size) {
+  void* mem = mmap(nullptr,
+                   size,
+                   PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_ANONYMOUS,
+                   -1,
+                   0);
+  return MAP_FAILED == mem ? nullptr : mem;
+}
+
+/*
+ * Run \p f in a child process, which exits with the status \p f returns. The
+ * child does not return into Catch.
+ */
+template <typename TFunc>
+static pid_t spawn(const TFunc& f) {
+  pid_t pid = fork();
+  if (0 == pid) {
+    _exit(f());
+  }
+  return pid;
+}
+
+static int reap(pid_t pid) {
+  int status = -1;
+  if (pid != waitpid(pid, &status, 0) || !WIFEXITED(status)) {
+    return -1;
+  }
+  return WEXITSTATUS(status);
+}
+
+/* Record \c i of producer \c p: a header, then bytes derived from both */
+struct record {
+  uint32_t producer;
+  uint32_t seq;
+};
+
+static size_t record_len(uint32_t seq) { return sizeof(record) + seq % 200; }
+
+static void record_fill(uint8_t* data, uint32_t producer, uint32_t seq) {
+  record rec = { producer, seq };
+  std::memcpy(data, &rec, sizeof(rec));
+  std::memset(data + sizeof(rec),
+              static_cast<uint8_t>(producer + seq),
+              record_len(seq) - sizeof(rec));
+}
+
+static bool record_check(const uint8_t* data, size_t len, record* rec) {
+  std::memcpy(rec, data, sizeof(*rec));
+  if (len != record_len(rec->seq)) {
+    return false;
+  }
+  for (size_t i = sizeof(*rec); i < len; ++i) {
+    if (data[i] != static_cast<uint8_t>(rec->producer + rec->seq)) {
+      return false;
+    }
+  } /* for(i..) */
+  return true;
+}
+
+/*******************************************************************************
+ * Test Cases
+ ******************************************************************************/
+CATCH_TEST_CASE("Futex Park", "[multiprocess::futex_park]") {
+  struct shared {
+    mp::futex_park park;
+    std::atomic<uint32_t> flag;
+    std::atomic<uint32_t> ack;
+  };
+  auto* shm = new (shm_map(sizeof(shared))) shared{};
+
+  /* the child sleeps in the kernel until the parent notifies it */
+  pid_t pid = spawn([&] {
+    shm->park.wait([&] { return 0 != shm->flag.load(); });
+    shm->ack = 1;
+    return 0;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  CATCH_REQUIRE(0 == shm->ack.load());
+  shm->flag = 1;
+  shm->park.notify();
+  CATCH_REQUIRE(0 == reap(pid));
+  CATCH_REQUIRE(1 == shm->ack.load());
+
+  /* and gives up after the timeout if nothing happens */
+  pid = spawn([&] {
+    bool ok = shm->park.wait_for([&] { return 2 == shm->flag.load(); },
+                                 std::chrono::milliseconds(20));
+    return ok ? 1 : 0;
+  });
+  CATCH_REQUIRE(0 == reap(pid));
+
+  munmap(shm, sizeof(shared));
+}
+
+CATCH_TEST_CASE("SPSC", "[multiprocess::shm_ring]") {
+  /* small ring, so that both sides end up waiting, and records wrap */
+  constexpr uint32_t kCount = 20000;
+  size_t size = mp::spsc_shm_ring::footprint(1024);
+  void* mem = shm_map(size);
+  auto* ring = mp::spsc_shm_ring::create(mem, 1024);
+  CATCH_REQUIRE(1024 == ring->capacity());
+
+  pid_t pid = spawn([&] {
+    auto* child = mp::spsc_shm_ring::attach(mem);
+    for (uint32_t i = 0; i < kCount; ++i) {
+      auto res = child->reserve(record_len(i));
+      if (!res.valid()) {
+        return 1;
+      }
+      record_fill(res.data(), 0, i);
+      child->commit(res);
+    } /* for(i..) */
+    return 0;
+  });
+
+  uint32_t expected = 0;
+  bool ok = true;
+  while (expected < kCount) {
+    ring->wait_consume(
+        [&](const uint8_t* data, size_t len) {
+          record rec{};
+          ok = ok && record_check(data, len, &rec) && expected == rec.seq;
+          ++expected;
+        },
+        8);
+  } /* while() */
+  CATCH_REQUIRE(0 == reap(pid));
+  CATCH_REQUIRE(ok);
+  CATCH_REQUIRE(ring->empty());
+
+  /* a consumer waiting in another process is woken by interrupt() */
+  pid = spawn([&] {
+    return 0 == ring->wait_consume([](const uint8_t*, size_t) {}, 1) ? 0 : 1;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  ring->interrupt();
+  CATCH_REQUIRE(0 == reap(pid));
+
+  munmap(mem, size);
+}
+
+CATCH_TEST_CASE("MPSC", "[multiprocess::shm_ring]") {
+  constexpr uint32_t kProducers = 3;
+  constexpr uint32_t kPerProducer = 5000;
+  size_t size = mp::mpsc_shm_ring::footprint(2048);
+  void* mem = shm_map(size);
+  auto* ring = mp::mpsc_shm_ring::create(mem, 2048);
+
+  std::vector<pid_t> pids;
+  for (uint32_t p = 0; p < kProducers; ++p) {
+    pids.push_back(spawn([&] {
+      auto* child = mp::mpsc_shm_ring::attach(mem);
+      std::vector<uint8_t> buf(record_len(kPerProducer));
+      for (uint32_t i = 0; i < kPerProducer; ++i) {
+        record_fill(buf.data(), p, i);
+        if (!child->write(buf.data(), record_len(i))) {
+          return 1;
+        }
+      } /* for(i..) */
+      return 0;
+    }));
+  } /* for(p..) */
+
+  /* records from each producer arrive intact and in order */
+  std::vector<uint32_t> next(kProducers, 0);
+  uint32_t n = 0;
+  bool ok = true;
+  while (n < kProducers * kPerProducer) {
+    n += static_cast<uint32_t>(ring->wait_consume(
+        [&](const uint8_t* data, size_t len) {
+          record rec{};
+          ok = ok && record_check(data, len, &rec) &&
+               rec.producer < kProducers && next[rec.producer] == rec.seq;
+          if (rec.producer < kProducers) {
+            ++next[rec.producer];
+          }
+        },
+        16));
+  } /* while() */
+  for (auto pid : pids) {
+    CATCH_REQUIRE(0 == reap(pid));
+  } /* for(pid..) */
+  CATCH_REQUIRE(ok);
+  CATCH_REQUIRE(ring->empty());
+
+  munmap(mem, size);
+}
@@ -0,0 +1,132 @@
+/**
+ * @file multithread-concurrent_vector-utest.cpp
+ *
+ * @copyright 2020 John Harwell, All rights reserved.
+ *
+ * This file is part of RCPPSW.
+ *
+ * RCPPSW is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * RCPPSW is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * RCPPSW.  If not, see <http://www.gnu.org/licenses/
+ */
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_PREFIX_ALL
+#include "catch.hpp"
+
+#include "rcppsw/multithread/concurrent_vector.hpp"
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace mt = rcppsw::multithread;
+
+/*******************************************************************************
+ * Test Cases
+ ******************************************************************************/
+CATCH_TEST_CASE("Sanity", "[multithread::concurrent_vector]") {
+  mt::concurrent_vector<std::string> vec;
+  CATCH_REQUIRE(vec.empty());
+  CATCH_REQUIRE(!vec.published(0));
+
+  /* crosses several chunk boundaries (32, 96, 224, ...) */
+  for (size_t i = 0; i < 1000; ++i) {
+    CATCH_REQUIRE(i == vec.push_back(std::to_string(i)));
+  } /* for(i..) */
+  CATCH_REQUIRE(1000 == vec.size());
+
+  /* references stay valid as the vector grows */
+  std::string& first = vec[0];
+  std::string& last = vec[999];
+  vec.emplace_back(3UL, 'x');
+  CATCH_REQUIRE("0" == first);
+  CATCH_REQUIRE("999" == last);
+  CATCH_REQUIRE("xxx" == vec[1000]);
+  CATCH_REQUIRE(vec.published(1000));
+  CATCH_REQUIRE(!vec.published(1001));
+
+  auto flat = vec.flatten();
+  CATCH_REQUIRE(1001 == flat.size());
+  for (size_t i = 0; i < 1000; ++i) {
+    CATCH_REQUIRE(std::to_string(i) == flat[i]);
+  } /* for(i..) */
+
+  vec.clear();
+  CATCH_REQUIRE(vec.empty());
+  vec.push_back("again");
+  CATCH_REQUIRE("again" == vec[0]);
+}
+
+CATCH_TEST_CASE("Destruction", "[multithread::concurrent_vector]") {
+  auto shared = std::make_shared<int>(0);
+  {
+    mt::concurrent_vector<std::shared_ptr<int>> vec;
+    for (size_t i = 0; i < 100; ++i) {
+      vec.push_back(shared);
+    } /* for(i..) */
+    CATCH_REQUIRE(101 == shared.use_count());
+  }
+  CATCH_REQUIRE(1 == shared.use_count());
+}
+
+CATCH_TEST_CASE("Concurrent", "[multithread::concurrent_vector]") {
+  constexpr size_t kThreads = 4;
+  constexpr size_t kPerThread = 50000;
+  mt::concurrent_vector<size_t> vec;
+  std::atomic<bool> done{ false };
+  std::atomic<size_t> n_bad{ 0 };
+
+  /* readers only ever see fully constructed elements */
+  std::thread reader([&] {
+    while (!done.load()) {
+      vec.for_each([&](size_t, const size_t& v) {
+        if (v >= kThreads * kPerThread) {
+          ++n_bad;
+        }
+      });
+    } /* while() */
+  });
+
+  std::vector<std::thread> writers;
+  for (size_t t = 0; t < kThreads; ++t) {
+    writers.emplace_back([&, t] {
+      for (size_t i = 0; i < kPerThread; ++i) {
+        size_t idx = vec.push_back(t * kPerThread + i);
+        if (vec[idx] != t * kPerThread + i) {
+          ++n_bad;
+        }
+      } /* for(i..) */
+    });
+  } /* for(t..) */
+  for (auto& w : writers) {
+    w.join();
+  } /* for(&w..) */
+  done = true;
+  reader.join();
+
+  CATCH_REQUIRE(0 == n_bad);
+  auto flat = vec.flatten();
+  CATCH_REQUIRE(kThreads * kPerThread == flat.size());
+  std::sort(flat.begin(), flat.end());
+  for (size_t i = 0; i < flat.size(); ++i) {
+    CATCH_REQUIRE(i == flat[i]);
+  } /* for(i..) */
+}
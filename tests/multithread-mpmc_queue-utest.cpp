@@ -0,0 +1,190 @@
+/**
+ * @file multithread-mpmc_queue-utest.cpp
+ *
+ * @copyright 2020 John Harwell, All rights reserved.
+ *
+ * This file is part of RCPPSW.
+ *
+ * RCPPSW is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * RCPPSW is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * RCPPSW.  If not, see <http://www.gnu.org/licenses/
+ */
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_PREFIX_ALL
+#include "catch.hpp"
+
+#include "benchmark.hpp"
+
+#include "rcppsw/multithread/mpmc_queue.hpp"
+#include "rcppsw/multithread/mt_queue.hpp"
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace mt = rcppsw::multithread;
+
+/*******************************************************************************
+ * Helper Functions
+ ******************************************************************************/
+/*
+ * Push \p per_thread elements through \p queue from each of \p n producers to
+ * \p n consumers, returning the sum of the dequeued elements.
+ */
+template <typename TQueue>
+static size_t pump(TQueue& queue, size_t n, size_t per_thread) {
+  std::atomic<size_t> sum{ 0 };
+  std::vector<std::thread> threads;
+  for (size_t p = 0; p < n; ++p) {
+    threads.emplace_back([&, p] {
+      for (size_t i = 0; i < per_thread; ++i) {
+        queue.enqueue(p * per_thread + i);
+      } /* for(i..) */
+    });
+    threads.emplace_back([&] {
+      size_t local = 0;
+      for (size_t i = 0; i < per_thread; ++i) {
+        local += queue.dequeue();
+      } /* for(i..) */
+      sum += local;
+    });
+  } /* for(p..) */
+  for (auto& t : threads) {
+    t.join();
+  } /* for(&t..) */
+  return sum;
+}
+
+/*******************************************************************************
+ * Test Cases
+ ******************************************************************************/
+CATCH_TEST_CASE("Sanity", "[multithread::mpmc_queue]") {
+  mt::mpmc_queue<int> queue(5);
+  CATCH_REQUIRE(8 == queue.capacity());
+  CATCH_REQUIRE(0 == queue.size_approx());
+
+  int out = -1;
+  CATCH_REQUIRE(!queue.try_dequeue(out));
+  for (int i = 0; i < 8; ++i) {
+    CATCH_REQUIRE(queue.try_enqueue(i));
+  } /* for(i..) */
+  CATCH_REQUIRE(!queue.try_enqueue(8));
+  CATCH_REQUIRE(8 == queue.size_approx());
+
+  /* FIFO, including across wrap around */
+  for (int i = 0; i < 20; ++i) {
+    CATCH_REQUIRE(queue.try_dequeue(out));
+    CATCH_REQUIRE(i == out);
+    CATCH_REQUIRE(queue.try_enqueue(i + 8));
+  } /* for(i..) */
+  CATCH_REQUIRE(20 == queue.dequeue());
+}
+
+CATCH_TEST_CASE("Move Only", "[multithread::mpmc_queue]") {
+  mt::mpmc_queue<std::unique_ptr<int>> queue(4);
+  CATCH_REQUIRE(queue.try_emplace(new int(3)));
+  queue.enqueue(std::make_unique<int>(4));
+
+  std::unique_ptr<int> out;
+  CATCH_REQUIRE(queue.try_dequeue(out));
+  CATCH_REQUIRE(3 == *out);
+  CATCH_REQUIRE(4 == *queue.dequeue());
+
+  /* elements left in the queue are destroyed with it */
+  auto shared = std::make_shared<int>(5);
+  {
+    mt::mpmc_queue<std::shared_ptr<int>> tmp(4);
+    tmp.enqueue(shared);
+    tmp.enqueue(shared);
+    CATCH_REQUIRE(3 == shared.use_count());
+  }
+  CATCH_REQUIRE(1 == shared.use_count());
+}
+
+CATCH_TEST_CASE("Concurrent", "[multithread::mpmc_queue]") {
+  /*
+   * A small queue, so that both producers and consumers end up blocking, and
+   * each producer's elements must be dequeued in the order it enqueued them.
+   */
+  constexpr size_t kProducers = 3;
+  constexpr size_t kConsumers = 3;
+  constexpr size_t kPerProducer = 20000;
+  mt::mpmc_queue<size_t> queue(16);
+  std::atomic<size_t> sum{ 0 };
+  std::atomic<size_t> n_out_of_order{ 0 };
+
+  std::vector<std::thread> threads;
+  for (size_t p = 0; p < kProducers; ++p) {
+    threads.emplace_back([&, p] {
+      for (size_t i = 0; i < kPerProducer; ++i) {
+        queue.enqueue(p * kPerProducer + i);
+      } /* for(i..) */
+    });
+  } /* for(p..) */
+  for (size_t c = 0; c < kConsumers; ++c) {
+    threads.emplace_back([&] {
+      std::vector<size_t> last(kProducers, 0);
+      std::vector<bool> seen(kProducers, false);
+      for (size_t i = 0; i < kProducers * kPerProducer / kConsumers; ++i) {
+        size_t v = queue.dequeue();
+        size_t p = v / kPerProducer;
+        if (seen[p] && v <= last[p]) {
+          ++n_out_of_order;
+        }
+        seen[p] = true;
+        last[p] = v;
+        sum += v;
+      } /* for(i..) */
+    });
+  } /* for(c..) */
+  for (auto& t : threads) {
+    t.join();
+  } /* for(&t..) */
+
+  size_t n = kProducers * kPerProducer;
+  CATCH_REQUIRE(0 == n_out_of_order);
+  CATCH_REQUIRE(n * (n - 1) / 2 == sum);
+  CATCH_REQUIRE(0 == queue.size_approx());
+}
+
+CATCH_TEST_CASE("Benchmark", "[.benchmark][multithread::mpmc_queue]") {
+  /* the same total # of elements for each thread count */
+  constexpr size_t kTotal = 1 << 21;
+
+  for (size_t n : { 1UL, 4UL, 16UL }) {
+    size_t per_thread = kTotal / n;
+    size_t expected = kTotal * (kTotal - 1) / 2;
+
+    mt::mpmc_queue<size_t> mpmc(1024);
+    mt::mt_queue<size_t> locked;
+    size_t s1 = 0;
+    size_t s2 = 0;
+    double mpmc_ms = time_ms([&] { s1 = pump(mpmc, n, per_thread); });
+    double locked_ms = time_ms([&] { s2 = pump(locked, n, per_thread); });
+    CATCH_REQUIRE(expected == s1);
+    CATCH_REQUIRE(expected == s2);
+
+    std::printf("%2zuP/%2zuC: mpmc_queue=%.1f Mops/s mt_queue=%.1f Mops/s\n",
+                n,
+                n,
+                kTotal / mpmc_ms / 1000.0,
+                kTotal / locked_ms / 1000.0);
+  } /* for(n..) */
+}
@@ -0,0 +1,104 @@
+/**
+ * @file multithread-mt_double_buffer-utest.cpp
+ *
+ * @copyright 2020 John Harwell, All rights reserved.
+ *
+ * This file is part of RCPPSW.
+ *
+ * RCPPSW is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * RCPPSW is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * RCPPSW.  If not, see <http://www.gnu.org/licenses/
+ */
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_PREFIX_ALL
+#include "catch.hpp"
+
+#include "rcppsw/multithread/mt_double_buffer.hpp"
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace mt = rcppsw::multithread;
+
+/*******************************************************************************
+ * Test Cases
+ ******************************************************************************/
+CATCH_TEST_CASE("Swap", "[multithread::mt_double_buffer]") {
+  mt::mt_double_buffer<std::vector<int>> buf(4UL, 0);
+  CATCH_REQUIRE(0 == buf.epoch());
+
+  buf.back().assign(4, 1);
+  CATCH_REQUIRE(0 == buf.front()[0]);
+  {
+    auto guard = buf.read();
+    CATCH_REQUIRE(0 == guard.epoch());
+    CATCH_REQUIRE(0 == (*guard)[0]);
+  }
+
+  buf.swap();
+  CATCH_REQUIRE(1 == buf.epoch());
+  CATCH_REQUIRE(1 == buf.front()[0]);
+  CATCH_REQUIRE(0 == buf.back()[0]);
+
+  auto guard = buf.read();
+  CATCH_REQUIRE(1 == guard.epoch());
+  CATCH_REQUIRE(4 == guard->size());
+  CATCH_REQUIRE(1 == (*guard)[3]);
+}
+
+CATCH_TEST_CASE("Concurrent", "[multithread::mt_double_buffer]") {
+  /*
+   * The writer fills the back buffer with the # of the swap which will
+   * publish it, so a reader which sees anything else in the buffer it pinned
+   * saw the writer modifying it.
+   */
+  constexpr size_t kSwaps = 2000;
+  constexpr size_t kReaders = 3;
+  mt::mt_double_buffer<std::vector<size_t>> buf(1024UL, 0UL);
+  std::atomic<bool> done{ false };
+  std::atomic<size_t> n_torn{ 0 };
+
+  std::vector<std::thread> readers;
+  for (size_t r = 0; r < kReaders; ++r) {
+    readers.emplace_back([&] {
+      while (!done.load()) {
+        auto guard = buf.read();
+        size_t epoch = guard.epoch();
+        if (!std::all_of(guard->begin(), guard->end(), [&](size_t v) {
+              return v == epoch;
+            })) {
+          ++n_torn;
+        }
+      } /* while() */
+    });
+  } /* for(r..) */
+
+  for (size_t i = 1; i <= kSwaps; ++i) {
+    std::fill(buf.back().begin(), buf.back().end(), i);
+    buf.swap();
+  } /* for(i..) */
+  done = true;
+  for (auto& t : readers) {
+    t.join();
+  } /* for(&t..) */
+
+  CATCH_REQUIRE(0 == n_torn);
+  CATCH_REQUIRE(kSwaps == buf.epoch());
+}
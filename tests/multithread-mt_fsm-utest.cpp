@@ -0,0 +1,218 @@
+/**
+ * @file multithread-mt_fsm-utest.cpp
+ *
+ * @copyright 2020 John Harwell, All rights reserved.
+ *
+ * This file is part of RCPPSW.
+ *
+ * RCPPSW is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * RCPPSW is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * RCPPSW.  If not, see <http://www.gnu.org/licenses/
+ */
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <limits>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_PREFIX_ALL
+#include "catch.hpp"
+
+#include "rcppsw/multithread/mt_fsm.hpp"
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace mt = rcppsw::multithread;
+namespace fsm = rcppsw::patterns::fsm;
+
+/*******************************************************************************
+ * Helper Classes
+ ******************************************************************************/
+/* Each event moves the FSM to the next state around the ring */
+class ring_fsm : public mt::mt_fsm {
+ public:
+  enum states { STATE1, STATE2, STATE3, ST_MAX_STATES };
+
+  explicit ring_fsm(mt_fsm::dispatch mode, size_t capacity = 0)
+      : mt_fsm(ST_MAX_STATES, STATE1, mode, capacity),
+        RCPPSW_FSM_DEFINE_STATE_MAP(mc_state_map,
+                                    RCPPSW_FSM_STATE_MAP_ENTRY(&s1),
+                                    RCPPSW_FSM_STATE_MAP_ENTRY(&s2),
+                                    RCPPSW_FSM_STATE_MAP_ENTRY(&s3)) {}
+
+  size_t n_run{ 0 };
+  /* The state handling the event which would be run n-th throws instead */
+  size_t throw_at{ std::numeric_limits<size_t>::max() };
+
+  RCPPSW_FSM_STATE_DECLARE_ND(ring_fsm, s1);
+  RCPPSW_FSM_STATE_DECLARE_ND(ring_fsm, s2);
+  RCPPSW_FSM_STATE_DECLARE_ND(ring_fsm, s3);
+
+  RCPPSW_FSM_DECLARE_STATE_MAP(state_map, mc_state_map, ST_MAX_STATES);
+  RCPPSW_FSM_DEFINE_STATE_MAP_ACCESSOR(state_map, index) override {
+    return &mc_state_map[index];
+  }
+
+ private:
+  fsm::event_signal::type step(uint8_t next) {
+    /* the state being transitioned to is run with no data, and stays put */
+    if (nullptr != event_data_release()) {
+      if (n_run + 1 == throw_at) {
+        throw_at = std::numeric_limits<size_t>::max();
+        throw std::runtime_error("step");
+      }
+      ++n_run;
+      internal_event(next);
+    }
+    return fsm::event_signal::ekHANDLED;
+  }
+};
+
+RCPPSW_FSM_STATE_DEFINE_ND(ring_fsm, s1) { return step(STATE2); }
+RCPPSW_FSM_STATE_DEFINE_ND(ring_fsm, s2) { return step(STATE3); }
+RCPPSW_FSM_STATE_DEFINE_ND(ring_fsm, s3) { return step(STATE1); }
+
+/*******************************************************************************
+ * Test Cases
+ ******************************************************************************/
+CATCH_TEST_CASE("Locked", "[multithread::mt_fsm]") {
+  ring_fsm ring(mt::mt_fsm::dispatch::ekLOCKED);
+  ring.inject_event(fsm::event_signal::ekRUN, fsm::event_type::ekNORMAL);
+  CATCH_REQUIRE(ring_fsm::STATE2 == ring.current_state());
+  CATCH_REQUIRE(1 == ring.n_run);
+}
+
+CATCH_TEST_CASE("Inbox", "[multithread::mt_fsm]") {
+  ring_fsm ring(mt::mt_fsm::dispatch::ekINBOX);
+
+  /*
+   * Injected through the base class too, and nothing runs until the owner
+   * drains the inbox, at which point each event goes to the state current at
+   * that time, so three events go around the ring once.
+   */
+  fsm::base_fsm& base = ring;
+  ring.inject_event(fsm::event_signal::ekRUN, fsm::event_type::ekNORMAL);
+  base.inject_event(std::make_unique<fsm::event_data>(
+      fsm::event_signal::ekRUN, fsm::event_type::ekNORMAL));
+  base.inject_event(fsm::event_signal::ekRUN, fsm::event_type::ekNORMAL);
+  CATCH_REQUIRE(0 == ring.n_run);
+  CATCH_REQUIRE(ring_fsm::STATE1 == ring.current_state());
+
+  CATCH_REQUIRE(3 == ring.drain());
+  CATCH_REQUIRE(3 == ring.n_run);
+  CATCH_REQUIRE(ring_fsm::STATE1 == ring.current_state());
+  CATCH_REQUIRE(0 == ring.drain());
+
+  auto stats = ring.stats();
+  CATCH_REQUIRE(3 == stats.n_posted);
+  CATCH_REQUIRE(3 == stats.n_processed);
+  CATCH_REQUIRE(0 == stats.n_rejected);
+}
+
+CATCH_TEST_CASE("Bounded Inbox", "[multithread::mt_fsm]") {
+  constexpr size_t kThreads = 3;
+  constexpr size_t kPerThread = 2000;
+  ring_fsm ring(mt::mt_fsm::dispatch::ekINBOX, 16);
+
+  std::vector<std::thread> posters;
+  for (size_t t = 0; t < kThreads; ++t) {
+    posters.emplace_back([&] {
+      for (size_t i = 0; i < kPerThread; ++i) {
+        ring.inject_event(fsm::event_signal::ekRUN, fsm::event_type::ekNORMAL);
+      } /* for(i..) */
+    });
+  } /* for(t..) */
+
+  /* the stats must stay consistent while events are posted/dropped */
+  bool ok = true;
+  while (ring.stats().n_posted + ring.stats().n_rejected <
+         kThreads * kPerThread) {
+    ring.drain();
+    auto stats = ring.stats();
+    ok = ok && stats.n_processed <= stats.n_posted;
+  } /* while() */
+  for (auto& t : posters) {
+    t.join();
+  } /* for(&t..) */
+  ring.drain();
+
+  auto stats = ring.stats();
+  CATCH_REQUIRE(ok);
+  CATCH_REQUIRE(kThreads * kPerThread == stats.n_posted + stats.n_rejected);
+  CATCH_REQUIRE(stats.n_posted == stats.n_processed);
+  CATCH_REQUIRE(stats.n_processed == ring.n_run);
+}
+
+CATCH_TEST_CASE("Backpressure", "[multithread::mt_fsm]") {
+  ring_fsm ring(mt::mt_fsm::dispatch::ekINBOX, 4);
+  for (size_t i = 0; i < 4; ++i) {
+    CATCH_REQUIRE(ring.try_inject_event(fsm::event_signal::ekRUN,
+                                        fsm::event_type::ekNORMAL));
+  } /* for(i..) */
+  CATCH_REQUIRE(!ring.try_inject_event(std::make_unique<fsm::event_data>(
+      fsm::event_signal::ekRUN, fsm::event_type::ekNORMAL)));
+  ring.inject_event(fsm::event_signal::ekRUN, fsm::event_type::ekNORMAL);
+  CATCH_REQUIRE(2 == ring.stats().n_rejected);
+
+  CATCH_REQUIRE(4 == ring.drain());
+  CATCH_REQUIRE(ring.try_inject_event(fsm::event_signal::ekRUN,
+                                      fsm::event_type::ekNORMAL));
+  CATCH_REQUIRE(1 == ring.drain());
+  CATCH_REQUIRE(5 == ring.n_run);
+
+  /* never rejected when unbounded/locked */
+  ring_fsm unbounded(mt::mt_fsm::dispatch::ekINBOX);
+  ring_fsm locked(mt::mt_fsm::dispatch::ekLOCKED);
+  for (size_t i = 0; i < 100; ++i) {
+    CATCH_REQUIRE(unbounded.try_inject_event(fsm::event_signal::ekRUN,
+                                             fsm::event_type::ekNORMAL));
+    CATCH_REQUIRE(locked.try_inject_event(fsm::event_signal::ekRUN,
+                                          fsm::event_type::ekNORMAL));
+  } /* for(i..) */
+  CATCH_REQUIRE(100 == unbounded.drain());
+  CATCH_REQUIRE(100 == locked.n_run);
+}
+
+CATCH_TEST_CASE("Throwing State", "[multithread::mt_fsm]") {
+  for (size_t capacity : { 0UL, 16UL }) {
+    ring_fsm ring(mt::mt_fsm::dispatch::ekINBOX, capacity);
+    ring.throw_at = 3;
+    for (size_t i = 0; i < 6; ++i) {
+      ring.inject_event(fsm::event_signal::ekRUN, fsm::event_type::ekNORMAL);
+    } /* for(i..) */
+    CATCH_REQUIRE_THROWS_AS(ring.drain(), std::runtime_error);
+    CATCH_REQUIRE(2 == ring.n_run);
+    CATCH_REQUIRE(ring_fsm::STATE3 == ring.current_state());
+
+    /*
+     * The event which threw is gone, and the ones after it are still queued,
+     * ahead of anything injected later.
+     */
+    ring.inject_event(fsm::event_signal::ekRUN, fsm::event_type::ekNORMAL);
+    size_t n = ring.drain();
+    n += ring.drain();
+    CATCH_REQUIRE(4 == n);
+    CATCH_REQUIRE(6 == ring.n_run);
+    CATCH_REQUIRE(ring_fsm::STATE1 == ring.current_state());
+    CATCH_REQUIRE(0 == ring.drain());
+
+    /* and anything left over when the FSM is destroyed is freed */
+    ring.throw_at = 7;
+    ring.inject_event(fsm::event_signal::ekRUN, fsm::event_type::ekNORMAL);
+    ring.inject_event(fsm::event_signal::ekRUN, fsm::event_type::ekNORMAL);
+    CATCH_REQUIRE_THROWS_AS(ring.drain(), std::runtime_error);
+  } /* for(capacity..) */
+}
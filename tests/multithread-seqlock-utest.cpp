@@ -0,0 +1,194 @@
+/**
+ * @file multithread-seqlock-utest.cpp
+ *
+ * @copyright 2020 John Harwell, All rights reserved.
+ *
+ * This file is part of RCPPSW.
+ *
+ * RCPPSW is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * RCPPSW is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * RCPPSW.  If not, see <http://www.gnu.org/licenses/
+ */
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_PREFIX_ALL
+#include "catch.hpp"
+
+#include "benchmark.hpp"
+
+#include "rcppsw/multithread/seqlock.hpp"
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace mt = rcppsw::multithread;
+
+/*******************************************************************************
+ * Helper Classes
+ ******************************************************************************/
+/*
+ * Not a multiple of the word size, and all fields always equal, so torn reads
+ * are detectable.
+ */
+struct triple {
+  uint64_t a;
+  uint64_t b;
+  uint32_t c;
+};
+
+/* 32 bytes, as a typical small shared record */
+struct record {
+  uint64_t a;
+  uint64_t b;
+  uint64_t c;
+  uint64_t d;
+};
+
+/* trivially copyable, but not default constructible */
+struct no_default {
+  explicit no_default(int v) : value(v) {}
+  int value;
+};
+
+/*******************************************************************************
+ * Helper Functions
+ ******************************************************************************/
+/*
+ * Run \p read() \p n_reads times from each of \p n_threads threads, returning
+ * the total wall time in ms. Each read returns a value which is summed, so the
+ * reads are not optimized away.
+ */
+template <typename TFunc>
+static double read_scaling(size_t n_threads, size_t n_reads, const TFunc& read) {
+  std::atomic<uint64_t> sink{ 0 };
+  return time_ms([&] {
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < n_threads; ++t) {
+      threads.emplace_back([&] {
+        uint64_t local = 0;
+        for (size_t i = 0; i < n_reads; ++i) {
+          local += read();
+        } /* for(i..) */
+        sink += local;
+      });
+    } /* for(t..) */
+    for (auto& t : threads) {
+      t.join();
+    } /* for(&t..) */
+  });
+}
+
+/*******************************************************************************
+ * Test Cases
+ ******************************************************************************/
+CATCH_TEST_CASE("Sanity", "[multithread::seqlock]") {
+  mt::seqlock<triple> lock(triple{ 1, 1, 1 });
+  CATCH_REQUIRE(0 == lock.version());
+  CATCH_REQUIRE(1 == lock.load().c);
+
+  lock.store(triple{ 2, 2, 2 });
+  lock.update([](triple& t) { t.c += 5; });
+  CATCH_REQUIRE(2 == lock.version());
+  CATCH_REQUIRE(2 == lock.load().a);
+  CATCH_REQUIRE(7 == lock.load().c);
+
+  mt::seqlock<no_default> nd(no_default(3));
+  nd.update([](no_default& v) { v.value *= 2; });
+  CATCH_REQUIRE(6 == nd.load().value);
+}
+
+CATCH_TEST_CASE("Concurrent", "[multithread::seqlock]") {
+  constexpr uint32_t kWrites = 20000;
+  mt::seqlock<triple> lock(triple{ 0, 0, 0 });
+  std::atomic<bool> done{ false };
+  std::atomic<size_t> n_torn{ 0 };
+
+  std::vector<std::thread> readers;
+  for (size_t r = 0; r < 3; ++r) {
+    readers.emplace_back([&] {
+      uint64_t last = 0;
+      while (!done.load()) {
+        triple t = lock.load();
+        if (t.a != t.b || t.a != t.c || t.a < last) {
+          ++n_torn;
+        }
+        last = t.a;
+      } /* while() */
+    });
+  } /* for(r..) */
+
+  /* two writers, which must not lose each other's updates */
+  auto writer = [&] {
+    for (uint32_t i = 0; i < kWrites / 2; ++i) {
+      lock.update([](triple& t) {
+        ++t.a;
+        ++t.b;
+        ++t.c;
+      });
+    } /* for(i..) */
+  };
+  std::thread w1(writer);
+  std::thread w2(writer);
+  w1.join();
+  w2.join();
+  done = true;
+  for (auto& t : readers) {
+    t.join();
+  } /* for(&t..) */
+
+  CATCH_REQUIRE(0 == n_torn);
+  CATCH_REQUIRE(kWrites == lock.load().c);
+  CATCH_REQUIRE(kWrites == lock.version());
+}
+
+CATCH_TEST_CASE("Benchmark", "[.benchmark][multithread::seqlock]") {
+  constexpr size_t kReads = 2000000;
+  const record init{ 1, 2, 3, 4 };
+
+  std::mutex mtx;
+  std::shared_mutex smtx;
+  record locked = init;
+  mt::seqlock<record> seq(init);
+
+  for (size_t n : { 1UL, 2UL, 4UL }) {
+    double mutex_ms = read_scaling(n, kReads, [&] {
+      std::lock_guard<std::mutex> lock(mtx);
+      record r = locked;
+      return r.a + r.d;
+    });
+    double shared_ms = read_scaling(n, kReads, [&] {
+      std::shared_lock<std::shared_mutex> lock(smtx);
+      record r = locked;
+      return r.a + r.d;
+    });
+    double seq_ms = read_scaling(n, kReads, [&] {
+      record r = seq.load();
+      return r.a + r.d;
+    });
+    std::printf("%zu readers: mutex=%.1fms shared_mutex=%.1fms "
+                "seqlock=%.1fms\n",
+                n,
+                mutex_ms,
+                shared_ms,
+                seq_ms);
+  } /* for(n..) */
+}
@@ -0,0 +1,184 @@
+/**
+ * @file multithread-snapshot-utest.cpp
+ *
+ * @copyright 2020 John Harwell, All rights reserved.
+ *
+ * This file is part of RCPPSW.
+ *
+ * RCPPSW is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * RCPPSW is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * RCPPSW.  If not, see <http://www.gnu.org/licenses/
+ */
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_PREFIX_ALL
+#include "catch.hpp"
+
+#include "benchmark.hpp"
+
+#include "rcppsw/multithread/snapshot.hpp"
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace mt = rcppsw::multithread;
+
+/*******************************************************************************
+ * Helper Classes
+ ******************************************************************************/
+/* 32 bytes, as a typical small shared record */
+struct record {
+  uint64_t a;
+  uint64_t b;
+  uint64_t c;
+  uint64_t d;
+};
+
+/*******************************************************************************
+ * Helper Functions
+ ******************************************************************************/
+/*
+ * Run \p read() \p n_reads times from each of \p n_threads threads, returning
+ * the total wall time in ms. Each read returns a value which is summed, so the
+ * reads are not optimized away.
+ */
+template <typename TFunc>
+static double read_scaling(size_t n_threads, size_t n_reads, const TFunc& read) {
+  std::atomic<uint64_t> sink{ 0 };
+  return time_ms([&] {
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < n_threads; ++t) {
+      threads.emplace_back([&] {
+        uint64_t local = 0;
+        for (size_t i = 0; i < n_reads; ++i) {
+          local += read();
+        } /* for(i..) */
+        sink += local;
+      });
+    } /* for(t..) */
+    for (auto& t : threads) {
+      t.join();
+    } /* for(&t..) */
+  });
+}
+
+/*******************************************************************************
+ * Test Cases
+ ******************************************************************************/
+CATCH_TEST_CASE("Sanity", "[multithread::snapshot]") {
+  mt::snapshot<std::vector<int>> snap(
+      std::make_shared<const std::vector<int>>(3, 1));
+  {
+    auto guard = snap.read();
+    CATCH_REQUIRE(3 == guard->size());
+    CATCH_REQUIRE(1 == (*guard)[0]);
+  }
+
+  /* shared versions outlive later updates */
+  auto old = snap.load();
+  snap.update([](std::vector<int>& v) { v.push_back(2); });
+  CATCH_REQUIRE(3 == old->size());
+  CATCH_REQUIRE(4 == snap.load()->size());
+
+  snap.store(std::make_shared<const std::vector<int>>(1, 7));
+  CATCH_REQUIRE(7 == snap.read()->at(0));
+  CATCH_REQUIRE(3 == old->size());
+}
+
+CATCH_TEST_CASE("Concurrent", "[multithread::snapshot]") {
+  /*
+   * Every version is a vector whose elements are all the same, so a reader
+   * seeing a version being modified or destroyed would see a mix.
+   */
+  constexpr int kUpdates = 2000;
+  mt::snapshot<std::vector<int>> snap(
+      std::make_shared<const std::vector<int>>(256, 0));
+  std::atomic<bool> done{ false };
+  std::atomic<size_t> n_bad{ 0 };
+
+  std::vector<std::thread> readers;
+  for (size_t r = 0; r < 3; ++r) {
+    readers.emplace_back([&] {
+      int last = 0;
+      while (!done.load()) {
+        auto guard = snap.read();
+        int first = guard->front();
+        if (first < last || !std::all_of(guard->begin(),
+                                         guard->end(),
+                                         [&](int v) { return v == first; })) {
+          ++n_bad;
+        }
+        last = first;
+      } /* while() */
+    });
+  } /* for(r..) */
+
+  for (int i = 1; i <= kUpdates; ++i) {
+    snap.update([&](std::vector<int>& v) { std::fill(v.begin(), v.end(), i); });
+  } /* for(i..) */
+  done = true;
+  for (auto& t : readers) {
+    t.join();
+  } /* for(&t..) */
+
+  CATCH_REQUIRE(0 == n_bad);
+  CATCH_REQUIRE(kUpdates == snap.load()->back());
+}
+
+CATCH_TEST_CASE("Benchmark", "[.benchmark][multithread::snapshot]") {
+  constexpr size_t kReads = 2000000;
+  auto init = std::make_shared<const record>(record{ 1, 2, 3, 4 });
+
+  std::mutex mtx;
+  std::shared_mutex smtx;
+  std::shared_ptr<const record> locked = init;
+  std::shared_ptr<const record> atomic = init;
+  mt::snapshot<record> snap(init);
+
+  for (size_t n : { 1UL, 2UL, 4UL }) {
+    double mutex_ms = read_scaling(n, kReads, [&] {
+      std::lock_guard<std::mutex> lock(mtx);
+      return locked->a + locked->d;
+    });
+    double shared_ms = read_scaling(n, kReads, [&] {
+      std::shared_lock<std::shared_mutex> lock(smtx);
+      return locked->a + locked->d;
+    });
+    double atomic_ms = read_scaling(n, kReads, [&] {
+      auto r = std::atomic_load(&atomic);
+      return r->a + r->d;
+    });
+    double snap_ms = read_scaling(n, kReads, [&] {
+      auto guard = snap.read();
+      return guard->a + guard->d;
+    });
+    std::printf("%zu readers: mutex=%.1fms shared_mutex=%.1fms "
+                "atomic_load(shared_ptr)=%.1fms snapshot=%.1fms\n",
+                n,
+                mutex_ms,
+                shared_ms,
+                atomic_ms,
+                snap_ms);
+  } /* for(n..) */
+}
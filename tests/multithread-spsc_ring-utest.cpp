@@ -0,0 +1,92 @@
+/**
+ * @file multithread-spsc_ring-utest.cpp
+ *
+ * @copyright 2020 John Harwell, All rights reserved.
+ *
+ * This file is part of RCPPSW.
+ *
+ * RCPPSW is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * RCPPSW is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * RCPPSW.  If not, see <http://www.gnu.org/licenses/
+ */
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_PREFIX_ALL
+#include "catch.hpp"
+
+#include "rcppsw/multithread/spsc_ring.hpp"
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace mt = rcppsw::multithread;
+
+/*******************************************************************************
+ * Test Cases
+ ******************************************************************************/
+CATCH_TEST_CASE("Batch", "[multithread::spsc_ring]") {
+  mt::spsc_ring<int, 8> ring;
+  std::vector<int> in = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+  CATCH_REQUIRE(8 == ring.push_n(in.begin(), in.size()));
+  CATCH_REQUIRE(!ring.try_push(8));
+  CATCH_REQUIRE(8 == ring.size_approx());
+
+  std::vector<int> out(5);
+  CATCH_REQUIRE(5 == ring.pop_n(out.begin(), 5));
+  CATCH_REQUIRE(std::vector<int>({ 0, 1, 2, 3, 4 }) == out);
+  CATCH_REQUIRE(2 == ring.push_n(in.begin() + 8, 2));
+
+  int v = -1;
+  for (int i = 5; i < 10; ++i) {
+    CATCH_REQUIRE(ring.try_pop(v));
+    CATCH_REQUIRE(i == v);
+  } /* for(i..) */
+  CATCH_REQUIRE(!ring.try_pop(v));
+}
+
+CATCH_TEST_CASE("Blocking", "[multithread::spsc_ring]") {
+  /* small ring, so that both sides end up parked */
+  constexpr size_t kCount = 100000;
+  mt::spsc_ring<size_t, 4> ring;
+
+  std::thread producer([&] {
+    for (size_t i = 0; i < kCount; ++i) {
+      ring.emplace(i);
+    } /* for(i..) */
+  });
+
+  size_t expected = 0;
+  bool ok = true;
+  while (expected < kCount) {
+    ring.wait_consume(
+        [&](size_t& v) {
+          ok = ok && v == expected;
+          ++expected;
+        },
+        3);
+  } /* while() */
+  producer.join();
+  CATCH_REQUIRE(ok);
+
+  /* a parked consumer is woken by interrupt(), which sticks */
+  std::thread consumer([&] { ring.wait_consume([](size_t&) {}, 1); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  ring.interrupt();
+  consumer.join();
+  CATCH_REQUIRE(0 == ring.wait_consume([](size_t&) {}, 1));
+}
@@ -0,0 +1,139 @@
+/**
+ * @file multithread-thread_pool-utest.cpp
+ *
+ * @copyright 2020 John Harwell, All rights reserved.
+ *
+ * This file is part of RCPPSW.
+ *
+ * RCPPSW is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * RCPPSW is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * RCPPSW.  If not, see <http://www.gnu.org/licenses/
+ */
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <pthread.h>
+#include <sched.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_PREFIX_ALL
+#include "catch.hpp"
+
+#include "rcppsw/multithread/thread_pool.hpp"
+
+/*******************************************************************************
+ * Namespaces
+ ******************************************************************************/
+namespace mt = rcppsw::multithread;
+
+/*******************************************************************************
+ * Test Cases
+ ******************************************************************************/
+CATCH_TEST_CASE("Submit", "[multithread::thread_pool]") {
+  mt::thread_pool pool(3);
+  CATCH_REQUIRE(3 == pool.n_threads());
+
+  std::vector<std::future<int>> futures;
+  for (int i = 0; i < 100; ++i) {
+    futures.push_back(pool.submit([](int x) { return x * x; }, i));
+  } /* for(i..) */
+  for (size_t i = 0; i < futures.size(); ++i) {
+    CATCH_REQUIRE(static_cast<int>(i * i) == futures[i].get());
+  } /* for(i..) */
+
+  auto bad = pool.submit([]() -> int { throw std::logic_error("bad"); });
+  CATCH_REQUIRE_THROWS_AS(bad.get(), std::logic_error);
+}
+
+CATCH_TEST_CASE("Parallel For", "[multithread::thread_pool]") {
+  mt::thread_pool pool(4);
+  std::vector<std::atomic<int>> hits(1000);
+  pool.parallel_for(0, hits.size(), 7, [&](size_t i) { ++hits[i]; });
+  for (auto& h : hits) {
+    CATCH_REQUIRE(1 == h.load());
+  } /* for(&h..) */
+
+  /* nested calls from within pool tasks must not deadlock */
+  std::atomic<size_t> sum{ 0 };
+  pool.parallel_for(0, 10, 1, [&](size_t i) {
+    pool.parallel_for(0, 100, 10, [&](size_t j) { sum += i * 100 + j; });
+  });
+  CATCH_REQUIRE(999 * 1000 / 2 == sum.load());
+
+  CATCH_REQUIRE_THROWS_AS(pool.parallel_for(0,
+                                            100,
+                                            10,
+                                            [](size_t i) {
+                                              if (42 == i) {
+                                                throw std::logic_error("42");
+                                              }
+                                            }),
+                          std::logic_error);
+}
+
+CATCH_TEST_CASE("Term", "[multithread::thread_pool]") {
+  mt::thread_pool pool(2);
+
+  /* everything accepted before term() runs */
+  std::atomic<size_t> count{ 0 };
+  for (size_t i = 0; i < 1000; ++i) {
+    pool.submit([&]() { ++count; });
+  } /* for(i..) */
+  pool.term();
+  CATCH_REQUIRE(1000 == count.load());
+
+  /* and nothing after it is silently dropped */
+  auto rejected = pool.submit([]() { return 1; });
+  CATCH_REQUIRE_THROWS_AS(rejected.get(), std::future_error);
+
+  size_t n = 0;
+  pool.parallel_for(0, 50, 8, [&](size_t) { ++n; });
+  CATCH_REQUIRE(50 == n);
+  pool.term();
+}
+
+CATCH_TEST_CASE("Pinning", "[multithread::thread_pool]") {
+  cpu_set_t allowed;
+  CPU_ZERO(&allowed);
+  CATCH_REQUIRE(0 == sched_getaffinity(0, sizeof(allowed), &allowed));
+
+  /* more workers than cores, so some share one */
+  mt::thread_pool pool(static_cast<size_t>(CPU_COUNT(&allowed)) + 2, true);
+
+  /* the CPU the worker running each task is pinned to, or -1 */
+  std::vector<std::future<int>> futures;
+  for (int i = 0; i < 100; ++i) {
+    futures.push_back(pool.submit([]() {
+      cpu_set_t set;
+      CPU_ZERO(&set);
+      if (0 != pthread_getaffinity_np(pthread_self(), sizeof(set), &set) ||
+          1 != CPU_COUNT(&set)) {
+        return -1;
+      }
+      for (size_t core = 0; core < CPU_SETSIZE; ++core) {
+        if (CPU_ISSET(core, &set)) {
+          return static_cast<int>(core);
+        }
+      } /* for(core..) */
+      return -1;
+    }));
+  } /* for(i..) */
+  for (auto& f : futures) {
+    int core = f.get();
+    CATCH_REQUIRE(-1 != core);
+    CATCH_REQUIRE(CPU_ISSET(static_cast<size_t>(core), &allowed));
+  } /* for(&f..) */
+}